@@ -23,8 +23,10 @@
 #include "gdk.h"
 #include "stream.h"
 
-RResultPtr  leaked_data;
+RResultPtr *leaked_data;
 ChainedINT *leaked_bids;
+MT_Lock leaked_lock;
+static int leaked_datac = 0;
 //int leaked_resultc;
 
 //static int max_size = 100;
@@ -45,21 +47,86 @@ ChainedINT *CINT_free(ChainedINT *c) {
 	return NULL;
 }
 
+// Drops one occurrence of val, if any.
+ChainedINT *CINT_removeValue(int val, ChainedINT *c) {
+	ChainedINT **p;
+
+	for (p = &c; *p != NULL; p = &(*p)->next) {
+		if ((*p)->val == val) {
+			ChainedINT *r = *p;
+			*p = r->next;
+			GDKfree(r);
+			break;
+		}
+	}
+	return c;
+}
+
 int leakedBatInUse(ChainedINT *c) {
 	return (c == NULL) ? 0 : (BBP_refs(c->val) > 0 || leakedBatInUse(c->next));
 }
 
+/*
+ * The first call (for the console client, idx 0) sets up the shared
+ * state, later ones only add the record of one more client.
+ */
 int
-leak_init(void)
+leak_init(int idx)
+{
+	RResultPtr ld;
+
+	if (idx == 0) {
+		MT_lock_init(&leaked_lock, "leaked_lock");
+		leaked_bids = NULL;
+	}
+	MT_lock_set(&leaked_lock, "leak_init");
+	if (idx >= leaked_datac) {
+		RResultPtr *n = GDKrealloc(leaked_data, (idx + 1) * sizeof(RResultPtr));
+
+		if (n == NULL) {
+			MT_lock_unset(&leaked_lock, "leak_init");
+			return 1;
+		}
+		memset(n + leaked_datac, 0, (idx + 1 - leaked_datac) * sizeof(RResultPtr));
+		leaked_data = n;
+		leaked_datac = idx + 1;
+	}
+	ld = leaked_data[idx] = GDKzalloc(sizeof(RResultRec));
+	MT_lock_unset(&leaked_lock, "leak_init");
+	if (ld == NULL)
+		return 1;
+	ld->msg = buffer_wastream(buffer_create(GDKMAXERRLEN), "STDOUT_R_REDIRECT");
+	ld->type = LD_ERROR;
+	return (ld->msg == NULL);
+}
+
+// The message stream belongs to the client by now, MCcloseClient destroys it.
+void
+leak_exit(int idx)
 {
-	leaked_bids = NULL;
-	leaked_data = GDKmalloc(sizeof(RResultRec));
-	leaked_data->msg = buffer_wastream(buffer_create(GDKMAXERRLEN), "STDOUT_R_REDIRECT");
-	leaked_data->type = LD_ERROR;
-	return (leaked_data == NULL);
+	RResultPtr ld;
+
+	MT_lock_set(&leaked_lock, "leak_exit");
+	ld = idx < leaked_datac ? leaked_data[idx] : NULL;
+	if (ld)
+		leaked_data[idx] = NULL;
+	MT_lock_unset(&leaked_lock, "leak_exit");
+	if (ld)
+		GDKfree(ld->scale);
+	GDKfree(ld);
+}
+
+RResultPtr
+leak_state(int idx)
+{
+	RResultPtr ld;
+
+	MT_lock_set(&leaked_lock, "leak_state");
+	ld = idx < leaked_datac ? leaked_data[idx] : NULL;
+	MT_lock_unset(&leaked_lock, "leak_state");
+	return ld;
 }
 
-/* NB: Thanks to burn after reading */
 char *
 mR_getMsg(stream *msg)
 {
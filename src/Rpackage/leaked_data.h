@@ -22,13 +22,17 @@
 
 #include "monetdb_config.h"
 //#include "sql_list.h"
+#include "gdk.h"
 #include <R.h>
 #include <Rdefines.h>
 #include "stream.h"
 
-typedef enum { LD_PROCESSING, LD_RESULT, LD_ERROR, LD_MESSAGE } LD_MSGTYPE;
+typedef enum { LD_PROCESSING, LD_RESULT, LD_ERROR, LD_MESSAGE, LD_STREAM } LD_MSGTYPE;
 typedef struct RRESULT {
 	LD_MSGTYPE type;
+	int stream;	/* keep result columns as fixed BATs, value holds their ids (LD_STREAM) */
+	int colc;	/* columns of value filled in so far */
+	int *scale;	/* LD_STREAM: scale of each decimal column, -1 for the others */
 	SEXP name;
 	SEXP tname;
 	SEXP value;
@@ -41,15 +45,21 @@ typedef struct CHAINEDINT {
 } ChainedINT;
 
 
-extern RResultPtr  leaked_data;
+// One result record per MAL client, indexed by Client->idx (see leak_state).
+extern RResultPtr *leaked_data;
 extern ChainedINT* leaked_bids;
+// Guards leaked_data, leaked_bids and the calls into R, which is not thread safe.
+extern MT_Lock leaked_lock;
 //extern int leaked_resultc;
 
 extern ChainedINT *CINT_pushValue(int, ChainedINT *);
 extern ChainedINT *CINT_free(ChainedINT *);
+extern ChainedINT *CINT_removeValue(int, ChainedINT *);
 extern int leakedBatInUse(ChainedINT *);
 
-extern int leak_init(void);
+extern int leak_init(int idx);
+extern void leak_exit(int idx);
+extern RResultPtr leak_state(int idx);
 extern char *mR_getMsg(stream *);
 extern void mR_destroyMsg(stream *);
 //extern int leak_init_query(str sqlQuery);
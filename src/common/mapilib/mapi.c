@@ -282,6 +282,7 @@
  * @item mapi_explain()	@tab	Display error message and context on stream
  * @item mapi_explain_query()	@tab	Display error message and context on stream
  * @item mapi_fetch_all_rows()	@tab	Fetch all answers from server into cache
+ * @item mapi_fetch_column()	@tab	Fetch a column slice of a binary result
  * @item mapi_fetch_field()	@tab Fetch a field from the current row
  * @item mapi_fetch_field_len()	@tab Fetch the length of a field from the current row
  * @item mapi_fetch_field_array()	@tab Fetch all fields from the current row
@@ -599,6 +600,20 @@
  * database value is NULL, of when the string is the empty string.  This can
  * be analyzed by using @code{mapi\_error()} and @code{mapi\_fetch\_field()}.
  *
+ * @item int mapi_fetch_column(MapiHdl hdl, int fnr, mapi_int64 rownr, int count, int outtype, void *dst)
+ *
+ * Copy at most count values of column fnr of a binary result set (see
+ * @code{mapi\_set\_binary()}), starting at row rownr, into the array
+ * dst of type outtype, which is one of MAPI_TINY, MAPI_SHORT, MAPI_INT,
+ * MAPI_LONG, MAPI_FLOAT, MAPI_DOUBLE or MAPI_VARCHAR.  For MAPI_VARCHAR
+ * dst is an array of string pointers, which stay valid until the next
+ * block of the result set is fetched.  NULL is represented by the
+ * smallest value of integer types, NaN for floating point types and a
+ * NULL pointer for strings.  Rows that are not cached are fetched from
+ * the server.  The values come from a single block, hence fewer than
+ * count values may be returned.  Returns the number of values stored,
+ * 0 past the end of the result set, or -1 on error.
+ *
  * @item MapiMsg mapi_next_result(MapiHdl hdl)
  *
  * Go to the next result set, discarding the rest of the output of the
@@ -708,6 +723,13 @@
  * non-read elements.  Filling the cache quicker than reading leads to an
  * error.
  *
+ * @item MapiMsg mapi_set_binary(Mapi mid, int value)
+ *
+ * Ask the server to send the rows of SQL result sets as column
+ * buffers instead of text lines.  Such result sets are read with
+ * @code{mapi\_fetch\_column()}; they do not deliver rows to
+ * @code{mapi\_fetch\_row()}.
+ *
  * @item MapiMsg mapi_cache_shuffle(MapiHdl hdl, int percentage)
  *
  * Make room in the cache by shuffling percentage tuples out of the
@@ -807,6 +829,13 @@
 #include  <signal.h>
 #include  <string.h>
 #include  <memory.h>
+#include  <math.h>
+#include  <float.h>
+#include  <limits.h>
+
+#ifndef NAN
+#define NAN	(DBL_MAX * DBL_MAX * 0.0)
+#endif
 
 #ifdef HAVE_FTIME
 #include <sys/timeb.h>
@@ -839,6 +868,14 @@ struct MapiColumn {
 	int scale;
 };
 
+/* a column of the current block of a binary result set */
+struct MapiBinColumn {
+	char kind;		/* 'i' integer, 'f' floating point, 's' string */
+	int width;		/* width of the values */
+	char *data;
+	size_t size;
+};
+
 /* information about bound columns */
 struct MapiBinding {
 	void *outparam;		/* pointer to application variable */
@@ -946,6 +983,10 @@ struct MapiResultSet {
 	struct MapiColumn *fields;
 	struct MapiRowBuf cache;
 	int commentonly;	/* only comments seen so far */
+	int binary;		/* rows are received as column buffers */
+	mapi_int64 binfirst;	/* row # of the first row in bincols */
+	mapi_int64 bincount;	/* number of rows in bincols */
+	struct MapiBinColumn *bincols;
 };
 
 struct MapiStatement {
@@ -1420,6 +1461,11 @@ new_result(MapiHdl hdl)
 
 	result->commentonly = 1;
 
+	result->binary = 0;
+	result->binfirst = 0;
+	result->bincount = 0;
+	result->bincols = NULL;
+
 	return result;
 }
 
@@ -1534,6 +1580,13 @@ close_result(MapiHdl hdl)
 		result->cache.line = NULL;
 		result->cache.tuplecount = 0;
 	}
+	if (result->bincols) {
+		for (i = 0; i < result->fieldcnt; i++)
+			if (result->bincols[i].data)
+				free(result->bincols[i].data);
+		free(result->bincols);
+		result->bincols = NULL;
+	}
 	if (result->errorstr)
 		free(result->errorstr);
 	result->errorstr = NULL;
@@ -3332,6 +3385,138 @@ read_line(Mapi mid)
 	return reply;
 }
 
+/* read exactly n bytes that follow the current line into dst */
+static int
+read_bytes(Mapi mid, char *dst, size_t n)
+{
+	size_t avail = (size_t) (mid->blk.end - mid->blk.nxt);
+
+	if (avail > n)
+		avail = n;
+	memcpy(dst, mid->blk.buf + mid->blk.nxt, avail);
+	mid->blk.nxt += (int) avail;
+	dst += avail;
+	n -= avail;
+	while (n > 0) {
+		ssize_t len = mnstr_read(mid->from, dst, 1, n);
+
+		check_stream(mid, mid->from, "Connection terminated", "read_bytes", -1);
+		if (len <= 0) {
+			mapi_setError(mid, "Binary column data truncated", "read_bytes", MERROR);
+			return -1;
+		}
+		if (mid->tracelog) {
+			mapi_log_header(mid, "R");
+			mnstr_printf(mid->tracelog, "<" SSZFMT " bytes>\n", len);
+			mnstr_flush(mid->tracelog);
+		}
+		dst += len;
+		n -= (size_t) len;
+	}
+	return 0;
+}
+
+/* swap the byte order of n values of the given width */
+static void
+swap_bytes(char *data, size_t n, int width)
+{
+	size_t i;
+	int j;
+	char c;
+
+	for (i = 0; i < n; i++, data += width)
+		for (j = 0; j < width / 2; j++) {
+			c = data[j];
+			data[j] = data[width - 1 - j];
+			data[width - 1 - j] = c;
+		}
+}
+
+/* read the column buffers of a block of a binary result set; line is
+   the $ line that announces them */
+static MapiMsg
+read_binary_block(Mapi mid, struct MapiResultSet *result, char *line)
+{
+	int i, ncols = 0, le = 0, width;
+	mapi_int64 nrows = 0, offset = 0;
+	size_t size;
+	char kind;
+	struct MapiBinColumn *col;
+
+	if (sscanf(line, "$%d " LLFMT " " LLFMT " %d", &ncols, &nrows, &offset, &le) != 4 ||
+	    ncols <= 0 || nrows < 0) {
+		mapi_setError(mid, "Bad binary block header", "read_binary_block", MERROR);
+		return mid->error;
+	}
+	if (result->bincols) {
+		for (i = 0; i < result->fieldcnt; i++)
+			if (result->bincols[i].data)
+				free(result->bincols[i].data);
+		free(result->bincols);
+	}
+	if (ncols > result->fieldcnt)
+		result->fieldcnt = ncols;
+	result->bincols = calloc(result->fieldcnt, sizeof(*result->bincols));
+	if (result->bincols == NULL) {
+		mapi_setError(mid, "Memory allocation failure", "read_binary_block", MERROR);
+		return mid->error;
+	}
+	result->binary = 1;
+	result->binfirst = offset;
+	result->bincount = 0;
+	for (i = 0; i < ncols; i++) {
+		col = &result->bincols[i];
+		if ((line = read_line(mid)) == NULL)
+			return mid->error;
+		if (sscanf(line, "$%c %d " SZFMT, &kind, &width, &size) != 3 ||
+		    (kind == 'i' ? width != 1 && width != 2 && width != 4 && width != 8 :
+		     kind == 'f' ? width != 4 && width != 8 :
+		     kind == 's' ? width != (int) sizeof(unsigned int) : 1) ||
+		    size < (size_t) nrows * width) {
+			mapi_setError(mid, "Bad binary column header", "read_binary_block", MERROR);
+			return mid->error;
+		}
+		col->kind = kind;
+		col->width = width;
+		col->size = size;
+		if ((col->data = malloc(size + 1)) == NULL) {
+			mapi_setError(mid, "Memory allocation failure", "read_binary_block", MERROR);
+			return mid->error;
+		}
+		if (read_bytes(mid, col->data, size) < 0)
+			return mid->error;
+		col->data[size] = 0;
+#ifdef WORDS_BIGENDIAN
+		if (le)
+#else
+		if (!le)
+#endif
+			swap_bytes(col->data, (size_t) nrows, width);
+		if (kind == 's') {
+			/* every offset must point at a NUL terminated
+			   string within the string area of the buffer */
+			const unsigned int *offs = (const unsigned int *) col->data;
+			const char *strs = col->data + (size_t) nrows * width;
+			size_t strsize = size - (size_t) nrows * width;
+			mapi_int64 r;
+
+			for (r = 0; r < nrows; r++) {
+				if (offs[r] == ~(unsigned int) 0)
+					continue;
+				if (offs[r] >= strsize ||
+				    memchr(strs + offs[r], 0, strsize - offs[r]) == NULL) {
+					mapi_setError(mid, "Bad string offset in binary column", "read_binary_block", MERROR);
+					return mid->error;
+				}
+			}
+		}
+	}
+	result->bincount = nrows;
+	result->cache.first = offset;
+	result->cache.tuplecount = nrows;
+	return mid->error;
+}
+
 /* set or unset the autocommit flag in the server */
 MapiMsg
 mapi_setAutocommit(Mapi mid, int autocommit)
@@ -3362,6 +3547,19 @@ mapi_set_size_header(Mapi mid, int value)
 		return mapi_Xcommand(mid, "sizeheader", "0");
 }
 
+MapiMsg
+mapi_set_binary(Mapi mid, int value)
+{
+	if (mid->languageId != LANG_SQL) {
+		mapi_setError(mid, "binary results only supported in SQL", "mapi_set_binary", MERROR);
+		return MERROR;
+	}
+	if (value)
+		return mapi_Xcommand(mid, "binary", "1");
+	else
+		return mapi_Xcommand(mid, "binary", "0");
+}
+
 MapiMsg
 mapi_release_id(Mapi mid, int id)
 {
@@ -3775,6 +3973,15 @@ read_into_cache(MapiHdl hdl, int lookahead)
 			if (!mid->error)
 				mid->error = MSERVER;
 			break;
+		case '$':
+			if (result == NULL) {
+				result = new_result(hdl);
+				hdl->active = result;
+			}
+			if (read_binary_block(mid, result, line) != MOK ||
+			    lookahead > 0)
+				return mid->error;
+			break;
 		case '%':
 		case '#':
 		case '&':
@@ -4413,6 +4620,7 @@ mapi_fetch_line(MapiHdl hdl)
 	    (result = hdl->result) != NULL &&
 	    hdl->mid->languageId == LANG_SQL &&
 	    result->querytype == Q_TABLE &&
+	    !result->binary &&
 	    result->row_count > 0 &&
 	    result->cache.first + result->cache.tuplecount < result->row_count) {
 		if (hdl->needmore)	/* escalate */
@@ -4966,6 +5174,7 @@ mapi_fetch_all_rows(MapiHdl hdl)
 		if ((result = hdl->result) != NULL &&
 		    mid->languageId == LANG_SQL &&
 		    mid->active == NULL &&
+		    !result->binary &&
 		    result->row_count > 0 &&
 		    result->cache.first + result->cache.tuplecount < result->row_count) {
 			mid->active = hdl;
@@ -4989,6 +5198,177 @@ mapi_fetch_all_rows(MapiHdl hdl)
 	return result ? result->cache.tuplecount : 0;
 }
 
+/* value r of an integer column of the given width; nil is
+   reported through *isnil */
+static mapi_int64
+bin_int(const char *data, int width, mapi_int64 r, int *isnil)
+{
+	mapi_int64 v;
+
+	switch (width) {
+	case 1:
+		v = ((const signed char *) data)[r];
+		*isnil = v == -128;
+		break;
+	case 2:
+		v = ((const short *) data)[r];
+		*isnil = v == SHRT_MIN;
+		break;
+	case 4:
+		v = ((const int *) data)[r];
+		*isnil = v == INT_MIN;
+		break;
+	default:
+		v = ((const mapi_int64 *) data)[r];
+		*isnil = v == (mapi_int64) LLONG_MIN;
+		break;
+	}
+	return v;
+}
+
+static double
+bin_dbl(const char *data, int width, mapi_int64 r, int *isnil)
+{
+	double v;
+
+	if (width == 4) {
+		v = ((const float *) data)[r];
+		*isnil = ((const float *) data)[r] == -FLT_MAX;
+	} else {
+		v = ((const double *) data)[r];
+		*isnil = v == -DBL_MAX;
+	}
+	return v;
+}
+
+int
+mapi_fetch_column(MapiHdl hdl, int fnr, mapi_int64 rownr, int count, int outtype, void *dst)
+{
+	Mapi mid;
+	struct MapiResultSet *result;
+	struct MapiBinColumn *col;
+	const char *s;
+	mapi_int64 r, v = 0;
+	double d = 0;
+	int i, n, isnil = 0, len;
+
+	assert(hdl);
+	mid = hdl->mid;
+	if (mid->connected == 0) {
+		mapi_setError(mid, "Connection lost", "mapi_fetch_column", MERROR);
+		return -1;
+	}
+	mapi_clrError(mid);
+	if ((result = hdl->result) == NULL || !result->binary) {
+		mapi_setError(mid, "No binary result set", "mapi_fetch_column", MERROR);
+		return -1;
+	}
+	if (fnr < 0 || fnr >= result->fieldcnt || count < 0) {
+		mapi_setError(mid, "Illegal field number", "mapi_fetch_column", MERROR);
+		return -1;
+	}
+	if (rownr < 0 || rownr >= result->row_count || count == 0)
+		return 0;
+	if (rownr < result->binfirst || rownr >= result->binfirst + result->bincount) {
+		/* fetch the block that starts at rownr */
+		if (hdl->needmore) {
+			mapi_setError(mid, "Handle is busy", "mapi_fetch_column", MERROR);
+			return -1;
+		}
+		if (mid->active != NULL)
+			read_into_cache(mid->active, 0);
+		len = count > mid->cachelimit ? count : mid->cachelimit;
+		mid->active = hdl;
+		hdl->active = result;
+		if (mid->tracelog) {
+			mapi_log_header(mid, "W");
+			mnstr_printf(mid->tracelog, "X" "export %d " LLFMT " %d\n",
+				      result->tableid, rownr, len);
+			mnstr_flush(mid->tracelog);
+		}
+		if (mnstr_printf(mid->to, "X" "export %d " LLFMT " %d\n",
+				  result->tableid, rownr, len) < 0 ||
+		    mnstr_flush(mid->to))
+			check_stream(mid, mid->to, mnstr_error(mid->to), "mapi_fetch_column", -1);
+		if (read_into_cache(hdl, 0) != MOK)
+			return -1;
+		if (rownr < result->binfirst || rownr >= result->binfirst + result->bincount) {
+			mapi_setError(mid, "Row not delivered by server", "mapi_fetch_column", MERROR);
+			return -1;
+		}
+	}
+	col = &result->bincols[fnr];
+	if (col->data == NULL) {
+		mapi_setError(mid, "Illegal field number", "mapi_fetch_column", MERROR);
+		return -1;
+	}
+	switch (outtype) {
+	case MAPI_TINY:
+	case MAPI_SHORT:
+	case MAPI_INT:
+	case MAPI_LONG:
+	case MAPI_FLOAT:
+	case MAPI_DOUBLE:
+		break;
+	case MAPI_VARCHAR:
+		if (col->kind == 's')
+			break;
+		mapi_setError(mid, "Column is not a string column", "mapi_fetch_column", MERROR);
+		return -1;
+	default:
+		mapi_setError(mid, "Unsupported output type", "mapi_fetch_column", MERROR);
+		return -1;
+	}
+	r = rownr - result->binfirst;
+	n = result->binfirst + result->bincount - rownr < count ?
+		(int) (result->binfirst + result->bincount - rownr) : count;
+	for (i = 0; i < n; i++, r++) {
+		s = NULL;
+		switch (col->kind) {
+		case 'i':
+			v = bin_int(col->data, col->width, r, &isnil);
+			d = (double) v;
+			break;
+		case 'f':
+			d = bin_dbl(col->data, col->width, r, &isnil);
+			v = (mapi_int64) d;
+			break;
+		default:
+			isnil = ((const unsigned int *) col->data)[r] == ~(unsigned int) 0;
+			if (!isnil) {
+				s = col->data + result->bincount * col->width + ((const unsigned int *) col->data)[r];
+				v = strtoll(s, NULL, 10);
+				d = strtod(s, NULL);
+			}
+			break;
+		}
+		switch (outtype) {
+		case MAPI_TINY:
+			((signed char *) dst)[i] = isnil ? -128 : (signed char) v;
+			break;
+		case MAPI_SHORT:
+			((short *) dst)[i] = isnil ? SHRT_MIN : (short) v;
+			break;
+		case MAPI_INT:
+			((int *) dst)[i] = isnil ? INT_MIN : (int) v;
+			break;
+		case MAPI_LONG:
+			((mapi_int64 *) dst)[i] = isnil ? (mapi_int64) LLONG_MIN : v;
+			break;
+		case MAPI_FLOAT:
+			((float *) dst)[i] = isnil ? (float) NAN : (float) d;
+			break;
+		case MAPI_DOUBLE:
+			((double *) dst)[i] = isnil ? NAN : d;
+			break;
+		default:
+			((const char **) dst)[i] = s;
+			break;
+		}
+	}
+	return n;
+}
+
 char *
 mapi_fetch_field(MapiHdl hdl, int fnr)
 {
@@ -167,6 +167,7 @@ mapi_export int mapi_get_autocommit(Mapi mid);
 mapi_export MapiMsg mapi_log(Mapi mid, const char *nme);
 mapi_export MapiMsg mapi_setAutocommit(Mapi mid, int autocommit);
 mapi_export MapiMsg mapi_set_size_header(Mapi mid, int value);
+mapi_export MapiMsg mapi_set_binary(Mapi mid, int value);
 mapi_export MapiMsg mapi_release_id(Mapi mid, int id);
 mapi_export char *mapi_result_error(MapiHdl hdl);
 mapi_export MapiMsg mapi_next_result(MapiHdl hdl);
@@ -211,6 +212,7 @@ mapi_export MapiMsg mapi_seek_row(MapiHdl hdl, mapi_int64 rowne, int whence);
 mapi_export MapiMsg mapi_timeout(Mapi mid, unsigned int time);
 mapi_export int mapi_fetch_row(MapiHdl hdl);
 mapi_export mapi_int64 mapi_fetch_all_rows(MapiHdl hdl);
+mapi_export int mapi_fetch_column(MapiHdl hdl, int fnr, mapi_int64 rownr, int count, int outtype, void *dst);
 mapi_export int mapi_get_field_count(MapiHdl hdl);
 mapi_export mapi_int64 mapi_get_row_count(MapiHdl hdl);
 mapi_export mapi_int64 mapi_get_last_id(MapiHdl hdl);
@@ -645,7 +645,8 @@ typedef struct {
 
 	unsigned int copied:1,	/* a copy of an existing map. */
 		      hashash:1,/* the string heap contains hash values */
-		      forcemap:1;  /* force STORE_MMAP even if heap exists */
+		      forcemap:1,  /* force STORE_MMAP even if heap exists */
+		      external:1;  /* base owned by someone else, see BATwrap */
 	storage_t storage;	/* storage mode (mmap/malloc). */
 	storage_t newstorage;	/* new desired storage mode at re-allocation. */
 	bte dirty;		/* specific heap dirty marker */
@@ -672,6 +673,11 @@ typedef struct {
 	BUN dictcnt;     /* counter for cache dictionary */
 } Imprints;
 
+typedef struct {
+	BUN blocks;      /* number of compressed blocks */
+	Heap *heap;      /* block headers and packed values */
+} Compressed;
+
 
 /*
  * @+ Binary Association Tables
@@ -892,6 +898,7 @@ typedef struct {
 	Heap *vheap;		/* space for the varsized data. */
 	Hash *hash;			/* hash table */
 	Imprints *imprints;	/* column imprints index */
+	Compressed *compressed;	/* compressed image of the column */
 
 	PROPrec *props;		/* list of dynamic properties stored in the bat descriptor */
 } COLrec;
@@ -2196,6 +2203,26 @@ gdk_export BAT *BAThashjoin(BAT *l, BAT *r, BUN estimate);
 gdk_export void IMPSdestroy(BAT *b);
 gdk_export BAT *BATimprints(BAT *b);
 
+/*
+ * @- Column Compression Functions
+ *
+ * @multitable @columnfractions 0.08 0.7
+ * @item BAT*
+ * @tab
+ *  BATcompress (BAT *b)
+ * @end multitable
+ *
+ * Build a compressed image of a persistent integer or string column,
+ * on which selections and sums are then evaluated block-wise.  The
+ * image is kept next to the column, which keeps its raw heap, so it
+ * costs extra memory and disk space.  Images are only built by
+ * BATcompress, never as a side effect of a select.
+ *
+ */
+
+gdk_export void CMPdestroy(BAT *b);
+gdk_export BAT *BATcompress(BAT *b);
+
 /*
  * @- Multilevel Storage Modes
  *
@@ -2239,6 +2266,7 @@ gdk_export BAT *BATimprints(BAT *b);
 gdk_export void *GDKmmap(const char *path, int mode, size_t len);
 
 gdk_export size_t GDK_mem_bigsize;	/* size after which we use anonymous VM rather than malloc */
+gdk_export size_t GDK_heap_headroom;	/* free bytes kept in front of every malloced heap */
 gdk_export size_t GDK_mem_maxsize;	/* max allowed size of committed memory */
 gdk_export size_t GDK_vm_maxsize;	/* max allowed size of reserved vm */
 gdk_export int	GDK_vm_trim;		/* allow trimming */
@@ -2325,6 +2353,7 @@ gdk_export int GDKfatal(_In_z_ _Printf_format_string_ const char *format, ...)
 gdk_export BUN void_replace_bat(BAT *b, BAT *u, bit force);
 gdk_export int void_inplace(BAT *b, oid id, const void *val, bit force);
 gdk_export BAT *BATattach(int tt, const char *heapfile);
+gdk_export BAT *BATwrap(int tt, void *base, BUN cnt);
 
 #ifdef NATIVE_WIN32
 #ifdef _MSC_VER
@@ -21,6 +21,7 @@
 #include "gdk.h"
 #include "gdk_private.h"
 #include "gdk_calc_private.h"
+#include "gdk_mapreduce.h"
 #include <math.h>
 
 /* grouped aggregates
@@ -604,6 +605,19 @@ BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int
 	}
 	if (BATcount(b) == 0)
 		return GDK_SUCCEED;
+	if (cand == NULL && ATOMstorage(tp) == TYPE_lng) {
+		/* sum whole blocks of a compressed column from their
+		 * headers; narrower types cannot overflow a lng here */
+		lng sum;
+
+		if (CMPsum(b, start, end, &sum, &nils) == 0) {
+			if (nils > 0 && !skip_nils)
+				* (lng *) res = lng_nil;
+			else if (nils < end - start)
+				* (lng *) res = sum;
+			return GDK_SUCCEED;
+		}
+	}
 	nils = dosum(Tloc(b, BUNfirst(b)), b->T->nonil, b->hseqbase, start, end,
 		     res, 1, b->ttype, tp, cand, candend, &min, min, max,
 		     skip_nils, abort_on_error, nil_if_empty, "BATsum");
@@ -2046,46 +2060,161 @@ BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_
 }
 
 /* ---------------------------------------------------------------------- */
-/* median */
+/* quantile */
 
-BAT *
-BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error)
+#define QUANTILE_SWAP(TYPE, v, i, j)					\
+	do {								\
+		TYPE _t = (v)[i];					\
+		(v)[i] = (v)[j];					\
+		(v)[j] = _t;						\
+	} while (0)
+
+/* find the k-th smallest value in v[0..n) by partitioning v in place
+ * (introselect): quickselect around a median-of-three pivot which,
+ * after 2*log2(n) rounds, gives up and sorts what is left; nil is the
+ * smallest value of each type, so it is ordered like any other */
+#define QUANTILE_SELECT(TYPE)						\
+static TYPE								\
+quantile_select_##TYPE(TYPE *v, BUN n, BUN k)				\
+{									\
+	BUN lo = 0, hi = n - 1, i, j;					\
+	int depth = 0;							\
+	TYPE pv;							\
+									\
+	assert(k < n);							\
+	for (i = n; i > 1; i >>= 1)					\
+		depth += 2;						\
+	while (lo < hi) {						\
+		if (depth-- == 0) {					\
+			GDKqsort(v + lo, NULL, NULL, (size_t) (hi - lo + 1), \
+				 (int) sizeof(TYPE), 0, TYPE_##TYPE);	\
+			break;						\
+		}							\
+		i = lo + (hi - lo) / 2;					\
+		if (v[i] < v[lo])					\
+			QUANTILE_SWAP(TYPE, v, i, lo);			\
+		if (v[hi] < v[lo])					\
+			QUANTILE_SWAP(TYPE, v, hi, lo);			\
+		if (v[hi] < v[i])					\
+			QUANTILE_SWAP(TYPE, v, hi, i);			\
+		pv = v[i];						\
+		i = lo;							\
+		j = hi;							\
+		while (i <= j) {					\
+			while (v[i] < pv)				\
+				i++;					\
+			while (pv < v[j])				\
+				j--;					\
+			if (i <= j) {					\
+				QUANTILE_SWAP(TYPE, v, i, j);		\
+				i++;					\
+				if (j == lo)				\
+					break;				\
+				j--;					\
+			}						\
+		}							\
+		/* v[lo..j] <= pv <= v[i..hi], and anything in	\
+		 * between equals pv */					\
+		if (k <= j)						\
+			hi = j;						\
+		else if (k >= i)					\
+			lo = i;						\
+		else							\
+			break;						\
+	}								\
+	return v[k];							\
+}
+
+QUANTILE_SELECT(bte)
+QUANTILE_SELECT(sht)
+QUANTILE_SELECT(int)
+QUANTILE_SELECT(lng)
+QUANTILE_SELECT(flt)
+QUANTILE_SELECT(dbl)
+
+/* visit the values of b in the candidate list that belong to a group
+ * in [min,max], setting gid to the group index */
+#define QUANTILE_LOOP(ISNIL, ACTION)					\
+	do {								\
+		const oid *cp = cand;					\
+		BUN st = start;						\
+		oid o;							\
+									\
+		for (;;) {						\
+			if (cp) {					\
+				if (cp == candend)			\
+					break;				\
+				i = *cp++ - b->hseqbase;		\
+				if (i >= end)				\
+					break;				\
+			} else {					\
+				i = st++;				\
+				if (i == end)				\
+					break;				\
+			}						\
+			if (g) {					\
+				o = gids ? gids[i] : g->tseqbase + i;	\
+				if (o < min || o > max)			\
+					continue;			\
+				gid = o - min;				\
+			} else {					\
+				gid = 0;				\
+			}						\
+			if (skip_nils && (ISNIL))			\
+				continue;				\
+			ACTION;						\
+		}							\
+	} while (0)
+
+/* copy the values into buf, clustered on group, then select the
+ * quantile of each group from its own slice */
+#define QUANTILE_FIX(TYPE)						\
+	do {								\
+		const TYPE *vals = (const TYPE *) Tloc(b, BUNfirst(b)); \
+		TYPE *dst = (TYPE *) Tloc(bn, BUNfirst(bn));		\
+		TYPE *buf;						\
+									\
+		QUANTILE_LOOP(vals[i] == TYPE##_nil, offs[gid + 1]++);	\
+		for (gid = 0; gid < ngrp; gid++)			\
+			offs[gid + 1] += offs[gid];			\
+		buf = GDKmalloc((offs[ngrp] + 1) * sizeof(TYPE));	\
+		if (buf == NULL)					\
+			goto bailout;					\
+		QUANTILE_LOOP(vals[i] == TYPE##_nil,			\
+			      buf[offs[gid]++] = vals[i]);		\
+		/* offs[gid] is now the end of group gid */		\
+		for (gid = 0, lo = 0; gid < ngrp; lo = offs[gid++]) {	\
+			n = offs[gid] - lo;				\
+			if (n == 0) {					\
+				dst[gid] = TYPE##_nil;			\
+				nils++;					\
+			} else {					\
+				dst[gid] = quantile_select_##TYPE(	\
+					buf + lo, n,			\
+					(BUN) (quantile * (n - 1)));	\
+				nils += dst[gid] == TYPE##_nil;		\
+			}						\
+		}							\
+		GDKfree(buf);						\
+	} while (0)
+
+/* Sort based quantile, for the types that have no selection
+ * implementation. */
+static BAT *
+BATgroupquantile_sort(BAT *b, BAT *g, BAT *e, BAT *s, int tp, dbl quantile,
+		      int skip_nils, oid min, BUN ngrp)
 {
 	int freeb = 0, freeg = 0;
-	oid min, max;
-	BUN ngrp;
 	BUN nils = 0;
 	BAT *bn = NULL;
-	BUN start, end, cnt;
-	const oid *cand = NULL, *candend = NULL;
 	BAT *t1, *t2;
 	BATiter bi;
 	const void *v;
 	const void *nil;
 	int (*atomcmp)(const void *, const void *);
-	const char *err;
-
-	(void) abort_on_error;
-
-	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
-				    &cnt, &cand, &candend)) != NULL) {
-		GDKerror("BATgroupmedian: %s\n", err);
-		return NULL;
-	}
-	assert(tp == b->ttype);
-	if (!ATOMlinear(b->ttype)) {
-		GDKerror("BATgroupmedian: cannot determine median on "
-			 "non-linear type %s\n", ATOMname(b->ttype));
-		return NULL;
-	}
 
-	if (BATcount(b) == 0 || ngrp == 0) {
-		/* trivial: no medians, so return bat aligned with e with
-		 * nil in the tail */
-		bn = BATconstant(tp, ATOMnilptr(tp), ngrp);
-		BATseqbase(bn, ngrp == 0 ? 0 : min);
-		return bn;
-	}
+	(void) e;
+	(void) tp;
 
 	if (s) {
 		b = BATleftjoin(s, b, BATcount(s));
@@ -2154,7 +2283,7 @@ BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_
 							   nil, 0, Tsize(bn));
 					nils++;
 				} else {
-					v = BUNtail(bi, BUNfirst(b) + (r + p - 1) / 2);
+					v = BUNtail(bi, BUNfirst(b) + r + (BUN) (quantile * (p - r - 1)));
 					bunfastins_nocheck(bn, BUNlast(bn), 0,
 							   v, 0, Tsize(bn));
 					nils += (*atomcmp)(v, nil) == 0;
@@ -2170,7 +2299,7 @@ BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_
 		}
 		BATseqbase(bn, min);
 	} else {
-		v = BUNtail(bi, BUNfirst(b) + (BATcount(b) - 1) / 2);
+		v = BUNtail(bi, BUNfirst(b) + (BUN) (quantile * (BATcount(b) - 1)));
 		BUNappend(bn, v, FALSE);
 		BATseqbase(bn, 0);
 		nils += (*atomcmp)(v, nil) == 0;
@@ -2197,6 +2326,399 @@ BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_
 	return NULL;
 }
 
+/* Calculate the quantile'th quantile (0 <= quantile <= 1) of each
+ * group: the value at position quantile*(n-1) (rounded down) in the
+ * ordered values of a group of size n.  For the fixed width numeric
+ * types this is done by selection on a copy of the values clustered
+ * on group, which is linear in the size of b; other types are
+ * sorted. */
+BAT *
+BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, dbl quantile,
+		 int skip_nils, int abort_on_error)
+{
+	oid min, max;
+	BUN ngrp;
+	BUN nils = 0;
+	BAT *bn = NULL;
+	BUN start, end, cnt;
+	const oid *cand = NULL, *candend = NULL;
+	const oid *gids;
+	oid gid;
+	BUN *offs = NULL, i, lo, n;
+	const char *err;
+	int t;
+
+	(void) abort_on_error;
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cnt, &cand, &candend)) != NULL) {
+		GDKerror("BATgroupquantile: %s\n", err);
+		return NULL;
+	}
+	assert(tp == b->ttype);
+	if (!ATOMlinear(b->ttype)) {
+		GDKerror("BATgroupquantile: cannot determine quantile on "
+			 "non-linear type %s\n", ATOMname(b->ttype));
+		return NULL;
+	}
+	if (!(quantile >= 0 && quantile <= 1)) {
+		GDKerror("BATgroupquantile: quantile must be between 0 and 1\n");
+		return NULL;
+	}
+
+	if (BATcount(b) == 0 || ngrp == 0) {
+		/* trivial: no values, so return bat aligned with e
+		 * with nil in the tail */
+		bn = BATconstant(tp, ATOMnilptr(tp), ngrp);
+		BATseqbase(bn, ngrp == 0 ? 0 : min);
+		return bn;
+	}
+
+	t = b->T->type;
+	if (t != ATOMstorage(t) &&
+	    ATOMnilptr(ATOMstorage(t)) == ATOMnilptr(t) &&
+	    BATatoms[ATOMstorage(t)].atomCmp == BATatoms[t].atomCmp)
+		t = ATOMstorage(t);
+	switch (t) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		break;
+	default:
+		return BATgroupquantile_sort(b, g, e, s, tp, quantile,
+					     skip_nils, min, ngrp);
+	}
+
+	if ((offs = GDKzalloc((ngrp + 1) * sizeof(BUN))) == NULL)
+		return NULL;
+	if ((bn = BATnew(TYPE_void, tp, ngrp)) == NULL)
+		goto bailout;
+	gids = g && !BATtdense(g) ? (const oid *) Tloc(g, BUNfirst(g)) : NULL;
+
+	switch (t) {
+	case TYPE_bte:
+		QUANTILE_FIX(bte);
+		break;
+	case TYPE_sht:
+		QUANTILE_FIX(sht);
+		break;
+	case TYPE_int:
+		QUANTILE_FIX(int);
+		break;
+	case TYPE_lng:
+		QUANTILE_FIX(lng);
+		break;
+	case TYPE_flt:
+		QUANTILE_FIX(flt);
+		break;
+	case TYPE_dbl:
+		QUANTILE_FIX(dbl);
+		break;
+	}
+	GDKfree(offs);
+
+	BATsetcount(bn, ngrp);
+	BATseqbase(bn, min);
+	bn->tkey = BATcount(bn) <= 1;
+	bn->tsorted = BATcount(bn) <= 1;
+	bn->trevsorted = BATcount(bn) <= 1;
+	bn->T->nil = nils != 0;
+	bn->T->nonil = nils == 0;
+	return bn;
+
+  bailout:
+	GDKfree(offs);
+	if (bn)
+		BBPunfix(bn->batCacheid);
+	return NULL;
+}
+
+BAT *
+BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error)
+{
+	return BATgroupquantile(b, g, e, s, tp, 0.5, skip_nils, abort_on_error);
+}
+
+/* Approximate quantile.
+ *
+ * The values are cut into one range per thread, and each thread
+ * summarises its range in a sketch: a stack of levels where the
+ * values at level h stand for 2^h values each.  When a level fills
+ * up it is sorted and every other value (alternately the odd and the
+ * even ones) moves up a level.  Integers are kept as lng and floating
+ * point values as dbl, so that no value changes on its way through
+ * the sketch.  The sketches are merged by sorting
+ * all their values together with their weights and walking the
+ * cumulative weight up to the requested rank.  The result is always a
+ * value that occurs in b; its rank is off by a small fraction of the
+ * number of values. */
+
+#define QUANTILE_APPROX_MIN	((BUN) 1 << 20) /* below this, be exact */
+#define QUANTILE_SKETCH		4096	/* compact a level at this size */
+#define QUANTILE_LEVELS		48
+
+typedef union {
+	lng l;			/* integer types */
+	dbl d;			/* floating point types */
+} qval;
+
+typedef struct {
+	MRtask task;		/* scheduler header, must be first */
+	BAT *b;
+	int tpe;		/* TYPE_lng or TYPE_dbl: how qval is used */
+	const oid *cand;	/* candidate list, or NULL */
+	BUN lo, hi;		/* range in cand or in b */
+	BUN end;		/* end of the values of b to look at */
+	BUN nils;		/* number of nils seen */
+	qval *lvl[QUANTILE_LEVELS]; /* values with weight 1 << level */
+	BUN n[QUANTILE_LEVELS];	/* number of values in each level */
+	bit odd[QUANTILE_LEVELS]; /* which values to keep next */
+	int error;
+} qsketch;
+
+static int
+qsketch_compact(qsketch *sk, int h)
+{
+	BUN i, m;
+	int off;
+
+	for (;;) {
+		if (h + 1 == QUANTILE_LEVELS)
+			return -1;
+		if (sk->lvl[h + 1] == NULL &&
+		    (sk->lvl[h + 1] = GDKmalloc(2 * QUANTILE_SKETCH * sizeof(qval))) == NULL)
+			return -1;
+		GDKqsort(sk->lvl[h], NULL, NULL, (size_t) sk->n[h],
+			 (int) sizeof(qval), 0, sk->tpe);
+		off = sk->odd[h];
+		sk->odd[h] = !off;
+		m = sk->n[h] & ~(BUN) 1;
+		for (i = 0; i < m; i += 2)
+			sk->lvl[h + 1][sk->n[h + 1]++] = sk->lvl[h][i + off];
+		/* an odd one out stays behind */
+		if (sk->n[h] & 1)
+			sk->lvl[h][0] = sk->lvl[h][m];
+		sk->n[h] &= 1;
+		if (sk->n[++h] < QUANTILE_SKETCH)
+			return 0;
+	}
+}
+
+#define QUANTILE_SKETCH_LOOP(TYPE, FLD)					\
+	do {								\
+		const TYPE *vals = (const TYPE *) Tloc(sk->b, BUNfirst(sk->b)); \
+		for (p = sk->lo; p < sk->hi; p++) {			\
+			i = sk->cand ? sk->cand[p] - sk->b->hseqbase : p; \
+			if (i >= sk->end)				\
+				continue;				\
+			if (vals[i] == TYPE##_nil) {			\
+				sk->nils++;				\
+				continue;				\
+			}						\
+			sk->lvl[0][sk->n[0]++].FLD = vals[i];		\
+			if (sk->n[0] == QUANTILE_SKETCH &&		\
+			    qsketch_compact(sk, 0) < 0) {		\
+				sk->error = 1;				\
+				return;					\
+			}						\
+		}							\
+	} while (0)
+
+static void
+qsketch_build(void *arg)
+{
+	qsketch *sk = arg;
+	BUN p, i;
+
+	if ((sk->lvl[0] = GDKmalloc(2 * QUANTILE_SKETCH * sizeof(qval))) == NULL) {
+		sk->error = 1;
+		return;
+	}
+	switch (ATOMstorage(sk->b->ttype)) {
+	case TYPE_bte:
+		QUANTILE_SKETCH_LOOP(bte, l);
+		break;
+	case TYPE_sht:
+		QUANTILE_SKETCH_LOOP(sht, l);
+		break;
+	case TYPE_int:
+		QUANTILE_SKETCH_LOOP(int, l);
+		break;
+	case TYPE_lng:
+		QUANTILE_SKETCH_LOOP(lng, l);
+		break;
+	case TYPE_flt:
+		QUANTILE_SKETCH_LOOP(flt, d);
+		break;
+	case TYPE_dbl:
+		QUANTILE_SKETCH_LOOP(dbl, d);
+		break;
+	default:
+		sk->error = 1;
+		break;
+	}
+}
+
+/* Calculate an approximation of the quantile in parallel; this is
+ * only done for a single group of numeric values, everything else is
+ * passed on to BATgroupquantile. */
+BAT *
+BATgroupquantile_approx(BAT *b, BAT *g, BAT *e, BAT *s, int tp, dbl quantile,
+			int skip_nils, int abort_on_error)
+{
+	oid min, max;
+	BUN ngrp, start, end, cnt, total, nils, k, w, i, n;
+	const oid *cand = NULL, *candend = NULL;
+	int nthreads = GDKnr_threads, j, h, exact, tpe;
+	qsketch *sks = NULL;
+	void **tasks = NULL;
+	qval *vals = NULL, res;
+	lng *wgts = NULL;
+	BAT *bn = NULL;
+	const char *err;
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cnt, &cand, &candend)) != NULL) {
+		GDKerror("BATgroupquantile_approx: %s\n", err);
+		return NULL;
+	}
+	if (!(quantile >= 0 && quantile <= 1)) {
+		GDKerror("BATgroupquantile_approx: quantile must be between 0 and 1\n");
+		return NULL;
+	}
+	total = cand ? (BUN) (candend - cand) : end - start;
+	exact = g != NULL || total < QUANTILE_APPROX_MIN ||
+		ATOMnilptr(ATOMstorage(b->ttype)) != ATOMnilptr(b->ttype);
+	switch (ATOMstorage(b->ttype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		break;
+	default:
+		exact = 1;
+		break;
+	}
+	if (exact)
+		return BATgroupquantile(b, g, e, s, tp, quantile, skip_nils,
+					abort_on_error);
+	assert(tp == b->ttype);
+	tpe = ATOMstorage(tp) == TYPE_flt || ATOMstorage(tp) == TYPE_dbl ?
+		TYPE_dbl : TYPE_lng;
+	if (nthreads < 1)
+		nthreads = 1;
+
+	ALGODEBUG fprintf(stderr, "#BATgroupquantile_approx(b=%s#" BUNFMT
+			  ",quantile=%g): %d sketches\n",
+			  BATgetId(b), BATcount(b), quantile, nthreads);
+	if ((sks = GDKzalloc(nthreads * sizeof(qsketch))) == NULL ||
+	    (tasks = GDKmalloc(nthreads * sizeof(void *))) == NULL)
+		goto bailout;
+	for (j = 0; j < nthreads; j++) {
+		sks[j].b = b;
+		sks[j].tpe = tpe;
+		sks[j].cand = cand;
+		sks[j].end = end;
+		sks[j].lo = (cand ? 0 : start) + total / nthreads * j;
+		sks[j].hi = j == nthreads - 1 ?
+			(cand ? 0 : start) + total :
+			sks[j].lo + total / nthreads;
+		tasks[j] = &sks[j];
+	}
+	MRschedule(nthreads, tasks, qsketch_build);
+
+	n = nils = 0;
+	for (j = 0; j < nthreads; j++) {
+		if (sks[j].error)
+			goto bailout;
+		nils += sks[j].nils;
+		for (h = 0; h < QUANTILE_LEVELS; h++)
+			n += sks[j].n[h];
+	}
+	if ((vals = GDKmalloc((n + 1) * sizeof(qval))) == NULL ||
+	    (wgts = GDKmalloc((n + 1) * sizeof(lng))) == NULL)
+		goto bailout;
+	for (i = 0, w = 0, j = 0; j < nthreads; j++) {
+		for (h = 0; h < QUANTILE_LEVELS; h++) {
+			for (k = 0; k < sks[j].n[h]; k++) {
+				vals[i] = sks[j].lvl[h][k];
+				wgts[i++] = (lng) 1 << h;
+			}
+			w += sks[j].n[h] << h;
+		}
+	}
+	GDKqsort(vals, wgts, NULL, (size_t) n, (int) sizeof(qval),
+		 (int) sizeof(lng), tpe);
+
+	/* w is the number of non-nil values represented */
+	if (skip_nils)
+		nils = 0;
+	bn = BATnew(TYPE_void, tp, 1);
+	if (bn == NULL)
+		goto bailout;
+	if (w + nils == 0 ||
+	    (k = (BUN) (quantile * (w + nils - 1))) < nils) {
+		BUNappend(bn, ATOMnilptr(tp), FALSE);
+	} else {
+		for (k -= nils, i = 0; i < n - 1; i++) {
+			if ((BUN) wgts[i] > k)
+				break;
+			k -= (BUN) wgts[i];
+		}
+		res = vals[i];
+		switch (ATOMstorage(tp)) {
+		case TYPE_bte: {
+			bte v = (bte) res.l;
+			BUNappend(bn, &v, FALSE);
+			break;
+		}
+		case TYPE_sht: {
+			sht v = (sht) res.l;
+			BUNappend(bn, &v, FALSE);
+			break;
+		}
+		case TYPE_int: {
+			int v = (int) res.l;
+			BUNappend(bn, &v, FALSE);
+			break;
+		}
+		case TYPE_lng: {
+			lng v = res.l;
+			BUNappend(bn, &v, FALSE);
+			break;
+		}
+		case TYPE_flt: {
+			flt v = (flt) res.d;
+			BUNappend(bn, &v, FALSE);
+			break;
+		}
+		default: {
+			dbl v = res.d;
+			BUNappend(bn, &v, FALSE);
+			break;
+		}
+		}
+	}
+	BATseqbase(bn, 0);
+
+  bailout:
+	if (sks) {
+		for (j = 0; j < nthreads; j++)
+			for (h = 0; h < QUANTILE_LEVELS; h++)
+				GDKfree(sks[j].lvl[h]);
+		GDKfree(sks);
+	}
+	GDKfree(tasks);
+	GDKfree(vals);
+	GDKfree(wgts);
+	return bn;
+}
+
 /* ---------------------------------------------------------------------- */
 /* standard deviation (both biased and non-biased) */
 
@@ -346,6 +346,9 @@ VIEWcreate_(BAT *h, BAT *t, int slice_view)
 	/* imprints can and must be shared */
 	bn->H->imprints = h->H->imprints;
 	bn->T->imprints = t->T->imprints;
+	/* views use the compressed image of their parent */
+	bn->H->compressed = NULL;
+	bn->T->compressed = NULL;
 	BBPcacheit(bs, 1);	/* enter in BBP */
 	/* View of VIEW combine, ie we need to fix the head of the mirror */
 	if (vc) {
@@ -466,6 +469,7 @@ BATmaterializeh(BAT *b)
 	/* cleanup possible ACC's */
 	HASHdestroy(b);
 	IMPSdestroy(b);
+	CMPdestroy(b);
 
 	b->H->heap.filename = NULL;
 	if (HEAPalloc(&b->H->heap, cnt, sizeof(oid)) < 0) {
@@ -795,6 +799,7 @@ VIEWdestroy(BAT *b)
 	if (b->T->hash)
 		HASHremove(BATmirror(b));
 	IMPSdestroy(b);
+	CMPdestroy(b);
 	VIEWunlink(b);
 
 	if (b->htype && !b->H->heap.parentid) {
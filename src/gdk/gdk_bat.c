@@ -346,7 +346,7 @@ BATattach(int tt, const char *heapfile)
 	BATsetdims(bn);
 	GDKfilepath(path, BATDIR, bn->T->heap.filename, "new");
 	GDKcreatedir(path);
-	if (rename(heapfile, path) < 0) {
+	if (GDKmove(NULL, heapfile, NULL, BATDIR, bn->T->heap.filename, "new") < 0) {
 		GDKsyserror("BATattach: cannot rename heapfile\n");
 		HEAPfree(&bn->T->heap);
 		GDKfree(bs);
@@ -366,6 +366,9 @@ BATattach(int tt, const char *heapfile)
 	bn->T->heap.size = (size_t) st.st_size;
 	bn->T->heap.newstorage = bn->T->heap.storage = (bn->T->heap.size < REMAP_PAGE_MAXSIZE) ? STORE_MEM : STORE_MMAP;
 	if (HEAPload(&bn->T->heap, BBP_physical(bn->batCacheid), "tail", TRUE) < 0) {
+		/* give the file back, under whichever name it has now */
+		if (GDKmove(BATDIR, bn->T->heap.filename, "new", NULL, heapfile, NULL) < 0)
+			(void) GDKmove(BATDIR, bn->T->heap.filename, NULL, NULL, heapfile, NULL);
 		HEAPfree(&bn->T->heap);
 		GDKfree(bs);
 		return NULL;
@@ -374,6 +377,46 @@ BATattach(int tt, const char *heapfile)
 	return bn;
 }
 
+/*
+ * BATwrap creates a read-only [void,tt] BAT on top of memory owned
+ * by the caller (e.g. the data of an R vector), without copying it.
+ * GDK never frees that memory; it must stay valid for the lifetime
+ * of the BAT, or until the BAT is first written to, at which point
+ * the heap is copied into memory of our own (see HEAPextend).
+ */
+BAT *
+BATwrap(int tt, void *base, BUN cnt)
+{
+	BATstore *bs;
+	BAT *bn;
+
+	ERRORcheck(tt <= 0 , "BATwrap: bad tail type (<=0)\n");
+	ERRORcheck(ATOMvarsized(tt), "BATwrap: bad tail type (varsized)\n");
+	ERRORcheck(cnt > BUN_MAX, "BATwrap: too many values\n");
+	bs = BATcreatedesc(TYPE_void, tt, 1);
+	if (bs == NULL)
+		return NULL;
+	bn = &bs->B;
+	BATsetdims(bn);
+	bn->hseqbase = 0;
+	BATkey(bn, TRUE);
+	bn->T->heap.base = base;
+	bn->T->heap.maxsize = bn->T->heap.size = tailsize(bn, cnt);
+	bn->T->heap.newstorage = bn->T->heap.storage = STORE_MEM;
+	bn->T->heap.external = 1;
+	BATsetcapacity(bn, cnt);
+	BATsetcount(bn, cnt);
+	if (cnt > 1) {
+		bn->tsorted = 0;
+		bn->trevsorted = 0;
+		bn->tdense = 0;
+		bn->tkey = 0;
+	}
+	bn->batRestricted = BAT_READ;
+	BBPcacheit(bs, 1);
+	return bn;
+}
+
 /*
  * The routine BATclone creates a bat with the same types as b.
  */
@@ -488,6 +531,7 @@ BATextend(BAT *b, BUN newcap)
 		return NULL;
 	HASHdestroy(b);
 	IMPSdestroy(b);
+	CMPdestroy(b);
 	return b;
 }
 
@@ -538,6 +582,7 @@ BATclear(BAT *b, int force)
 		HASHremove(bm);
 	}
 	IMPSdestroy(b);
+	CMPdestroy(b);
 
 	/* we must dispose of all inserted atoms */
 	if (b->batDeleted == b->batInserted &&
@@ -629,8 +674,11 @@ BATfree(BAT *b)
 	if (b->T->props)
 		PROPdestroy(b->T->props);
 	b->T->props = NULL;
-	HASHdestroy(b);
-	IMPSdestroy(b);
+	/* release the search accelerators, saved images stay */
+	HASHfree(b);
+	HASHfree(BATmirror(b));
+	IMPSfree(b);
+	CMPfree(b);
 	if (b->htype)
 		HEAPfree(&b->H->heap);
 	else
@@ -1246,6 +1294,7 @@ BUNins(BAT *b, const void *h, const void *t, bit force)
 		}
 	}
 	IMPSdestroy(b); /* no support for inserts in imprints yet */
+	CMPdestroy(b);
 	return b;
       bunins_failed:
 	return NULL;
@@ -1333,6 +1382,7 @@ BUNappend(BAT *b, const void *t, bit force)
 
 
 	IMPSdestroy(b); /* no support for inserts in imprints yet */
+	CMPdestroy(b);
 
 	/* first adapt the hashes; then the user-defined accelerators.
 	 * REASON: some accelerator updates (qsignature) use the hashes!
@@ -1522,6 +1572,7 @@ BUNdelete_(BAT *b, BUN p, bit force)
 	b->batCount--;
 	b->batDirty = 1;	/* bat is dirty */
 	IMPSdestroy(b); /* no support for inserts in imprints yet */
+	CMPdestroy(b);
 	return p;
 }
 
@@ -1612,6 +1663,8 @@ BUNinplace(BAT *b, BUN p, const void *h, const void *t, bit force)
 		BUN prv, nxt;
 
 		ALIGNinp(b, "BUNreplace", force);	/* zap alignment info */
+		IMPSdestroy(b);
+		CMPdestroy(b);
 		if (b->T->nil &&
 		    atom_CMP(BUNtail(bi, p), ATOMnilptr(b->ttype), b->ttype) == 0 &&
 		    atom_CMP(t, ATOMnilptr(b->ttype), b->ttype) != 0) {
@@ -2630,6 +2683,10 @@ BATsetaccess(BAT *b, int newmode)
 		if (VIEWreset(b) == NULL)
 			return NULL;
 	}
+	/* writing to wrapped memory: take a copy first */
+	if (newmode != BAT_READ && b->T->heap.external &&
+	    HEAPextend(&b->T->heap, b->T->heap.size) < 0)
+		return NULL;
 	bakmode = b->batRestricted;
 	bakdirty = b->batDirtydesc;
 	if (bakmode != newmode || (b->batSharecnt && newmode != BAT_READ)) {
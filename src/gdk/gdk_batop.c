@@ -428,7 +428,8 @@ BATins(BAT *b, BAT *n, bit force)
 BAT *
 BATappend(BAT *b, BAT *n, bit force)
 {
-	BUN sz;
+	BUN sz, first;
+	int shift;
 	int fastpath = 1;
 
 	if (b == NULL || n == NULL || (sz = BATcount(n)) == 0) {
@@ -447,17 +448,34 @@ BATappend(BAT *b, BAT *n, bit force)
 	}
 
 	b->batDirty = 1;
+	/* the compressed image is not maintained on append */
+	CMPdestroy(b);
 
 	if (sz > BATcapacity(b) - BUNlast(b)) {
 		/* if needed space exceeds a normal growth extend just
 		 * with what's needed */
 		BUN ncap = BUNlast(b) + sz;
 		BUN grows = BATgrows(b);
+		/* BATextend drops the search accelerators, but the
+		 * tail hash and imprints are maintained below */
+		Hash *hs = VIEWtparent(b) ? NULL : b->T->hash;
+		Imprints *imprints = VIEWtparent(b) ? NULL : b->T->imprints;
 
 		if (ncap > grows)
 			grows = ncap;
-		if (BATextend(b, grows) == NULL)
+		if (hs)
+			b->T->hash = NULL;
+		if (imprints)
+			b->T->imprints = NULL;
+		if (BATextend(b, grows) == NULL) {
+			b->T->hash = hs;
+			b->T->imprints = imprints;
 			goto bunins_failed;
+		}
+		b->T->hash = hs;
+		b->T->imprints = imprints;
+		if (hs && HASHgrow(hs, BATcapacity(b)) < 0)
+			HASHremove(BATmirror(b));
 	}
 
 	/* append two void,void bats */
@@ -496,7 +514,11 @@ BATappend(BAT *b, BAT *n, bit force)
 			return NULL;
 	}
 
-	IMPSdestroy(b); /* imprints do not support updates yet */
+	/* imprints are extended with the appended values below */
+	if (VIEWtparent(b))
+		IMPSdestroy(b);
+	first = BUNlast(b);
+	shift = b->T->shift;
 	/* a hash is useless for void bats */
 	if (b->H->hash)
 		HASHremove(b);
@@ -668,8 +690,18 @@ BATappend(BAT *b, BAT *n, bit force)
 	}
 	b->H->nonil &= n->H->nonil;
 	b->T->nonil &= n->T->nonil;
+	if (b->T->imprints) {
+		/* the imprints map cache lines of the old width, so
+		 * they do not survive a wider string offset heap */
+		if (b->T->shift != shift)
+			IMPSdestroy(b);
+		else
+			IMPSappend(b, first);
+	}
 	return b;
       bunins_failed:
+	IMPSdestroy(b);
+	CMPdestroy(b);
 	return NULL;
 }
 
@@ -745,6 +777,11 @@ BATreplace(BAT *b, BAT *n, bit force)
  * case for BATselect (range selection on sorted column) and
  * BATsemijoin (when two dense columns are semijoined).
  *
+ * When heaps carry headroom (GDK_heap_headroom), a fixed-width tail
+ * is always copied into a fresh heap, so that the embedding
+ * application can use the result in place; views would only give it
+ * a pointer into the middle of the parent heap.
+ *
  * NOTE new semantics, the selected range is excluding the high value.
  */
 BAT *
@@ -768,11 +805,25 @@ BATslice(BAT *b, BUN l, BUN h)
 		return NULL;
 	}
 
+	/*
+	 * Fixed-width tail and headroom requested: copy the tail in
+	 * one go.
+	 */
+	if (GDK_heap_headroom && b->htype == TYPE_void &&
+	    b->ttype != TYPE_void && !b->tvarsized) {
+		BUN cnt = h - l;
+
+		bn = BATnew(TYPE_void, b->ttype, cnt);
+		if (bn == NULL) {
+			return bn;
+		}
+		memcpy(Tloc(bn, BUNfirst(bn)), BUNtloc(bi, l), tailsize(b, cnt));
+		BATsetcount(bn, cnt);
 	/*
 	 * If the source BAT is readonly, then we can obtain a VIEW
 	 * that just reuses the memory of the source.
 	 */
-	if (BAThrestricted(b) == BAT_READ && BATtrestricted(b) == BAT_READ) {
+	} else if (BAThrestricted(b) == BAT_READ && BATtrestricted(b) == BAT_READ) {
 		BUN cnt = h - l;
 		bn = VIEWcreate_(b, b, TRUE);
 		bn->batFirst = bn->batDeleted = bn->batInserted = 0;
@@ -869,6 +920,7 @@ BATtopN(BAT *b, BUN topN)
 		BATsetcount(b, topN);
 	}
 	IMPSdestroy(b);
+	CMPdestroy(b);
 	/* we no longer know if there are NILs */
 	b->H->nil = b->htype == TYPE_void && b->hseqbase == oid_nil && topN >= 1;
 	b->T->nil = b->ttype == TYPE_void && b->tseqbase == oid_nil && topN >= 1;
@@ -1090,15 +1142,22 @@ BATordered_rev(BAT* b)
 	return b->hrevsorted;
 }
 
+#define PSORT_MIN	((size_t) 1 << 20)	/* minimum size for GDKpsort */
+
 /* figure out which sort function is to be called
  * stable sort can produce an error (not enough memory available),
- * "quick" sort does not produce errors */
+ * "quick" sort does not produce errors
+ * large inputs are sorted in parallel; if that cannot be done (not
+ * enough memory for the merge buffers), we sort sequentially */
 static gdk_return
 do_sort(void *h, void *t, const void *base, size_t n, int hs, int ts, int tpe,
 	int reverse, int stable)
 {
 	if (n <= 1)		/* trivially sorted */
 		return GDK_SUCCEED;
+	if (n >= PSORT_MIN && GDKnr_threads > 1 &&
+	    GDKpsort(h, t, base, n, hs, ts, tpe, reverse, stable) == 0)
+		return GDK_SUCCEED;
 	if (reverse) {
 		if (stable) {
 			if (GDKssort_rev(h, t, base, n, hs, ts, tpe) < 0) {
@@ -1178,6 +1237,7 @@ BATorder_internal(BAT *b, int stable, int reverse, int copy, const char *func)
 	b->tsorted = b->trevsorted = 0;
 	HASHdestroy(b);
 	IMPSdestroy(b);
+	CMPdestroy(b);
 	ALIGNdel(b, func, FALSE);
 	b->hdense = 0;
 	b->tdense = 0;
@@ -1501,6 +1561,7 @@ BATrevert(BAT *b)
 	}
 	HASHdestroy(b);
 	IMPSdestroy(b);
+	CMPdestroy(b);
 	/* interchange sorted and revsorted */
 	x = b->hrevsorted;
 	b->hrevsorted = b->hsorted;
@@ -1974,6 +2035,7 @@ BATpropagate(BAT *dst, BAT *src, int idx)
 		}							\
 		HASHdestroy(bn);					\
 		IMPSdestroy(bn);					\
+		CMPdestroy(bn);					\
 	} while (0)
 
 BAT *
@@ -3248,6 +3248,23 @@ BBPbackup(BAT *b, bit subcommit)
 		      b->ttype && b->tvarsized,
 		      b->batDirty || b->T->vheap->dirty, subcommit) < 0)
 		return -1;
+	/* the search accelerators are saved along with a dirty bat */
+	if (b->H->hash && b->H->hash != (Hash *) -1 &&
+	    do_backup(srcdir, nme, "hhash", b->H->hash->heap, 1,
+		      BATdirty(b), subcommit) < 0)
+		return -1;
+	if (b->T->hash && b->T->hash != (Hash *) -1 &&
+	    do_backup(srcdir, nme, "thash", b->T->hash->heap, 1,
+		      BATdirty(b), subcommit) < 0)
+		return -1;
+	if (b->T->imprints &&
+	    (do_backup(srcdir, nme, "imps", b->T->imprints->imps, 1,
+		       BATdirty(b), subcommit) < 0 ||
+	     do_backup(srcdir, nme, "dict", b->T->imprints->dict, 1,
+		       BATdirty(b), subcommit) < 0 ||
+	     do_backup(srcdir, nme, "bins", b->T->imprints->bins, 1,
+		       BATdirty(b), subcommit) < 0))
+		return -1;
 	return 0;
 }
 
@@ -3664,12 +3681,15 @@ BBPdiskscan(const char *parent)
 		} else if (strncmp(p + 1, "theap", 5) == 0) {
 			BAT *b = getdesc(bid);
 			delete = (b == NULL || !b->T->vheap || b->batCopiedtodisk == 0);
-		} else if (strncmp(p + 1, "hhash", 5) == 0) {
-			BAT *b = getdesc(bid);
-			delete = (b == NULL || !b->H->hash);
-		} else if (strncmp(p + 1, "thash", 5) == 0) {
+		} else if (strncmp(p + 1, "hhash", 5) == 0 ||
+			   strncmp(p + 1, "thash", 5) == 0 ||
+			   strncmp(p + 1, "imps", 4) == 0 ||
+			   strncmp(p + 1, "dict", 4) == 0 ||
+			   strncmp(p + 1, "bins", 4) == 0) {
+			/* saved search accelerators are loaded on
+			 * demand, and validated then */
 			BAT *b = getdesc(bid);
-			delete = (b == NULL || !b->T->hash);
+			delete = (b == NULL || b->batCopiedtodisk == 0);
 		} else if (strncmp(p + 1, "priv", 4) != 0 && strncmp(p + 1, "new", 3) != 0 && strncmp(p + 1, "head", 4) != 0 && strncmp(p + 1, "tail", 4) != 0) {
 			ok = FALSE;
 		}
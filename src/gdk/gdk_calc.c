@@ -885,6 +885,143 @@ VARcalcisnotnil(ValPtr ret, const ValRecord *v)
 	return GDK_SUCCEED;
 }
 
+/* ---------------------------------------------------------------------- */
+/* nil-free arithmetic */
+
+/* When neither operand contains nils and there is no candidate list,
+ * addition, subtraction, multiplication and floating point division
+ * use loops without branches, which the compiler can vectorise.
+ * Rather than testing each result, a possible overflow is collected
+ * per block of values.  Only when one shows up (including a result
+ * that happens to be the nil value) we give up and let the checked
+ * loops below redo the work, so errors and nils are produced exactly
+ * as before. */
+
+#define NONIL_BLOCK	1024
+
+#define RANGE_CHECK(TYPE, L, R, X)					\
+	(((X) <= GDK_##TYPE##_min) | ((X) > GDK_##TYPE##_max))
+#define DIV_CHECK(TYPE, L, R, X)					\
+	(RANGE_CHECK(TYPE, L, R, X) | ((R) == 0))
+/* lng has no wider type: compute modulo 2^64 and check signs */
+#define ADD_LNG_CHECK(TYPE, L, R, X)					\
+	(((lng) (X) == GDK_lng_min) |					\
+	 ((((L) ^ (lng) (X)) & ((R) ^ (lng) (X))) < 0))
+#define SUB_LNG_CHECK(TYPE, L, R, X)					\
+	(((lng) (X) == GDK_lng_min) |					\
+	 ((((L) ^ (R)) & ((L) ^ (lng) (X))) < 0))
+
+#define NONIL_LOOP(TYPE, WIDE, L, R, OP, CHECK)				\
+	do {								\
+		BUN b, e;						\
+		for (b = 0; b < cnt; b = e) {				\
+			int ovf = 0;					\
+			e = b + NONIL_BLOCK < cnt ? b + NONIL_BLOCK : cnt; \
+			for (k = b; k < e; k++) {			\
+				WIDE x = (WIDE) (L) OP (R);		\
+				ovf |= CHECK(TYPE, L, R, x);		\
+				dst[k] = (TYPE) x;			\
+			}						\
+			if (ovf)					\
+				return GDK_FAIL;			\
+		}							\
+	} while (0)
+
+#define NONIL_TYPE(TYPE, WIDE, OP, CHECK)				\
+	do {								\
+		const TYPE *lft = l, *rgt = r;				\
+		TYPE *dst = d;						\
+		if (incr1 && incr2) {					\
+			NONIL_LOOP(TYPE, WIDE, lft[k], rgt[k], OP, CHECK); \
+		} else if (incr2) {					\
+			const TYPE v = *lft;				\
+			NONIL_LOOP(TYPE, WIDE, v, rgt[k], OP, CHECK);	\
+		} else {						\
+			const TYPE v = *rgt;				\
+			NONIL_LOOP(TYPE, WIDE, lft[k], v, OP, CHECK);	\
+		}							\
+	} while (0)
+
+#define NONIL_INT(TYPE, WIDE)						\
+	switch (op) {							\
+	case '+':							\
+		NONIL_TYPE(TYPE, WIDE, +, RANGE_CHECK);			\
+		break;							\
+	case '-':							\
+		NONIL_TYPE(TYPE, WIDE, -, RANGE_CHECK);			\
+		break;							\
+	case '*':							\
+		NONIL_TYPE(TYPE, WIDE, *, RANGE_CHECK);			\
+		break;							\
+	default:							\
+		return GDK_FAIL;					\
+	}
+
+#define NONIL_FLT(TYPE)							\
+	switch (op) {							\
+	case '+':							\
+		NONIL_TYPE(TYPE, TYPE, +, RANGE_CHECK);			\
+		break;							\
+	case '-':							\
+		NONIL_TYPE(TYPE, TYPE, -, RANGE_CHECK);			\
+		break;							\
+	case '*':							\
+		NONIL_TYPE(TYPE, TYPE, *, RANGE_CHECK);			\
+		break;							\
+	case '/':							\
+		NONIL_TYPE(TYPE, TYPE, /, DIV_CHECK);			\
+		break;							\
+	default:							\
+		return GDK_FAIL;					\
+	}
+
+/* Returns GDK_SUCCEED if the result was computed, GDK_FAIL if the
+ * caller must use the checked loop instead.  At least one of incr1
+ * and incr2 must be 1, the other may be 0 for a constant operand. */
+static int
+nonil_arith(int op, const void *l, int tp1, int incr1,
+	    const void *r, int tp2, int incr2,
+	    void *d, int tp, BUN cnt)
+{
+	BUN k;
+
+	tp = ATOMstorage(tp);
+	if (ATOMstorage(tp1) != tp || ATOMstorage(tp2) != tp)
+		return GDK_FAIL;
+	switch (tp) {
+	case TYPE_bte:
+		NONIL_INT(bte, int);
+		break;
+	case TYPE_sht:
+		NONIL_INT(sht, int);
+		break;
+	case TYPE_int:
+		NONIL_INT(int, lng);
+		break;
+	case TYPE_lng:
+		switch (op) {
+		case '+':
+			NONIL_TYPE(lng, ulng, +, ADD_LNG_CHECK);
+			break;
+		case '-':
+			NONIL_TYPE(lng, ulng, -, SUB_LNG_CHECK);
+			break;
+		default:
+			return GDK_FAIL;
+		}
+		break;
+	case TYPE_flt:
+		NONIL_FLT(flt);
+		break;
+	case TYPE_dbl:
+		NONIL_FLT(dbl);
+		break;
+	default:
+		return GDK_FAIL;
+	}
+	return GDK_SUCCEED;
+}
+
 /* ---------------------------------------------------------------------- */
 /* addition (any numeric type) */
 
@@ -1894,12 +2031,19 @@ BATcalcadd(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = add_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
-				  Tloc(b2, b2->U->first), b2->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b1->H->seq,
-				  abort_on_error, "BATcalcadd");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b1->T->nonil && b2->T->nonil &&
+	    nonil_arith('+', Tloc(b1, b1->U->first), b1->T->type, 1,
+			Tloc(b2, b2->U->first), b2->T->type, 1,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = add_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
+					  Tloc(b2, b2->U->first), b2->T->type, 1,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b1->H->seq,
+					  abort_on_error, "BATcalcadd");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -1942,12 +2086,19 @@ BATcalcaddcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = add_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
-				  VALptr(v), v->vtype, 0,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalcaddcst");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b->T->nonil && !VALisnil(v) &&
+	    nonil_arith('+', Tloc(b, b->U->first), b->T->type, 1,
+			VALptr(v), v->vtype, 0,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = add_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
+					  VALptr(v), v->vtype, 0,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b->H->seq,
+					  abort_on_error, "BATcalcaddcst");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -1990,12 +2141,19 @@ BATcalccstadd(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = add_typeswitchloop(VALptr(v), v->vtype, 0,
-				  Tloc(b, b->U->first), b->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalccstadd");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b->T->nonil && !VALisnil(v) &&
+	    nonil_arith('+', VALptr(v), v->vtype, 0,
+			Tloc(b, b->U->first), b->T->type, 1,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = add_typeswitchloop(VALptr(v), v->vtype, 0,
+					  Tloc(b, b->U->first), b->T->type, 1,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b->H->seq,
+					  abort_on_error, "BATcalccstadd");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -3117,12 +3275,19 @@ BATcalcsub(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = sub_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
-				  Tloc(b2, b2->U->first), b2->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b1->H->seq,
-				  abort_on_error, "BATcalcsub");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b1->T->nonil && b2->T->nonil &&
+	    nonil_arith('-', Tloc(b1, b1->U->first), b1->T->type, 1,
+			Tloc(b2, b2->U->first), b2->T->type, 1,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = sub_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
+					  Tloc(b2, b2->U->first), b2->T->type, 1,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b1->H->seq,
+					  abort_on_error, "BATcalcsub");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -3160,12 +3325,19 @@ BATcalcsubcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = sub_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
-				  VALptr(v), v->vtype, 0,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalcsubcst");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b->T->nonil && !VALisnil(v) &&
+	    nonil_arith('-', Tloc(b, b->U->first), b->T->type, 1,
+			VALptr(v), v->vtype, 0,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = sub_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
+					  VALptr(v), v->vtype, 0,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b->H->seq,
+					  abort_on_error, "BATcalcsubcst");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -3208,12 +3380,19 @@ BATcalccstsub(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = sub_typeswitchloop(VALptr(v), v->vtype, 0,
-				  Tloc(b, b->U->first), b->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalccstsub");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b->T->nonil && !VALisnil(v) &&
+	    nonil_arith('-', VALptr(v), v->vtype, 0,
+			Tloc(b, b->U->first), b->T->type, 1,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = sub_typeswitchloop(VALptr(v), v->vtype, 0,
+					  Tloc(b, b->U->first), b->T->type, 1,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b->H->seq,
+					  abort_on_error, "BATcalccstsub");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -4463,12 +4642,19 @@ BATcalcmul(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = mul_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
-				  Tloc(b2, b2->U->first), b2->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b1->H->seq,
-				  abort_on_error, "BATcalcmul");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b1->T->nonil && b2->T->nonil &&
+	    nonil_arith('*', Tloc(b1, b1->U->first), b1->T->type, 1,
+			Tloc(b2, b2->U->first), b2->T->type, 1,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = mul_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
+					  Tloc(b2, b2->U->first), b2->T->type, 1,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b1->H->seq,
+					  abort_on_error, "BATcalcmul");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -4506,12 +4692,19 @@ BATcalcmulcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = mul_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
-				  VALptr(v), v->vtype, 0,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalcmulcst");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b->T->nonil && !VALisnil(v) &&
+	    nonil_arith('*', Tloc(b, b->U->first), b->T->type, 1,
+			VALptr(v), v->vtype, 0,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = mul_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
+					  VALptr(v), v->vtype, 0,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b->H->seq,
+					  abort_on_error, "BATcalcmulcst");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -4564,12 +4757,19 @@ BATcalccstmul(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = mul_typeswitchloop(VALptr(v), v->vtype, 0,
-				  Tloc(b, b->U->first), b->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalccstmul");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b->T->nonil && !VALisnil(v) &&
+	    nonil_arith('*', VALptr(v), v->vtype, 0,
+			Tloc(b, b->U->first), b->T->type, 1,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = mul_typeswitchloop(VALptr(v), v->vtype, 0,
+					  Tloc(b, b->U->first), b->T->type, 1,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b->H->seq,
+					  abort_on_error, "BATcalccstmul");
 
 	if (nils == BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -5743,12 +5943,19 @@ BATcalcdiv(BAT *b1, BAT *b2, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = div_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
-				  Tloc(b2, b2->U->first), b2->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b1->H->seq,
-				  abort_on_error, "BATcalcdiv");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b1->T->nonil && b2->T->nonil &&
+	    nonil_arith('/', Tloc(b1, b1->U->first), b1->T->type, 1,
+			Tloc(b2, b2->U->first), b2->T->type, 1,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = div_typeswitchloop(Tloc(b1, b1->U->first), b1->T->type, 1,
+					  Tloc(b2, b2->U->first), b2->T->type, 1,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b1->H->seq,
+					  abort_on_error, "BATcalcdiv");
 
 	if (nils >= BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -5786,12 +5993,19 @@ BATcalcdivcst(BAT *b, const ValRecord *v, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = div_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
-				  VALptr(v), v->vtype, 0,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalcdivcst");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b->T->nonil && !VALisnil(v) &&
+	    nonil_arith('/', Tloc(b, b->U->first), b->T->type, 1,
+			VALptr(v), v->vtype, 0,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = div_typeswitchloop(Tloc(b, b->U->first), b->T->type, 1,
+					  VALptr(v), v->vtype, 0,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b->H->seq,
+					  abort_on_error, "BATcalcdivcst");
 
 	if (nils >= BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -5847,12 +6061,19 @@ BATcalccstdiv(const ValRecord *v, BAT *b, BAT *s, int tp, int abort_on_error)
 	if (bn == NULL)
 		return NULL;
 
-	nils = div_typeswitchloop(VALptr(v), v->vtype, 0,
-				  Tloc(b, b->U->first), b->T->type, 1,
-				  Tloc(bn, bn->U->first), tp,
-				  cnt, start, end,
-				  cand, candend, b->H->seq,
-				  abort_on_error, "BATcalccstdiv");
+	if (cand == NULL && start == 0 && end == cnt &&
+	    b->T->nonil && !VALisnil(v) &&
+	    nonil_arith('/', VALptr(v), v->vtype, 0,
+			Tloc(b, b->U->first), b->T->type, 1,
+			Tloc(bn, bn->U->first), tp, cnt) == GDK_SUCCEED)
+		nils = 0;
+	else
+		nils = div_typeswitchloop(VALptr(v), v->vtype, 0,
+					  Tloc(b, b->U->first), b->T->type, 1,
+					  Tloc(bn, bn->U->first), tp,
+					  cnt, start, end,
+					  cand, candend, b->H->seq,
+					  abort_on_error, "BATcalccstdiv");
 
 	if (nils >= BUN_NONE) {
 		BBPunfix(bn->batCacheid);
@@ -126,6 +126,8 @@ gdk_export BAT *BATgroupsize(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_ni
 gdk_export BAT *BATgroupmin(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
 gdk_export BAT *BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
 gdk_export BAT *BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
+gdk_export BAT *BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, dbl quantile, int skip_nils, int abort_on_error);
+gdk_export BAT *BATgroupquantile_approx(BAT *b, BAT *g, BAT *e, BAT *s, int tp, dbl quantile, int skip_nils, int abort_on_error);
 /* helper function for grouped aggregates */
 gdk_export const char *BATgroupaggrinit(
 	const BAT *b, const BAT *g, const BAT *e, const BAT *s,
@@ -0,0 +1,845 @@
+/*
+ * The contents of this file are subject to the MonetDB Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.monetdb.org/Legal/MonetDBLicense
+ *
+ * Software distributed under the License is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+ * License for the specific language governing rights and limitations
+ * under the License.
+ *
+ * The Original Code is the MonetDB Database System.
+ *
+ * The Initial Developer of the Original Code is CWI.
+ * Portions created by CWI are Copyright (C) 1997-July 2008 CWI.
+ * Copyright August 2008-2013 MonetDB B.V.
+ * All Rights Reserved.
+ */
+
+/*
+ * Lightweight compression of persistent columns.  The tail is cut
+ * into blocks of CMP_BLOCK values, and each block is stored with the
+ * smallest of
+ *  - frame of reference: the values minus the block minimum, packed
+ *    in as few bits as the range of the block needs;
+ *  - delta: for sorted blocks, the differences with the previous
+ *    value, packed likewise;
+ *  - run length: the values of the runs packed as with frame of
+ *    reference, followed by the packed run lengths.
+ * String columns are compressed on their heap offsets.  As long as
+ * the string heap eliminates all doubles, the offsets are a
+ * dictionary encoding of the strings, which makes low-cardinality
+ * string columns compress well.
+ *
+ * The header of a block holds the minimum, maximum and sum of its
+ * values, hence selections skip blocks or take them whole and sums
+ * of whole blocks come from the headers.  Other blocks are decoded
+ * into a cache-sized vector of values relative to the block minimum,
+ * against which the bounds are compared after translating them to
+ * that domain.
+ *
+ * The compressed image is a scan accelerator, not a storage format:
+ * it lives next to the column like the imprints do, and the column
+ * keeps its raw heap, since every BAT accessor expects the raw array.
+ * An image therefore costs memory and disk space on top of the
+ * column (at most half of it, images that compress less are not
+ * kept); what it buys is that selections and sums read the image
+ * instead of the column, so a memory mapped column stays on disk.
+ *
+ * Images are only built on request, by BATcompress; the select and
+ * sum paths use an image that is in memory or saved with the BAT,
+ * but never build one.  The image is saved along with the BAT and
+ * thrown away on update.  A BAT saved without an image in memory
+ * loses the saved one, as the header cannot tell in-place updates
+ * from the version it was built for.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+
+#define CMP_BLOCK	4096		/* values per block */
+#define CMP_MINSIZE	((BUN) 1 << 16)	/* smaller bats are not compressed */
+#define CMP_MAGIC	((BUN) 0x434D5031)
+
+#define CMP_FOR		0
+#define CMP_DELTA	1
+#define CMP_RLE		2
+
+typedef struct {
+	BUN magic;
+	BUN first;		/* BUNfirst of the bat */
+	BUN last;		/* BUNlast of the bat */
+	BUN blocks;		/* number of blocks */
+	BUN width;		/* width of the tail */
+} CmpHeader;
+
+typedef struct {
+	lng min, max;		/* range of the values, nils included */
+	lng sum;		/* sum of the non-nil values (not for lng) */
+	size_t off;		/* offset of the packed values in the heap */
+	unsigned int nils;	/* number of nils */
+	unsigned int runs;	/* CMP_RLE: number of runs */
+	bte method;		/* CMP_FOR, CMP_DELTA or CMP_RLE */
+	bte bits;		/* bits per packed value */
+	bte lbits;		/* CMP_RLE: bits per run length */
+} CmpBlock;
+
+#define CMPheader(c)	((CmpHeader *) (c)->heap->base)
+#define CMPblock(c, k)	((CmpBlock *) ((c)->heap->base + sizeof(CmpHeader)) + (k))
+#define CMPwords(n, bits)	(((size_t) (n) * (bits) + 63) / 64)
+
+/* can the tail of b be compressed: integers that compare like their
+ * storage type, or strings */
+static int
+cmp_type(BAT *b)
+{
+	int t = b->ttype;
+
+	switch (ATOMstorage(t)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+		return BATatoms[t].atomCmp == BATatoms[ATOMstorage(t)].atomCmp;
+	case TYPE_str:
+		return t == TYPE_str;
+	default:
+		return 0;
+	}
+}
+
+static int
+cmp_bits(uint64_t v)
+{
+	int bits = 0;
+
+	while (v) {
+		bits++;
+		v >>= 1;
+	}
+	return bits;
+}
+
+static void
+cmp_pack(uint64_t *dst, const uint64_t *src, BUN n, int bits)
+{
+	size_t pos = 0;
+	BUN i;
+
+	memset(dst, 0, CMPwords(n, bits) * sizeof(uint64_t));
+	if (bits == 0)
+		return;
+	for (i = 0; i < n; i++, pos += bits) {
+		size_t w = pos >> 6, o = pos & 63;
+
+		dst[w] |= src[i] << o;
+		if (o + bits > 64)
+			dst[w + 1] |= src[i] >> (64 - o);
+	}
+}
+
+static void
+cmp_unpack(uint64_t *dst, const uint64_t *src, BUN n, int bits)
+{
+	uint64_t mask = bits == 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << bits) - 1;
+	size_t pos = 0;
+	BUN i;
+
+	if (bits == 0) {
+		memset(dst, 0, n * sizeof(uint64_t));
+		return;
+	}
+	for (i = 0; i < n; i++, pos += bits) {
+		size_t w = pos >> 6, o = pos & 63;
+		uint64_t v = src[w] >> o;
+
+		if (o + bits > 64)
+			v |= src[w + 1] << (64 - o);
+		dst[i] = v & mask;
+	}
+}
+
+/* the values of b at positions [p, p+n) from BUNfirst */
+static void
+cmp_values(BAT *b, BUN p, BUN n, lng *v)
+{
+	const void *col = Tloc(b, BUNfirst(b));
+	BUN i;
+
+	switch (ATOMstorage(b->ttype)) {
+	case TYPE_bte:
+		for (i = 0; i < n; i++)
+			v[i] = ((const bte *) col)[p + i];
+		break;
+	case TYPE_sht:
+		for (i = 0; i < n; i++)
+			v[i] = ((const sht *) col)[p + i];
+		break;
+	case TYPE_int:
+		for (i = 0; i < n; i++)
+			v[i] = ((const int *) col)[p + i];
+		break;
+	case TYPE_lng:
+		for (i = 0; i < n; i++)
+			v[i] = ((const lng *) col)[p + i];
+		break;
+	default:
+		/* string offsets, as stored */
+		switch (b->T->width) {
+		case 1:
+			for (i = 0; i < n; i++)
+				v[i] = ((const unsigned char *) col)[p + i];
+			break;
+		case 2:
+			for (i = 0; i < n; i++)
+				v[i] = ((const unsigned short *) col)[p + i];
+			break;
+#if SIZEOF_VAR_T == 8
+		case 4:
+			for (i = 0; i < n; i++)
+				v[i] = ((const unsigned int *) col)[p + i];
+			break;
+#endif
+		default:
+			for (i = 0; i < n; i++)
+				v[i] = (lng) ((const var_t *) col)[p + i];
+			break;
+		}
+	}
+}
+
+/* the nil of the tail of b; strings are not compared on nil */
+static lng
+cmp_nil(BAT *b)
+{
+	switch (ATOMstorage(b->ttype)) {
+	case TYPE_bte:
+		return bte_nil;
+	case TYPE_sht:
+		return sht_nil;
+	case TYPE_int:
+		return int_nil;
+	case TYPE_lng:
+		return lng_nil;
+	default:
+		return 0;
+	}
+}
+
+/* compress the n values v into block blk, appending the packed values
+ * to heap h; tmp holds 2 * CMP_BLOCK values */
+static int
+cmp_block(Heap *h, CmpBlock *blk, const lng *v, BUN n, int isstr, lng nil,
+	  uint64_t *tmp)
+{
+	uint64_t *u = tmp, *l = tmp + CMP_BLOCK, maxd = 0, maxl = 0;
+	size_t fsz, dsz, rsz, sz;
+	int sorted = 1, dbits;
+	BUN i, r;
+
+	blk->min = blk->max = v[0];
+	blk->sum = 0;
+	blk->nils = 0;
+	for (i = 0; i < n; i++) {
+		if (v[i] < blk->min)
+			blk->min = v[i];
+		if (v[i] > blk->max)
+			blk->max = v[i];
+		if (i > 0 && v[i] < v[i - 1])
+			sorted = 0;
+		if (isstr)
+			continue;
+		if (v[i] == nil)
+			blk->nils++;
+		else
+			blk->sum += v[i];
+	}
+	blk->bits = (bte) cmp_bits((uint64_t) blk->max - (uint64_t) blk->min);
+	fsz = CMPwords(n, blk->bits);
+	dsz = (size_t) -1;
+	dbits = 0;
+	if (sorted) {
+		for (i = 1; i < n; i++)
+			if ((uint64_t) v[i] - (uint64_t) v[i - 1] > maxd)
+				maxd = (uint64_t) v[i] - (uint64_t) v[i - 1];
+		dbits = cmp_bits(maxd);
+		dsz = CMPwords(n - 1, dbits);
+	}
+	for (i = 1, r = 1; i < n; i++)
+		r += v[i] != v[i - 1];
+	blk->runs = (unsigned int) r;
+	rsz = (size_t) -1;
+	if (r < n / 2) {
+		for (i = 1, r = 0, l[0] = 0; i < n; i++) {
+			if (v[i] != v[i - 1])
+				l[++r] = 0;
+			else if (++l[r] > maxl)
+				maxl = l[r];
+		}
+		blk->lbits = (bte) cmp_bits(maxl);
+		rsz = CMPwords(blk->runs, blk->bits) +
+			CMPwords(blk->runs, blk->lbits);
+	}
+
+	if (rsz < fsz && rsz < dsz) {
+		blk->method = CMP_RLE;
+		sz = rsz;
+	} else if (dsz < fsz) {
+		blk->method = CMP_DELTA;
+		blk->bits = (bte) dbits;
+		sz = dsz;
+	} else {
+		blk->method = CMP_FOR;
+		sz = fsz;
+	}
+	blk->off = h->free;
+	if (h->free + sz * sizeof(uint64_t) > h->size &&
+	    HEAPextend(h, MAX(h->size * 2, h->free + sz * sizeof(uint64_t))) < 0)
+		return -1;
+
+	switch (blk->method) {
+	case CMP_FOR:
+		for (i = 0; i < n; i++)
+			u[i] = (uint64_t) v[i] - (uint64_t) blk->min;
+		cmp_pack((uint64_t *) (h->base + h->free), u, n, blk->bits);
+		break;
+	case CMP_DELTA:
+		for (i = 1; i < n; i++)
+			u[i - 1] = (uint64_t) v[i] - (uint64_t) v[i - 1];
+		cmp_pack((uint64_t *) (h->base + h->free), u, n - 1, blk->bits);
+		break;
+	case CMP_RLE:
+		for (i = 1, r = 0, u[0] = (uint64_t) v[0] - (uint64_t) blk->min; i < n; i++)
+			if (v[i] != v[i - 1])
+				u[++r] = (uint64_t) v[i] - (uint64_t) blk->min;
+		cmp_pack((uint64_t *) (h->base + h->free), u, blk->runs, blk->bits);
+		cmp_pack((uint64_t *) (h->base + h->free) +
+			 CMPwords(blk->runs, blk->bits), l, blk->runs, blk->lbits);
+		break;
+	}
+	h->free += sz * sizeof(uint64_t);
+	return 0;
+}
+
+/* decode n values of block blk relative to its minimum into dst; for
+ * CMP_RLE the run values go to dst and the run lengths (minus one) to
+ * len instead */
+static void
+cmp_decode(const Compressed *c, const CmpBlock *blk, BUN n, uint64_t *dst,
+	   uint64_t *len)
+{
+	const uint64_t *src = (const uint64_t *) (c->heap->base + blk->off);
+	BUN i;
+
+	switch (blk->method) {
+	case CMP_FOR:
+		cmp_unpack(dst, src, n, blk->bits);
+		break;
+	case CMP_DELTA:
+		cmp_unpack(dst + 1, src, n - 1, blk->bits);
+		dst[0] = 0;
+		for (i = 1; i < n; i++)
+			dst[i] += dst[i - 1];
+		break;
+	case CMP_RLE:
+		cmp_unpack(dst, src, blk->runs, blk->bits);
+		cmp_unpack(len, src + CMPwords(blk->runs, blk->bits),
+			   blk->runs, blk->lbits);
+		break;
+	}
+}
+
+static const char *
+cmp_filename(BAT *b)
+{
+	return BBP_physical(b->batCacheid);
+}
+
+/* load the saved image of b, if it is still valid */
+static Compressed *
+CMPload(BAT *b)
+{
+	Compressed *c;
+	CmpHeader *hd;
+
+	if (b->batPersistence != PERSISTENT || BATdirty(b) ||
+	    b->batCacheid < 0)
+		return NULL;
+	if ((c = (Compressed *) GDKzalloc(sizeof(Compressed))) == NULL ||
+	    (c->heap = (Heap *) GDKzalloc(sizeof(Heap))) == NULL ||
+	    HEAPloadindex(c->heap, cmp_filename(b), "cmp") < 0) {
+		/* nothing (usable) saved */
+		if (c) {
+			if (c->heap)
+				GDKfree(c->heap->filename);
+			GDKfree(c->heap);
+			GDKfree(c);
+		}
+		return NULL;
+	}
+	hd = CMPheader(c);
+	if (c->heap->free < sizeof(CmpHeader) ||
+	    hd->magic != CMP_MAGIC ||
+	    hd->first != BUNfirst(b) ||
+	    hd->last != BUNlast(b) ||
+	    hd->width != (BUN) b->T->width ||
+	    hd->blocks != (BATcount(b) + CMP_BLOCK - 1) / CMP_BLOCK ||
+	    c->heap->free < sizeof(CmpHeader) + hd->blocks * sizeof(CmpBlock)) {
+		/* stale or damaged: throw it away */
+		ALGODEBUG fprintf(stderr, "#CMPload(%s): discarded saved image\n", BATgetId(b));
+		HEAPdelete(c->heap, cmp_filename(b), "cmp");
+		GDKfree(c->heap);
+		GDKfree(c);
+		return NULL;
+	}
+	c->blocks = hd->blocks;
+	ALGODEBUG fprintf(stderr, "#CMPload(%s): loaded " BUNFMT " blocks\n", BATgetId(b), c->blocks);
+	return c;
+}
+
+int
+CMPsave(BAT *b)
+{
+	Compressed *c = b->T->compressed;
+
+	if (b->batCacheid < 0 || VIEWtparent(b) ||
+	    b->batPersistence != PERSISTENT)
+		return 0;
+	if (c == NULL || c->heap == NULL) {
+		/* every update drops the image, and in-place updates
+		 * do not show in the header, so an image saved with
+		 * an earlier version of the bat must go */
+		return GDKunlink(BATDIR, cmp_filename(b), "cmp");
+	}
+	if (c->heap->storage != STORE_MEM)
+		return 0;	/* loaded, nothing new to save */
+	if (HEAPsave(c->heap, cmp_filename(b), "cmp") < 0) {
+		GDKunlink(BATDIR, cmp_filename(b), "cmp");
+		return -1;
+	}
+	return 0;
+}
+
+/* the image of b that is in memory or saved, without building one */
+static Compressed *
+cmp_get(BAT *b)
+{
+	Compressed *c;
+
+	if (!BAThdense(b) || VIEWtparent(b) ||
+	    b->batPersistence != PERSISTENT || b->batCacheid < 0 ||
+	    BATcount(b) < CMP_MINSIZE || !cmp_type(b))
+		return NULL;
+	MT_lock_set(&GDKcompressLock(ABS(b->batCacheid)), "cmp_get");
+	if (b->T->compressed == NULL)
+		b->T->compressed = CMPload(b);
+	c = b->T->compressed;
+	MT_lock_unset(&GDKcompressLock(ABS(b->batCacheid)), "cmp_get");
+	return c && c->heap ? c : NULL;
+}
+
+/*
+ * Build or load the compressed image of b.  Only persistent bats of
+ * at least CMP_MINSIZE values are compressed.  An image that does not
+ * pay off is remembered without a heap, so that it is not tried over
+ * and over again.  Returns b, or NULL if there is no usable image.
+ */
+BAT *
+BATcompress(BAT *b)
+{
+	Compressed *c;
+	BUN cnt = BATcount(b), k, n;
+	lng *v;
+	uint64_t *tmp;
+	size_t rawsize;
+	int isstr, ret = 0;
+	lng nil;
+
+	BATcheck(b, "BATcompress");
+	if (!BAThdense(b) || VIEWtparent(b) ||
+	    b->batPersistence != PERSISTENT || b->batCacheid < 0 ||
+	    cnt < CMP_MINSIZE || !cmp_type(b))
+		return NULL;
+	MT_lock_set(&GDKcompressLock(ABS(b->batCacheid)), "BATcompress");
+	if (b->T->compressed == NULL)
+		b->T->compressed = CMPload(b);
+	if ((c = b->T->compressed) != NULL) {
+		MT_lock_unset(&GDKcompressLock(ABS(b->batCacheid)), "BATcompress");
+		return c->heap ? b : NULL;
+	}
+
+	isstr = ATOMstorage(b->ttype) == TYPE_str;
+	nil = cmp_nil(b);
+	rawsize = (size_t) cnt * b->T->width;
+	v = GDKmalloc(CMP_BLOCK * sizeof(lng));
+	tmp = GDKmalloc(2 * CMP_BLOCK * sizeof(uint64_t));
+	c = (Compressed *) GDKzalloc(sizeof(Compressed));
+	if (c)
+		c->heap = (Heap *) GDKzalloc(sizeof(Heap));
+	if (v == NULL || tmp == NULL || c == NULL || c->heap == NULL ||
+	    HEAPalloc(c->heap, sizeof(CmpHeader) +
+		      (cnt + CMP_BLOCK - 1) / CMP_BLOCK * sizeof(CmpBlock) +
+		      rawsize / 4, 1) < 0) {
+		GDKfree(v);
+		GDKfree(tmp);
+		if (c)
+			GDKfree(c->heap);
+		GDKfree(c);
+		MT_lock_unset(&GDKcompressLock(ABS(b->batCacheid)), "BATcompress");
+		return NULL;
+	}
+	c->blocks = (cnt + CMP_BLOCK - 1) / CMP_BLOCK;
+	c->heap->free = sizeof(CmpHeader) + c->blocks * sizeof(CmpBlock);
+	for (k = 0; k < c->blocks && ret == 0; k++) {
+		/* headers are addressed afresh, the heap may move */
+		n = MIN(CMP_BLOCK, cnt - k * CMP_BLOCK);
+		cmp_values(b, k * CMP_BLOCK, n, v);
+		ret = cmp_block(c->heap, CMPblock(c, k), v, n, isstr, nil, tmp);
+	}
+	GDKfree(v);
+	GDKfree(tmp);
+	if (ret < 0 || c->heap->free >= rawsize / 2) {
+		/* does not pay off */
+		ALGODEBUG fprintf(stderr, "#BATcompress(%s#" BUNFMT "): "
+				  "not compressed, " SZFMT " bytes\n",
+				  BATgetId(b), cnt, c->heap->free);
+		HEAPfree(c->heap);
+		GDKfree(c->heap);
+		c->heap = NULL;
+		c->blocks = 0;
+		b->T->compressed = c;
+		MT_lock_unset(&GDKcompressLock(ABS(b->batCacheid)), "BATcompress");
+		return NULL;
+	}
+	CMPheader(c)->magic = CMP_MAGIC;
+	CMPheader(c)->first = BUNfirst(b);
+	CMPheader(c)->last = BUNlast(b);
+	CMPheader(c)->blocks = c->blocks;
+	CMPheader(c)->width = (BUN) b->T->width;
+	ALGODEBUG fprintf(stderr, "#BATcompress(%s#" BUNFMT "): " SZFMT
+			  " bytes, was " SZFMT "\n", BATgetId(b), cnt,
+			  c->heap->free, rawsize);
+	b->T->compressed = c;
+	/* a clean bat on disk can have its image saved now */
+	if (!BATdirty(b))
+		(void) CMPsave(b);
+	MT_lock_unset(&GDKcompressLock(ABS(b->batCacheid)), "BATcompress");
+	return b;
+}
+
+/* the image to use for b, which may be a view on a compressed
+ * parent; *off is set to the position of b in the parent */
+static Compressed *
+cmp_image(BAT *b, BAT **pp, BUN *off)
+{
+	BAT *p = b;
+
+	*off = 0;
+	if (VIEWtparent(b)) {
+		p = BBP_cache(VIEWtparent(b));
+		/* the view must be on the tail of the parent */
+		if (p == NULL || p->ttype != b->ttype ||
+		    p->T->width != b->T->width ||
+		    Tloc(b, BUNfirst(b)) < Tloc(p, BUNfirst(p)) ||
+		    Tloc(b, BUNlast(b)) > Tloc(p, BUNlast(p)))
+			return NULL;
+		*off = (BUN) ((Tloc(b, BUNfirst(b)) - Tloc(p, BUNfirst(p))) >> b->T->shift);
+	}
+	*pp = p;
+	return cmp_get(p);
+}
+
+/* append the n oids at o to bn */
+static int
+cmp_append(BAT *bn, const oid *o, BUN n)
+{
+	BUN cnt = BATcount(bn);
+
+	if (cnt + n > BATcapacity(bn) &&
+	    BATextend(bn, MAX(cnt + n, BATgrows(bn))) == NULL)
+		return -1;
+	memcpy((oid *) Tloc(bn, BUNfirst(bn)) + cnt, o, n * sizeof(oid));
+	BATsetcount(bn, cnt + n);
+	return 0;
+}
+
+/*
+ * Can a range select on b be answered from its compressed image?  If
+ * so, the bounds are translated to inclusive bounds on the stored
+ * values in *lo and *hi.  Nils are never selected: they are the
+ * smallest value of their type, and the low bound is above them.
+ * Strings are only selected on equality, and only if the heap
+ * eliminates doubles, so that the string has a single offset.
+ */
+int
+CMPselectable(BAT *b, const void *tl, const void *th, int li, int hi,
+	      int equi, int lval, int hval, lng *clo, lng *chi)
+{
+	if (!cmp_type(b) || BATcount(b) == 0)
+		return 0;
+	if (b->ttype == TYPE_str) {
+		var_t off;
+
+		if (!equi || !lval || !GDK_ELIMDOUBLES(b->T->vheap) ||
+		    strcmp((const char *) tl, str_nil) == 0)
+			return 0;
+		/* a string that is not there selects nothing, which
+		 * the image answers as well as any offset */
+		off = strLocate(b->T->vheap, (const char *) tl);
+		if (off != 0 && b->T->width <= 2)
+			off -= GDK_VAROFFSET;
+		*clo = *chi = off ? (lng) off : -1;
+		return 1;
+	}
+	switch (ATOMstorage(b->ttype)) {
+#define CMP_BOUNDS(TYPE)						\
+	do {								\
+		*clo = lval ? (lng) *(const TYPE *) tl : (lng) TYPE##_nil; \
+		*chi = hval ? (lng) *(const TYPE *) th : (lng) GDK_##TYPE##_max; \
+		if (lval && *clo == (lng) TYPE##_nil)			\
+			return 0;					\
+		if (!lval || !li) {					\
+			if (*clo == (lng) GDK_##TYPE##_max)		\
+				return 0;				\
+			(*clo)++;					\
+		}							\
+		if (hval && !hi) {					\
+			if (*chi == (lng) TYPE##_nil)			\
+				return 0;				\
+			(*chi)--;					\
+		}							\
+	} while (0)
+	case TYPE_bte:
+		CMP_BOUNDS(bte);
+		break;
+	case TYPE_sht:
+		CMP_BOUNDS(sht);
+		break;
+	case TYPE_int:
+		CMP_BOUNDS(int);
+		break;
+	case TYPE_lng:
+		CMP_BOUNDS(lng);
+		break;
+	}
+	return 1;
+}
+
+/*
+ * Select the positions [start, end) of b whose stored value lies in
+ * [lo, hi], appending their oids to bn.  Returns 1 if done, 0 if
+ * there is no usable image, in which case bn is left untouched, and
+ * -1 on error, in which case bn is reclaimed.
+ */
+int
+CMPselect(BAT *b, BAT *bn, BUN start, BUN end, lng lo, lng hi)
+{
+	Compressed *c;
+	BAT *p = NULL;
+	BUN off, k, i, n, pos, first, last;
+	uint64_t *vals, *lens;
+	oid *buf, seq = b->hseqbase;
+	BUN nbuf;
+
+	if ((c = cmp_image(b, &p, &off)) == NULL)
+		return 0;
+	vals = GDKmalloc(2 * CMP_BLOCK * sizeof(uint64_t));
+	buf = GDKmalloc(CMP_BLOCK * sizeof(oid));
+	if (vals == NULL || buf == NULL) {
+		GDKfree(vals);
+		GDKfree(buf);
+		return 0;
+	}
+	lens = vals + CMP_BLOCK;
+	ALGODEBUG fprintf(stderr, "#CMPselect(b=%s#" BUNFMT "): "
+			  "compressed select\n", BATgetId(b), BATcount(b));
+
+	/* positions in the parent */
+	start += off;
+	end += off;
+	seq -= off;
+	for (k = start / CMP_BLOCK; lo <= hi && k * CMP_BLOCK < end; k++) {
+		const CmpBlock *blk = CMPblock(c, k);
+		uint64_t plo, phi;
+
+		first = MAX(k * CMP_BLOCK, start);
+		last = MIN((k + 1) * CMP_BLOCK, end);
+		n = MIN(CMP_BLOCK, BATcount(p) - k * CMP_BLOCK);
+		nbuf = 0;
+		if (blk->max < lo || blk->min > hi)
+			continue;
+		if (blk->min >= lo && blk->max <= hi) {
+			/* the whole block qualifies */
+			for (i = first; i < last; i++)
+				buf[nbuf++] = seq + i;
+		} else {
+			plo = lo <= blk->min ? 0 : (uint64_t) lo - (uint64_t) blk->min;
+			phi = (uint64_t) hi - (uint64_t) blk->min;
+			cmp_decode(c, blk, n, vals, lens);
+			if (blk->method == CMP_RLE) {
+				for (i = 0, pos = k * CMP_BLOCK; i < blk->runs && pos < last; i++) {
+					BUN e = pos + (BUN) lens[i] + 1;
+
+					if (vals[i] >= plo && vals[i] <= phi)
+						for (; pos < e; pos++)
+							if (pos >= first && pos < last)
+								buf[nbuf++] = seq + pos;
+					pos = e;
+				}
+			} else {
+				for (i = first; i < last; i++) {
+					uint64_t v = vals[i - k * CMP_BLOCK];
+
+					if (v >= plo && v <= phi)
+						buf[nbuf++] = seq + i;
+				}
+			}
+		}
+		if (nbuf > 0 && cmp_append(bn, buf, nbuf) < 0) {
+			GDKfree(vals);
+			GDKfree(buf);
+			BBPreclaim(bn);
+			return -1;
+		}
+	}
+	GDKfree(vals);
+	GDKfree(buf);
+	bn->tsorted = 1;
+	bn->trevsorted = bn->U->count <= 1;
+	bn->tkey = 1;
+	bn->tdense = bn->U->count <= 1;
+	if (bn->U->count == 1)
+		bn->tseqbase =  * (oid *) Tloc(bn, BUNfirst(bn));
+	bn->hsorted = 1;
+	bn->hdense = 1;
+	bn->hseqbase = 0;
+	bn->hkey = 1;
+	bn->hrevsorted = bn->U->count <= 1;
+	return 1;
+}
+
+/*
+ * Sum the non-nil values of b at positions [start, end) into *sum and
+ * count the nils among them into *nils.  Whole blocks are summed from
+ * their headers.  Only for types narrower than lng, where the sum
+ * cannot overflow; returns -1 if the image cannot be used.
+ */
+int
+CMPsum(BAT *b, BUN start, BUN end, lng *sum, BUN *nils)
+{
+	Compressed *c;
+	BAT *p = NULL;
+	BUN off, k, i, n, pos, first, last;
+	uint64_t *vals, *lens;
+	lng nil;
+
+	switch (ATOMstorage(b->ttype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+		break;
+	default:
+		return -1;
+	}
+	if (end - start > ((BUN) 1 << 31) ||
+	    (c = cmp_image(b, &p, &off)) == NULL)
+		return -1;
+	if ((vals = GDKmalloc(2 * CMP_BLOCK * sizeof(uint64_t))) == NULL)
+		return -1;
+	lens = vals + CMP_BLOCK;
+	nil = cmp_nil(b);
+	*sum = 0;
+	*nils = 0;
+	start += off;
+	end += off;
+	for (k = start / CMP_BLOCK; k * CMP_BLOCK < end; k++) {
+		const CmpBlock *blk = CMPblock(c, k);
+
+		first = MAX(k * CMP_BLOCK, start);
+		last = MIN((k + 1) * CMP_BLOCK, end);
+		n = MIN(CMP_BLOCK, BATcount(p) - k * CMP_BLOCK);
+		if (first == k * CMP_BLOCK && last - first == n) {
+			*sum += blk->sum;
+			*nils += blk->nils;
+			continue;
+		}
+		cmp_decode(c, blk, n, vals, lens);
+		if (blk->method == CMP_RLE) {
+			for (i = 0, pos = k * CMP_BLOCK; i < blk->runs && pos < last; i++) {
+				BUN e = pos + (BUN) lens[i] + 1;
+				BUN f = MAX(pos, first), l = MIN(e, last);
+				lng v = (lng) (vals[i] + (uint64_t) blk->min);
+
+				if (f < l) {
+					if (v == nil)
+						*nils += l - f;
+					else
+						*sum += v * (lng) (l - f);
+				}
+				pos = e;
+			}
+		} else {
+			for (i = first; i < last; i++) {
+				lng v = (lng) (vals[i - k * CMP_BLOCK] + (uint64_t) blk->min);
+
+				if (v == nil)
+					(*nils)++;
+				else
+					*sum += v;
+			}
+		}
+	}
+	GDKfree(vals);
+	return 0;
+}
+
+static void
+CMPdrop(BAT *b, int keepfile)
+{
+	Compressed *c;
+
+	MT_lock_set(&GDKcompressLock(ABS(b->batCacheid)), "CMPdrop");
+	c = b->T->compressed;
+	b->T->compressed = NULL;
+	if (c != NULL) {
+		if (c->heap) {
+			if (c->heap->storage == STORE_MMAP ||
+			    (!keepfile && (c->heap->storage != STORE_MEM ||
+					   b->batPersistence == PERSISTENT)))
+				HEAPdelete(c->heap, cmp_filename(b), "cmp");
+			else
+				HEAPfree(c->heap);
+			GDKfree(c->heap);
+		} else if (!keepfile) {
+			GDKunlink(BATDIR, cmp_filename(b), "cmp");
+		}
+		GDKfree(c);
+	}
+	MT_lock_unset(&GDKcompressLock(ABS(b->batCacheid)), "CMPdrop");
+}
+
+/* release the compressed image of b, but keep a saved image */
+void
+CMPfree(BAT *b)
+{
+	if (b) {
+		if (b->T->compressed != NULL && !VIEWtparent(b))
+			CMPdrop(b, 1);
+		if (b->H->compressed != NULL && !VIEWhparent(b))
+			CMPdrop(BATmirror(b), 1);
+	}
+}
+
+/* throw away the compressed image of b, including a saved image */
+void
+CMPdestroy(BAT *b)
+{
+	if (b) {
+		if (b->T->compressed != NULL && !VIEWtparent(b))
+			CMPdrop(b, 0);
+		if (b->H->compressed != NULL && !VIEWhparent(b))
+			CMPdrop(BATmirror(b), 0);
+	}
+}
@@ -20,6 +20,7 @@
 #include "monetdb_config.h"
 #include "gdk.h"
 #include "gdk_private.h"
+#include "gdk_mapreduce.h"
 
 /* how much to extend the extent and histo bats when we run out of space */
 #define GROUPBATINCR	8192
@@ -96,11 +97,22 @@
 		ngrp++;							\
 	} while (0)
 
+/* hash_flt and hash_dbl hash the bit pattern, but -0.0 == 0.0, so
+ * zero is hashed as 0.0 to get both into the same group */
+static const flt grp_zero_flt = 0;
+static const dbl grp_zero_dbl = 0;
+#define GRPhash_bte(H,V)	hash_bte(H,V)
+#define GRPhash_sht(H,V)	hash_sht(H,V)
+#define GRPhash_int(H,V)	hash_int(H,V)
+#define GRPhash_lng(H,V)	hash_lng(H,V)
+#define GRPhash_flt(H,V)	(*(V) == 0 ? hash_flt(H,&grp_zero_flt) : hash_flt(H,V))
+#define GRPhash_dbl(H,V)	(*(V) == 0 ? hash_dbl(H,&grp_zero_dbl) : hash_dbl(H,V))
+
 #define GRPhashloop(TYPE)						\
 	do {								\
 		TYPE *w = (TYPE *) Tloc(b, 0);				\
 		for (r = BUNfirst(b), p = r, q = r + BATcount(b); p < q; p++) { \
-			prb = hash_##TYPE(hs, &w[p]);			\
+			prb = GRPhash_##TYPE(hs, &w[p]);		\
 			if (gc) {					\
 				for (hb = HASHget(hs,prb);		\
 				     hb != HASHnil(hs) &&		\
@@ -167,6 +179,343 @@
 		}							\
 	} while (0)
 
+/* Parallel grouping.
+ *
+ * For large inputs without pre-existing grouping or hash table, b is
+ * cut into one chunk per thread.  Each thread groups its chunk with a
+ * private hash table, numbering the groups in order of first
+ * appearance within the chunk.  The chunks are then merged in order:
+ * a local group that was not seen in an earlier chunk becomes the
+ * next global group.  Since local groups are merged in order of
+ * their first appearance, the global numbering, the extents, and the
+ * histogram are exactly those of the sequential algorithm.  Finally
+ * the threads translate their local group ids into global ones. */
+
+#define GRP_PARALLEL_MIN	((BUN) 1 << 20)	/* minimum size of b */
+
+typedef struct {
+	MRtask task;		/* scheduler header, must be first */
+	BAT *b;
+	BUN start, end;		/* chunk of b, relative to BUNfirst */
+	oid *ngrps;		/* group ids, local ones after first phase */
+	BUN ngrp, maxgrp;	/* local groups */
+	BUN *first;		/* per local group: first occurrence */
+	wrd *cnts;		/* per local group: its size */
+	BUN *lnk;		/* per local group: hash chain */
+	BUN *bkt, mask;		/* hash buckets */
+	oid *map;		/* local to global group id */
+	int sorted;		/* group ids are nondecreasing */
+	int error;
+} grptask;
+
+static inline BUN
+grp_hash_lng(unsigned long long h)
+{
+	h ^= h >> 33;
+	h *= LL_CONSTANT(0xff51afd7ed558ccd);
+	h ^= h >> 33;
+	return (BUN) h;
+}
+
+/* equal values must hash equal, so -0.0 and 0.0 are folded */
+static inline unsigned long long
+grp_bits_flt(flt v)
+{
+	union { flt f; unsigned int i; } u;
+
+	u.f = v == 0 ? 0 : v;
+	return (unsigned long long) u.i;
+}
+
+static inline unsigned long long
+grp_bits_dbl(dbl v)
+{
+	union { dbl f; unsigned long long i; } u;
+
+	u.f = v == 0 ? 0 : v;
+	return u.i;
+}
+
+#define grp_bits_int(v)	((unsigned long long) (unsigned int) (v))
+#define grp_bits_lng(v)	((unsigned long long) (v))
+#define GRPhashval(TYPE, v)	grp_hash_lng(grp_bits_##TYPE(v))
+
+/* make room for one more group in t, rehashing when the hash table
+ * gets too full; the hash chains are kept on the values at first */
+#define GRPlocalgrow(TYPE)						\
+static int								\
+grp_grow_##TYPE(grptask *t, const TYPE *w)				\
+{									\
+	BUN i, h;							\
+									\
+	if (t->ngrp == t->maxgrp) {					\
+		BUN n = t->maxgrp ? 2 * t->maxgrp : GROUPBATINCR;	\
+		BUN *first = GDKrealloc(t->first, n * sizeof(BUN));	\
+		wrd *cnts;						\
+		BUN *lnk;						\
+									\
+		if (first == NULL)					\
+			return -1;					\
+		t->first = first;					\
+		if ((cnts = GDKrealloc(t->cnts, n * sizeof(wrd))) == NULL) \
+			return -1;					\
+		t->cnts = cnts;						\
+		if ((lnk = GDKrealloc(t->lnk, n * sizeof(BUN))) == NULL) \
+			return -1;					\
+		t->lnk = lnk;						\
+		t->maxgrp = n;						\
+	}								\
+	if (t->bkt == NULL || t->ngrp > t->mask) {			\
+		BUN mask = t->bkt ? 2 * t->mask + 1 : GROUPBATINCR - 1; \
+		BUN *bkt = GDKrealloc(t->bkt, (mask + 1) * sizeof(BUN)); \
+									\
+		if (bkt == NULL)					\
+			return -1;					\
+		t->bkt = bkt;						\
+		t->mask = mask;						\
+		for (i = 0; i <= mask; i++)				\
+			bkt[i] = BUN_NONE;				\
+		for (i = 0; i < t->ngrp; i++) {				\
+			h = GRPhashval(TYPE, w[t->first[i]]) & mask;	\
+			t->lnk[i] = bkt[h];				\
+			bkt[h] = i;					\
+		}							\
+	}								\
+	return 0;							\
+}
+
+/* first phase: group a chunk */
+#define GRPlocal(TYPE)							\
+static void								\
+grp_local_##TYPE(void *arg)						\
+{									\
+	grptask *t = arg;						\
+	const TYPE *w = (const TYPE *) Tloc(t->b, BUNfirst(t->b));	\
+	BUN p, hb, h;							\
+									\
+	for (p = t->start; p < t->end; p++) {				\
+		h = GRPhashval(TYPE, w[p]) & t->mask;			\
+		for (hb = t->bkt ? t->bkt[h] : BUN_NONE;		\
+		     hb != BUN_NONE;					\
+		     hb = t->lnk[hb]) {					\
+			if (w[t->first[hb]] == w[p])			\
+				break;					\
+		}							\
+		if (hb == BUN_NONE) {					\
+			if (grp_grow_##TYPE(t, w) < 0) {		\
+				t->error = 1;				\
+				return;					\
+			}						\
+			hb = t->ngrp++;					\
+			t->first[hb] = p;				\
+			t->cnts[hb] = 0;				\
+			h = GRPhashval(TYPE, w[p]) & t->mask;		\
+			t->lnk[hb] = t->bkt[h];				\
+			t->bkt[h] = hb;					\
+		}							\
+		t->cnts[hb]++;						\
+		t->ngrps[p] = hb;					\
+	}								\
+}
+
+/* second phase: merge the local groups of all chunks, in order, into
+ * the global numbering; the global task has its first/cnts indexed by
+ * global group id */
+#define GRPmerge(TYPE)							\
+static int								\
+grp_merge_##TYPE(grptask *glob, grptask *tasks, int nthreads)		\
+{									\
+	const TYPE *w = (const TYPE *) Tloc(glob->b, BUNfirst(glob->b)); \
+	BUN i, hb, h;							\
+	int j;								\
+									\
+	for (j = 0; j < nthreads; j++) {				\
+		grptask *t = &tasks[j];					\
+									\
+		if ((t->map = GDKmalloc((t->ngrp + 1) * sizeof(oid))) == NULL) \
+			return -1;					\
+		for (i = 0; i < t->ngrp; i++) {				\
+			const TYPE v = w[t->first[i]];			\
+									\
+			h = GRPhashval(TYPE, v) & glob->mask;		\
+			for (hb = glob->bkt ? glob->bkt[h] : BUN_NONE; \
+			     hb != BUN_NONE;				\
+			     hb = glob->lnk[hb]) {			\
+				if (w[glob->first[hb]] == v)		\
+					break;				\
+			}						\
+			if (hb == BUN_NONE) {				\
+				if (grp_grow_##TYPE(glob, w) < 0)	\
+					return -1;			\
+				hb = glob->ngrp++;			\
+				glob->first[hb] = t->first[i];		\
+				glob->cnts[hb] = 0;			\
+				h = GRPhashval(TYPE, v) & glob->mask;	\
+				glob->lnk[hb] = glob->bkt[h];		\
+				glob->bkt[h] = hb;			\
+			}						\
+			glob->cnts[hb] += t->cnts[i];			\
+			t->map[i] = (oid) hb;				\
+		}							\
+	}								\
+	return 0;							\
+}
+
+#define GRPparallel(TYPE)						\
+	GRPlocalgrow(TYPE)						\
+	GRPlocal(TYPE)							\
+	GRPmerge(TYPE)
+
+GRPparallel(int)
+GRPparallel(lng)
+GRPparallel(flt)
+GRPparallel(dbl)
+
+/* third phase: translate local group ids into global ones */
+static void
+grp_remap(void *arg)
+{
+	grptask *t = arg;
+	BUN p;
+
+	t->sorted = 1;
+	for (p = t->start; p < t->end; p++) {
+		t->ngrps[p] = t->map[t->ngrps[p]];
+		if (p > t->start && t->ngrps[p] < t->ngrps[p - 1])
+			t->sorted = 0;
+	}
+}
+
+static int
+grp_parallel_type(BAT *b)
+{
+	switch (ATOMstorage(b->ttype)) {
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_flt:
+	case TYPE_dbl:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* run fcn on all chunks on the shared workers */
+static void
+grp_run(void (*fcn)(void *), grptask *tasks, int nthreads)
+{
+	void **args = GDKmalloc(nthreads * sizeof(void *));
+	int i;
+
+	if (args == NULL) {
+		/* just do it ourselves */
+		for (i = 0; i < nthreads; i++)
+			(*fcn)(&tasks[i]);
+		return;
+	}
+	for (i = 0; i < nthreads; i++)
+		args[i] = &tasks[i];
+	MRschedule(nthreads, args, fcn);
+	GDKfree(args);
+}
+
+static void
+grp_free(grptask *t)
+{
+	GDKfree(t->first);
+	GDKfree(t->cnts);
+	GDKfree(t->lnk);
+	GDKfree(t->bkt);
+	GDKfree(t->map);
+}
+
+/* Group b (g == NULL) into gn in parallel, and produce the extents
+ * and histogram in *enp and *hnp if not NULL; returns the number of
+ * groups, or BUN_NONE on failure. */
+static BUN
+BATgroup_parallel(BAT *gn, BAT **enp, BAT **hnp, BAT *b)
+{
+	int nthreads = GDKnr_threads, i;
+	BUN cnt = BATcount(b), chunk, ngrp = BUN_NONE, p;
+	grptask *tasks, glob;
+	void (*local)(void *);
+	int (*merge)(grptask *, grptask *, int);
+
+	switch (ATOMstorage(b->ttype)) {
+	case TYPE_int:
+		local = grp_local_int;
+		merge = grp_merge_int;
+		break;
+	case TYPE_lng:
+		local = grp_local_lng;
+		merge = grp_merge_lng;
+		break;
+	case TYPE_flt:
+		local = grp_local_flt;
+		merge = grp_merge_flt;
+		break;
+	case TYPE_dbl:
+		local = grp_local_dbl;
+		merge = grp_merge_dbl;
+		break;
+	default:
+		return BUN_NONE;
+	}
+	if ((tasks = GDKzalloc(nthreads * sizeof(grptask))) == NULL)
+		return BUN_NONE;
+	memset(&glob, 0, sizeof(glob));
+	glob.b = b;
+	chunk = (cnt + nthreads - 1) / nthreads;
+	for (i = 0; i < nthreads; i++) {
+		tasks[i].b = b;
+		tasks[i].ngrps = (oid *) Tloc(gn, BUNfirst(gn));
+		tasks[i].start = MIN(cnt, i * chunk);
+		tasks[i].end = MIN(cnt, (i + 1) * chunk);
+	}
+	grp_run(local, tasks, nthreads);
+	for (i = 0; i < nthreads; i++)
+		if (tasks[i].error)
+			goto bailout;
+	if ((*merge)(&glob, tasks, nthreads) < 0)
+		goto bailout;
+	grp_run(grp_remap, tasks, nthreads);
+
+	gn->tsorted = 1;
+	for (i = 0; i < nthreads; i++) {
+		if (!tasks[i].sorted ||
+		    (i > 0 && tasks[i].start < tasks[i].end &&
+		     tasks[i].ngrps[tasks[i].start] < tasks[i].ngrps[tasks[i].start - 1]))
+			gn->tsorted = 0;
+	}
+	if (enp) {
+		BAT *en = *enp;
+		oid *exts;
+
+		if (BATcapacity(en) < glob.ngrp &&
+		    (*enp = en = BATextend(en, glob.ngrp)) == NULL)
+			goto bailout;
+		exts = (oid *) Tloc(en, BUNfirst(en));
+		for (p = 0; p < glob.ngrp; p++)
+			exts[p] = b->hseqbase + (oid) glob.first[p];
+	}
+	if (hnp) {
+		BAT *hn = *hnp;
+
+		if (BATcapacity(hn) < glob.ngrp &&
+		    (*hnp = hn = BATextend(hn, glob.ngrp)) == NULL)
+			goto bailout;
+		memcpy(Tloc(hn, BUNfirst(hn)), glob.cnts, glob.ngrp * sizeof(wrd));
+	}
+	ngrp = glob.ngrp;
+
+  bailout:
+	for (i = 0; i < nthreads; i++)
+		grp_free(&tasks[i]);
+	grp_free(&glob);
+	GDKfree(tasks);
+	return ngrp;
+}
+
 gdk_return
 BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 		  BAT *b, BAT *g, BAT *e, BAT *h, int subsorted)
@@ -450,8 +799,11 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 			/* start a new group */
 			GRPnotfound();
 		}
-	} else if (b->T->hash) {
-		/* we already have a hash table on b */
+	} else if (b->T->hash &&
+		   ATOMstorage(b->ttype) != TYPE_flt &&
+		   ATOMstorage(b->ttype) != TYPE_dbl) {
+		/* we already have a hash table on b; not for flt/dbl,
+		 * since it keeps -0.0 and 0.0 apart */
 		ALGODEBUG fprintf(stderr, "#BATgroup(b=%s#" BUNFMT ","
 				  "g=%s#" BUNFMT ","
 				  "e=%s#" BUNFMT ","
@@ -509,6 +861,21 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 				GRPnotfound();
 			}
 		}
+	} else if (g == NULL && e == NULL && h == NULL &&
+		   GDKnr_threads > 1 &&
+		   BATcount(b) >= GRP_PARALLEL_MIN &&
+		   grp_parallel_type(b)) {
+		/* not sorted, no pre-existing hash table, and big
+		 * enough to spread over the threads */
+		ALGODEBUG fprintf(stderr, "#BATgroup(b=%s#" BUNFMT ","
+				  "g=NULL,e=NULL,h=NULL,subsorted=%d): "
+				  "parallel hash tables (%d threads)\n",
+				  BATgetId(b), BATcount(b),
+				  subsorted, GDKnr_threads);
+		ngrp = BATgroup_parallel(gn, extents ? &en : NULL,
+					 histo ? &hn : NULL, b);
+		if (ngrp == BUN_NONE)
+			goto error;
 	} else {
 		bit gc = g && (g->tsorted || g->trevsorted);
 		const char *nme;
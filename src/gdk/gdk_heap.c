@@ -59,10 +59,8 @@
 #include "gdk.h"
 #include "gdk_private.h"
 
-#include <Rinternals.h>
-#ifndef RHS
-#define RHS Rf_sizeofHeader()
-#endif
+/* headroom in front of malloced heaps, see GDK_heap_headroom */
+#define RHS GDK_heap_headroom
 
 /* The heap cache should reduce mmap/munmap calls which are very
  * expensive.  Instead we try to reuse mmap's. This however requires
@@ -305,7 +303,6 @@ HEAPalloc(Heap *h, size_t nitems, size_t itemsize)
 
 	if (h->filename == NULL || (h->size < minsize)) {
 		h->storage = STORE_MEM;
-// R fix
 		h->size += RHS; h->maxsize += RHS;
 		h->base = (char *) GDKmallocmax(h->size, &h->maxsize, 0);
 		h->size -= RHS; h->maxsize -= RHS;
@@ -341,6 +338,10 @@ HEAPalloc(Heap *h, size_t nitems, size_t itemsize)
 		GDKerror("HEAPalloc: Insufficient space for HEAP of " SZFMT " bytes.", h->size);
 		return -1;
 	}
+	/* large heaps are scanned by all workers: spread them over
+	 * the NUMA nodes before anyone touches them */
+	if (GDK_numa == GDK_NUMA_INTERLEAVE && h->size >= GDK_mem_bigsize)
+		MT_numa_interleave(h->base, h->size);
 	h->newstorage = h->storage;
 	return 0;
 }
@@ -374,6 +375,20 @@ HEAPextend(Heap *h, size_t size)
 		nme[sizeof(nme) - 1] = 0;
 		ext = decompose_filename(nme);
 	}
+	if (h->external) {
+		/* the memory isn't ours (BATwrap): first write, so
+		 * move the data to a heap of our own */
+		Heap bak = *h;
+
+		h->external = 0;
+		if (HEAPalloc(h, MAX(size, bak.size), 1) < 0) {
+			*h = bak;
+			return -1;
+		}
+		memcpy(h->base, bak.base, bak.free);
+		h->free = bak.free;
+		return 0;
+	}
 	if (size <= h->size)
 		return 0;
 
@@ -412,7 +427,6 @@ HEAPextend(Heap *h, size_t size)
 		/* try GDKrealloc if the heap size stays within
 		 * reasonable limits */
 		if (!must_mmap) {
-			// R fix
 			void *p = h->base;
 			HEAPDEBUG fprintf(stderr, "#HEAPextend: try extending malloced heap " SZFMT " " SZFMT " " PTRFMT "\n", size, h->maxsize, PTRFMTCAST p);
 			h->newstorage = h->storage = STORE_MEM;
@@ -607,7 +621,10 @@ HEAPcopy(Heap *dst, Heap *src)
 static int
 HEAPfree_(Heap *h, int free_file)
 {
-	if (h->base) {
+	if (h->base && h->external) {
+		/* not ours to free */
+		h->external = 0;
+	} else if (h->base) {
 		if (h->storage == STORE_MEM) {	/* plain memory */
 			HEAPDEBUG fprintf(stderr, "#HEAPfree " SZFMT " " SZFMT " " PTRFMT "\n", h->size, h->maxsize, PTRFMTCAST h->base);
 			GDKfree(h->base - RHS);
@@ -727,6 +744,36 @@ HEAPload(Heap *h, const char *nme, const char *ext, int trunc)
 	return HEAPload_intern(h, nme, ext, ".new", trunc);
 }
 
+/*
+ * @- HEAPloadindex
+ *
+ * Load the saved image of a search accelerator (hash table,
+ * imprints).  Unlike the bat heaps, its size is not recorded in the
+ * BBP, so it is taken from the file.  Small images are read into
+ * memory, larger ones are mapped privately, so that updates made in
+ * memory never reach the saved image.
+ */
+int
+HEAPloadindex(Heap *h, const char *nme, const char *ext)
+{
+	long_str path;
+	struct stat st;
+
+	GDKfilepath(path, BATDIR, nme, ext);
+	assert(strlen(path) + 4 < sizeof(path));
+	strcat(path, ".new");
+	if (stat(path, &st) < 0) {
+		path[strlen(path) - 4] = 0;
+		if (stat(path, &st) < 0)
+			return -1;
+	}
+	if (st.st_size == 0)
+		return -1;
+	h->size = h->free = (size_t) st.st_size;
+	h->newstorage = h->size < GDK_mmap_minsize ? STORE_MEM : STORE_PRIV;
+	return HEAPload(h, nme, ext, 0) < 0 ? -1 : 0;
+}
+
 /*
  * @- HEAPsave
  *
@@ -406,8 +406,33 @@
 
 /* end of binary search */
 
+/*
+ * Strings are imprinted on a prefix key: the first IMPS_PREFIX bytes
+ * of the string read as a big-endian number.  The key is monotone in
+ * the string order (nil, the smallest string, maps to -1), so a range
+ * of strings maps onto a range of keys and hence onto a range of bins.
+ */
+#define IMPS_PREFIX 4
+
+lng
+IMPSstrkey(const char *v)
+{
+	const unsigned char *s = (const unsigned char *) v;
+	lng k = 0;
+	int i;
+
+	if (GDK_STRNIL(v))
+		return -1;
+	for (i = 0; i < IMPS_PREFIX; i++) {
+		k <<= 8;
+		if (*s)
+			k |= *s++;
+	}
+	return k;
+}
+
 static int
-imprints_create(BAT *b, char *inbins, bte bits,
+imprints_create(BAT *b, const void *incol, int tpe, char *inbins, bte bits,
 		char *imps, BUN *impcnt, char *dict, BUN *dictcnt)
 {
 	BUN i;
@@ -420,10 +445,10 @@ imprints_create(BAT *b, char *inbins, bte bits,
 do {                                                                          \
 	uint##B##_t mask, prvmask;                                            \
 	uint##B##_t *im = (uint##B##_t *) imps;                               \
-	TYPE *col = (TYPE *) Tloc(b, 0);                                      \
+	const TYPE *col = (const TYPE *) incol;                               \
 	TYPE *bins = (TYPE *) inbins;                                         \
 	prvmask = mask = 0;                                                   \
-	new = (IMPS_PAGE/sizeof(TYPE))-1;                                     \
+	new = (IMPS_PAGE >> b->T->shift)-1;                                   \
 	for (i = 0; i < b->batFirst+b->batCount; i++) {                       \
 		if (!(i&new) && i>0) {                                        \
 			/* same mask as previous and enough count to add */   \
@@ -488,7 +513,7 @@ do {                                                                          \
 	}                                                                     \
 } while (0)
 
-	switch (ATOMstorage(b->T->type)) {
+	switch (tpe) {
 	case TYPE_bte:
 		BINSIZE(bits, IMPS_CREATE, bte);
 		break;
@@ -518,6 +543,145 @@ do {                                                                          \
 	return 1;
 }
 
+/*
+ * The imprints of a persistent bat are saved next to the bat (files
+ * imps, dict and bins) when the bat is saved, or as soon as they are
+ * built on a bat that is clean on disk.  A footer behind the bins
+ * records the extent of the bat they cover; saved imprints are only
+ * used if they match the bat as loaded.  As that extent does not
+ * change with in-place updates, saving a bat without its imprints in
+ * memory removes the saved image.
+ */
+#define IMPS_MAGIC	((BUN) 0x494d5053)	/* "IMPS" */
+#define IMPSbinsize(b)	(ATOMstorage((b)->ttype) == TYPE_str ?		\
+			 sizeof(lng) : (size_t) ATOMsize(ATOMstorage((b)->ttype)))
+
+typedef struct {
+	BUN magic;
+	BUN first;		/* BUNfirst of the bat */
+	BUN last;		/* BUNlast of the bat */
+	BUN impcnt;
+	BUN dictcnt;
+	BUN bits;
+} ImpsFooter;
+
+static const char *imps_ext[] = {
+	"imps", "imps.new", "dict", "dict.new", "bins", "bins.new"
+};
+
+static void
+IMPSunlink(const char *nme)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(imps_ext) / sizeof(imps_ext[0]); i++)
+		GDKunlink(BATDIR, nme, imps_ext[i]);
+}
+
+int
+IMPSsave(BAT *b)
+{
+	Imprints *imprints = b->T->imprints;
+	str nme = BBP_physical(b->batCacheid);
+	ImpsFooter f;
+	size_t free;
+	int ret;
+
+	if (b->batCacheid < 0 || VIEWtparent(b) ||
+	    b->batPersistence != PERSISTENT)
+		return 0;
+	if (imprints == NULL ||
+	    imprints->imps->storage == STORE_MMAP ||
+	    imprints->dict->storage == STORE_MMAP) {
+		/* saved without (savable) imprints: an image of an
+		 * earlier version of the bat is stale now */
+		IMPSunlink(nme);
+		return 0;
+	}
+	free = 64 * IMPSbinsize(b);
+	if (HEAPextend(imprints->bins, free + sizeof(f)) < 0)
+		return -1;
+	f.magic = IMPS_MAGIC;
+	f.first = BUNfirst(b);
+	f.last = BUNlast(b);
+	f.impcnt = imprints->impcnt;
+	f.dictcnt = imprints->dictcnt;
+	f.bits = (BUN) imprints->bits;
+	memcpy(imprints->bins->base + free, &f, sizeof(f));
+	imprints->imps->free = (size_t) imprints->impcnt * (imprints->bits / 8);
+	imprints->dict->free = (size_t) imprints->dictcnt * sizeof(cchdc_t);
+	imprints->bins->free = free + sizeof(f);
+	/* the bins go last, their footer validates the others */
+	ret = (HEAPsave(imprints->imps, nme, "imps") < 0 ||
+	       HEAPsave(imprints->dict, nme, "dict") < 0 ||
+	       HEAPsave(imprints->bins, nme, "bins") < 0) ? -1 : 0;
+	imprints->bins->free = free;
+	ALGODEBUG fprintf(stderr, "#IMPSsave(%s): saved " BUNFMT " imprints = %d\n", BATgetId(b), imprints->impcnt, ret);
+	if (ret < 0)
+		IMPSunlink(nme);
+	return ret;
+}
+
+/* load the saved imprints of b, if they are still valid */
+static Imprints *
+IMPSload(BAT *b)
+{
+	str nme = BBP_physical(b->batCacheid);
+	Imprints *imprints;
+	ImpsFooter f;
+	size_t free = 64 * IMPSbinsize(b);
+
+	if (b->batPersistence != PERSISTENT || BATdirty(b) ||
+	    b->batCacheid < 0)
+		return NULL;
+	if ((imprints = (Imprints *) GDKzalloc(sizeof(Imprints))) == NULL ||
+	    (imprints->bins = (Heap *) GDKzalloc(sizeof(Heap))) == NULL ||
+	    (imprints->imps = (Heap *) GDKzalloc(sizeof(Heap))) == NULL ||
+	    (imprints->dict = (Heap *) GDKzalloc(sizeof(Heap))) == NULL ||
+	    HEAPloadindex(imprints->bins, nme, "bins") < 0) {
+		/* nothing (usable) saved */
+		if (imprints) {
+			if (imprints->bins)
+				GDKfree(imprints->bins->filename);
+			GDKfree(imprints->bins);
+			GDKfree(imprints->imps);
+			GDKfree(imprints->dict);
+			GDKfree(imprints);
+		}
+		return NULL;
+	}
+	if (imprints->bins->free != free + sizeof(f))
+		goto bailout;
+	memcpy(&f, imprints->bins->base + free, sizeof(f));
+	if (f.magic != IMPS_MAGIC ||
+	    f.first != BUNfirst(b) ||
+	    f.last != BUNlast(b) ||
+	    (f.bits != 8 && f.bits != 16 && f.bits != 32 && f.bits != 64) ||
+	    HEAPloadindex(imprints->imps, nme, "imps") < 0 ||
+	    HEAPloadindex(imprints->dict, nme, "dict") < 0 ||
+	    imprints->imps->free != f.impcnt * (f.bits / 8) ||
+	    imprints->dict->free != f.dictcnt * sizeof(cchdc_t))
+		goto bailout;
+	imprints->bins->free = free;
+	imprints->bits = (bte) f.bits;
+	imprints->impcnt = f.impcnt;
+	imprints->dictcnt = f.dictcnt;
+	ALGODEBUG fprintf(stderr, "#IMPSload(%s): loaded " BUNFMT " imprints\n", BATgetId(b), imprints->impcnt);
+	return imprints;
+
+  bailout:
+	/* stale or damaged: throw it away */
+	ALGODEBUG fprintf(stderr, "#IMPSload(%s): discarded saved imprints\n", BATgetId(b));
+	HEAPfree(imprints->bins);
+	HEAPfree(imprints->imps);
+	HEAPfree(imprints->dict);
+	GDKfree(imprints->bins);
+	GDKfree(imprints->imps);
+	GDKfree(imprints->dict);
+	GDKfree(imprints);
+	IMPSunlink(nme);
+	return NULL;
+}
 
 BAT *
 BATimprints(BAT *b) {
@@ -534,6 +698,11 @@ BATimprints(BAT *b) {
 	case TYPE_flt:
 	case TYPE_dbl:
 		break;
+	case TYPE_str:
+		/* the prefix keys follow the strCmp order */
+		if (b->T->type == TYPE_str)
+			break;
+		/* fall through */
 	default: /* type not supported */
 		GDKerror("#BATimprints: col type not "
 		         "suitable for imprints index.\n");
@@ -549,11 +718,19 @@ BATimprints(BAT *b) {
 	}
 
 	MT_lock_set(&GDKimprintsLock(ABS(b->batCacheid)), "BATimprints");
+	if (b->T->imprints == NULL)
+		b->T->imprints = IMPSload(b);
 	if (b->T->imprints == NULL) {
 		Imprints *imprints;
-		BAT *smp;
+		BAT *smp = NULL;
 		BUN cnt;
 		str nme = BBP_physical(b->batCacheid);
+		int tpe = ATOMstorage(b->T->type);
+		const void *col = Tloc(b, 0), *smpbase;
+		lng *keys = NULL;
+		char *impsnme, *dictnme;
+		int persist = b->batPersistence == PERSISTENT &&
+			b->batCacheid > 0, ret;
 
 		ALGODEBUG fprintf(stderr, "#BATimprints(b=%s#"BUNFMT") %s: "
 			"created imprints\n", BATgetId(b), BATcount(b),
@@ -568,12 +745,47 @@ BATimprints(BAT *b) {
 		}
 
 #define SMP_SIZE 2048
-		smp = BATsample(b, SMP_SIZE);
-		smp = BATmirror(BATorder(BATmirror(smp)));
-		smp = BATmirror(BATkunique(BATmirror(smp)));
-		/* sample now is ordered and unique on tail */
-		assert(smp->tkey && smp->tsorted);
-		cnt = BATcount(smp);
+		if (tpe == TYPE_str) {
+			/* imprint the prefix keys of the strings; the
+			 * sample is taken from the keys directly */
+			BATiter bi = bat_iterator(b);
+			BUN i, k, n = BUNlast(b);
+			BUN step = BATcount(b) / SMP_SIZE + 1;
+			lng *s;
+
+			keys = GDKmalloc((n + SMP_SIZE) * sizeof(lng));
+			if (keys == NULL) {
+				GDKerror("#BATimprints: memory allocation error.\n");
+				GDKfree(imprints);
+				MT_lock_unset(&GDKimprintsLock(ABS(b->batCacheid)),
+				"BATimprints");
+				return NULL;
+			}
+			s = keys + n;
+			for (i = 0; i < BUNfirst(b); i++)
+				keys[i] = -1;
+			for (; i < n; i++)
+				keys[i] = IMPSstrkey(BUNtail(bi, i));
+			for (cnt = 0, i = BUNfirst(b); i < n; i += step)
+				s[cnt++] = keys[i];
+			GDKqsort(s, NULL, NULL, (size_t) cnt, sizeof(lng), 0,
+				 TYPE_lng);
+			for (i = k = 0; i < cnt; i++)
+				if (k == 0 || s[k - 1] != s[i])
+					s[k++] = s[i];
+			cnt = k;
+			col = keys;
+			smpbase = s;
+			tpe = TYPE_lng;
+		} else {
+			smp = BATsample(b, SMP_SIZE);
+			smp = BATmirror(BATorder(BATmirror(smp)));
+			smp = BATmirror(BATkunique(BATmirror(smp)));
+			/* sample now is ordered and unique on tail */
+			assert(smp->tkey && smp->tsorted);
+			cnt = BATcount(smp);
+			smpbase = Tloc(smp, smp->U->first);
+		}
 
 		/* bins of histogram */
 		imprints->bins = (Heap *) GDKzalloc(sizeof(Heap));
@@ -585,16 +797,21 @@ BATimprints(BAT *b) {
 			}
 			GDKerror("#BATimprints: memory allocation error.\n");
 			GDKfree(imprints);
-			BBPunfix(smp->batCacheid);
+			if (smp)
+				BBPunfix(smp->batCacheid);
+			GDKfree(keys);
 			MT_lock_unset(&GDKimprintsLock(ABS(b->batCacheid)),
 			"BATimprints");
 			return NULL;
 		}
 		sprintf(imprints->bins->filename, "%s.bins", nme);
-		if (HEAPalloc(imprints->bins, 64, b->T->width) < 0 ) {
+		if (HEAPalloc(imprints->bins, 64, ATOMsize(tpe)) < 0 ) {
 			GDKerror("#BATimprints: memory allocation error");
 			GDKfree(imprints->bins);
 			GDKfree(imprints);
+			if (smp)
+				BBPunfix(smp->batCacheid);
+			GDKfree(keys);
 			MT_lock_unset(&GDKimprintsLock(ABS(b->batCacheid)),
 					"BATimprints");
 			return NULL;
@@ -603,7 +820,7 @@ BATimprints(BAT *b) {
 #define FILL_HISTOGRAM(TYPE)                                      \
 do {                                                              \
 	BUN k;                                                    \
-	TYPE *s = (TYPE *)Tloc(smp, smp->U->first);               \
+	const TYPE *s = (const TYPE *) smpbase;                   \
 	TYPE *h = (TYPE *)imprints->bins->base;                   \
 	if (cnt < 64-1) {                                         \
 		TYPE max = GDK_##TYPE##_max;                      \
@@ -624,7 +841,7 @@ do {                                                              \
 		imprints->bits=64;                                \
 	}                                                         \
 } while (0)
-		switch (ATOMstorage(b->T->type)) {
+		switch (tpe) {
 		case TYPE_bte:
 			FILL_HISTOGRAM(bte);
 			break;
@@ -648,7 +865,8 @@ do {                                                              \
 			assert(0);
 		}
 
-		BBPunfix(smp->batCacheid);
+		if (smp)
+			BBPunfix(smp->batCacheid);
 
 		/* alloc heaps for imprints vectors and cache dictionary */
 		imprints->imps = (Heap *) GDKzalloc(sizeof(Heap));
@@ -674,6 +892,7 @@ do {                                                              \
 				GDKfree(imprints->dict);
 			}
 			GDKfree(imprints);
+			GDKfree(keys);
 			MT_lock_unset(&GDKimprintsLock(ABS(b->batCacheid)),
 					"BATimprints");
 			return NULL;
@@ -681,11 +900,20 @@ do {                                                              \
 		sprintf(imprints->imps->filename, "%s.imps", nme);
 		sprintf(imprints->dict->filename, "%s.dict", nme);
 
+		/* the imprints of a persistent bat are kept off the
+		 * file system until they are saved */
+		impsnme = imprints->imps->filename;
+		dictnme = imprints->dict->filename;
+		if (persist)
+			imprints->imps->filename = imprints->dict->filename = NULL;
 		/* TODO: better estimation for the size to alloc */
-		if (HEAPalloc(imprints->imps, b->T->heap.size/IMPS_PAGE,
+		ret = HEAPalloc(imprints->imps, b->T->heap.size/IMPS_PAGE,
 					imprints->bits/8) +
 			HEAPalloc(imprints->dict, b->T->heap.size/IMPS_PAGE,
-				sizeof(cchdc_t)) < 0) {
+				sizeof(cchdc_t));
+		imprints->imps->filename = impsnme;
+		imprints->dict->filename = dictnme;
+		if (ret < 0) {
 			GDKerror("#BATimprints: memory allocation error");
 			HEAPfree(imprints->bins);
 			HEAPfree(imprints->imps);
@@ -694,12 +922,14 @@ do {                                                              \
 			GDKfree(imprints->imps);
 			GDKfree(imprints->dict);
 			GDKfree(imprints);
+			GDKfree(keys);
 			MT_lock_unset(&GDKimprintsLock(ABS(b->batCacheid)),
 					"BATimprints");
 			return NULL;
 		}
 
-		if (!imprints_create(b, imprints->bins->base, imprints->bits,
+		if (!imprints_create(b, col, tpe,
+					imprints->bins->base, imprints->bits,
 					imprints->imps->base,
 					&imprints->impcnt,
 					imprints->dict->base,
@@ -712,11 +942,16 @@ do {                                                              \
 			GDKfree(imprints->imps);
 			GDKfree(imprints->dict);
 			GDKfree(imprints);
+			GDKfree(keys);
 			MT_lock_unset(&GDKimprintsLock(ABS(b->batCacheid)),
 					"BATimprints");
 			return NULL;
 		}
+		GDKfree(keys);
 		b->T->imprints = imprints;
+		/* a clean bat on disk can have its imprints saved now */
+		if (persist && !BATdirty(b))
+			(void) IMPSsave(b);
 	}
 	MT_lock_unset(&GDKimprintsLock(ABS(b->batCacheid)), "BATimprints");
 
@@ -774,6 +1009,14 @@ IMPSgetbin(int tpe, bte bits, char *inbins, const void *v)
 				BINSIZE(bits, getbin, dbl);
 			}
 			break;
+		case TYPE_str:
+			{
+				lng *bins = (lng *) inbins;
+				lng k = IMPSstrkey((const char *) v);
+				v = &k;
+				BINSIZE(bits, getbin, lng);
+			}
+			break;
 		default:
 			assert(0);
 			(void) inbins;
@@ -783,41 +1026,183 @@ IMPSgetbin(int tpe, bte bits, char *inbins, const void *v)
 }
 
 
+static void
+imprints_setvector(Imprints *imprints, BUN i, uint64_t vec)
+{
+	switch (imprints->bits) {
+	case 8:
+		((uint8_t *) imprints->imps->base)[i] = (uint8_t) vec;
+		break;
+	case 16:
+		((uint16_t *) imprints->imps->base)[i] = (uint16_t) vec;
+		break;
+	case 32:
+		((uint32_t *) imprints->imps->base)[i] = (uint32_t) vec;
+		break;
+	default:
+		((uint64_t *) imprints->imps->base)[i] = vec;
+		break;
+	}
+}
+
+/* add the imprint of a new cache line, compressing like imprints_create */
+static void
+imprints_push(Imprints *imprints, uint64_t vec)
+{
+	cchdc_t *d = (cchdc_t *) imprints->dict->base;
+	BUN dcnt = imprints->dictcnt, icnt = imprints->impcnt;
+
+	if (icnt > 0 && IMPSvector(imprints, icnt - 1) == vec &&
+	    d[dcnt - 1].cnt < IMPS_MAX_CNT - 1) {
+		if (!d[dcnt - 1].repeat) {
+			if (d[dcnt - 1].cnt > 1) {
+				/* split off the last imprint */
+				d[dcnt - 1].cnt--;
+				d[dcnt].cnt = 1;
+				d[dcnt].flags = 0;
+				dcnt++;
+			}
+			d[dcnt - 1].repeat = 1;
+		}
+		d[dcnt - 1].cnt++;
+	} else {
+		imprints_setvector(imprints, icnt++, vec);
+		if (dcnt > 0 && !d[dcnt - 1].repeat &&
+		    d[dcnt - 1].cnt < IMPS_MAX_CNT - 1) {
+			d[dcnt - 1].cnt++;
+		} else {
+			d[dcnt].cnt = 1;
+			d[dcnt].repeat = 0;
+			d[dcnt].flags = 0;
+			dcnt++;
+		}
+	}
+	imprints->dictcnt = dcnt;
+	imprints->impcnt = icnt;
+}
+
+/*
+ * Extend the imprints of b with the values appended at [first,
+ * BUNlast(b)).  The bins are kept: values outside the sampled range
+ * fall in the outer bins, which keeps the imprints correct, if less
+ * selective.
+ */
 void
-IMPSremove(BAT *b) {
-	Imprints *imprints;
+IMPSappend(BAT *b, BUN first)
+{
+	Imprints *imprints = b->T->imprints;
+	BATiter bi = bat_iterator(b);
+	BUN vpl = IMPS_PAGE >> b->T->shift;	/* values per cache line */
+	BUN last = BUNlast(b), lines = 0, p, e, i;
+	int tpe = ATOMstorage(b->ttype);
+	cchdc_t *d;
+	uint64_t vec, old;
 
-	assert(BAThdense(b)); /* assert void head */
-	assert(b->T->imprints != NULL);
+	if (imprints == NULL || first >= last)
+		return;
 	assert(!VIEWtparent(b));
+	if (HEAPextend(imprints->imps,
+		       (size_t) (imprints->impcnt + (last - first) / vpl + 2) *
+		       (imprints->bits / 8)) < 0 ||
+	    HEAPextend(imprints->dict,
+		       (size_t) (imprints->dictcnt + (last - first) / vpl + 2) *
+		       sizeof(cchdc_t)) < 0) {
+		IMPSremove(b);
+		return;
+	}
+	ALGODEBUG fprintf(stderr, "#IMPSappend(b=%s#" BUNFMT "): append "
+			  BUNFMT " values\n", BATgetId(b), BATcount(b),
+			  last - first);
+
+	MT_lock_set(&GDKimprintsLock(ABS(b->batCacheid)), "IMPSappend");
+	d = (cchdc_t *) imprints->dict->base;
+	for (i = 0; i < imprints->dictcnt; i++)
+		lines += d[i].cnt;
+	for (p = first; p < last; p = e) {
+		e = (p / vpl + 1) * vpl;
+		if (e > last)
+			e = last;
+		for (vec = 0, i = p; i < e; i++)
+			vec |= (uint64_t) 1 << IMPSgetbin(tpe, imprints->bits,
+							  imprints->bins->base,
+							  BUNtail(bi, i));
+		if (p / vpl < lines) {
+			/* the last cache line was partially filled */
+			BUN dcnt = imprints->dictcnt;
+
+			old = IMPSvector(imprints, imprints->impcnt - 1);
+			if ((old | vec) != old) {
+				if (d[dcnt - 1].repeat && d[dcnt - 1].cnt > 1) {
+					d[dcnt - 1].cnt--;
+					imprints_push(imprints, old | vec);
+				} else {
+					imprints_setvector(imprints, imprints->impcnt - 1, old | vec);
+				}
+			}
+		} else {
+			imprints_push(imprints, vec);
+		}
+	}
+	MT_lock_unset(&GDKimprintsLock(ABS(b->batCacheid)), "IMPSappend");
+}
+
+static void
+imprints_heapdrop(Heap *h, const char *nme, const char *ext, int keepfile,
+		  int persistent)
+{
+	if (h->storage == STORE_MMAP ||
+	    (!keepfile && (h->storage != STORE_MEM || persistent)))
+		HEAPdelete(h, nme, ext);
+	else
+		HEAPfree(h);
+	GDKfree(h);
+}
+
+static void
+IMPSdrop(BAT *b, int keepfile)
+{
+	Imprints *imprints;
+	str nme = BBP_physical(b->batCacheid);
+	int persistent = b->batPersistence == PERSISTENT;
 
 	MT_lock_set(&GDKimprintsLock(ABS(b->batCacheid)),
 			"BATimprints");
 	imprints = b->T->imprints;
 	b->T->imprints = NULL;
 
-	if (imprints->imps->storage != STORE_MEM)
-		HEAPdelete(imprints->imps,
-				BBP_physical(b->batCacheid), "imps");
-	else
-		HEAPfree(imprints->imps);
-	if (imprints->dict->storage != STORE_MEM)
-		HEAPdelete(imprints->dict,
-				BBP_physical(b->batCacheid), "dict");
-	else
-		HEAPfree(imprints->dict);
-	if (imprints->bins->storage != STORE_MEM)
-		HEAPdelete(imprints->bins,
-				BBP_physical(b->batCacheid), "bins");
-	else
-		HEAPfree(imprints->bins);
-
-	GDKfree(imprints);
+	if (imprints != NULL) {
+		imprints_heapdrop(imprints->imps, nme, "imps", keepfile,
+				  persistent);
+		imprints_heapdrop(imprints->dict, nme, "dict", keepfile,
+				  persistent);
+		imprints_heapdrop(imprints->bins, nme, "bins", keepfile,
+				  persistent);
+		GDKfree(imprints);
+	}
 
 	MT_lock_unset(&GDKimprintsLock(ABS(b->batCacheid)),
 			"BATimprints");
+}
 
-	return;
+/* throw away the imprints of b, including a saved image */
+void
+IMPSremove(BAT *b) {
+	assert(BAThdense(b)); /* assert void head */
+	assert(b->T->imprints != NULL);
+	assert(!VIEWtparent(b));
+
+	IMPSdrop(b, 0);
+}
+
+/* release the imprints of b, but keep a saved image */
+void
+IMPSfree(BAT *b) {
+	if (b) {
+		if (b->T->imprints != NULL && !VIEWtparent(b))
+			IMPSdrop(b, 1);
+		if (b->H->imprints != NULL && !VIEWhparent(b))
+			IMPSdrop(BATmirror(b), 1);
+	}
 }
 
 void
@@ -45,4 +45,20 @@ typedef struct {
 #define IMPSisSet(B,X,Y)       (((((uint##B##_t)1)<<Y)&X)?1:0)
 #define IMPSmod2(X,Y)        ((X)&((Y)-1))
 
+/* imprint vector I of any width as a 64 bit mask */
+static inline uint64_t
+IMPSvector(const Imprints *imprints, BUN i)
+{
+	switch (imprints->bits) {
+	case 8:
+		return ((const uint8_t *) imprints->imps->base)[i];
+	case 16:
+		return ((const uint16_t *) imprints->imps->base)[i];
+	case 32:
+		return ((const uint32_t *) imprints->imps->base)[i];
+	default:
+		return ((const uint64_t *) imprints->imps->base)[i];
+	}
+}
+
 #endif /* GDK_IMPS_H */
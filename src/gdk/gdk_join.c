@@ -21,6 +21,7 @@
 #include "gdk.h"
 #include "gdk_private.h"
 #include "gdk_calc_private.h"
+#include "gdk_mapreduce.h"
 
 /* Perform a bunch of sanity checks on the inputs to a join. */
 static gdk_return
@@ -880,6 +881,444 @@ hashjoin(BAT *r1, BAT *r2, BAT *l, BAT *r, BAT *sl, BAT *sr, int nil_matches, in
 	return GDK_FAIL;
 }
 
+/* Radix-partitioned hash join.
+ *
+ * When the inner side of a hash join is much larger than the CPU
+ * caches, nearly every probe of a hash table built on it is a cache
+ * miss.  Instead, both inputs are partitioned on the lower bits of a
+ * hash of their values (in one or two passes, to keep the fan-out of
+ * each pass small enough for the TLB), such that a hash table on a
+ * single partition of the inner side fits in the cache.  Matching
+ * partitions are then joined independently, on as many threads as
+ * we are allowed to use.
+ *
+ * Only fixed size 4 and 8 byte integral types are handled (for those,
+ * equality is equality of the bit pattern), without candidate lists
+ * other than dense ones, and only for inner joins where nils never
+ * match.  The result is produced in partition order; if requested it
+ * is reordered on the left oid afterwards. */
+
+#define RADIX_MINSIZE	((size_t) 4 << 20)	/* inner side bytes before we bother */
+#define RADIX_CACHE	((size_t) 256 << 10)	/* target inner partition bytes */
+#define RADIX_PASSBITS	8			/* maximum bits per pass */
+
+static inline unsigned int
+radix_hash_int(unsigned int h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6bU;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35U;
+	h ^= h >> 16;
+	return h;
+}
+
+static inline unsigned int
+radix_hash_lng(ulng h)
+{
+	h ^= h >> 33;
+	h *= LL_CONSTANT(0xff51afd7ed558ccd);
+	h ^= h >> 33;
+	h *= LL_CONSTANT(0xc4ceb9fe1a85ec53);
+	h ^= h >> 33;
+	return (unsigned int) h;
+}
+
+/* Scatter n values (with their oids) from src to dst on bits
+ * [shift, shift+bits) of the hash, keeping the order within each
+ * partition.  If srco is NULL, the oids are off, off+1, ...; if nil
+ * is set, nil values are left out.  The 1<<bits+1 partition
+ * boundaries (relative to dst) are stored in bnd. */
+#define RADIX_PARTITION(TYPE, UTYPE)					\
+static void								\
+radix_partition_##TYPE(const TYPE *src, const oid *srco, oid off,	\
+		       BUN n, const TYPE *nil,				\
+		       TYPE *dst, oid *dsto, BUN *bnd,			\
+		       int shift, int bits)				\
+{									\
+	BUN i, cnt[(1 << RADIX_PASSBITS) + 1];				\
+	unsigned int mask = (1U << bits) - 1, p;			\
+									\
+	memset(cnt, 0, sizeof(cnt));					\
+	for (i = 0; i < n; i++) {					\
+		if (nil && src[i] == *nil)				\
+			continue;					\
+		cnt[((radix_hash_##TYPE((UTYPE) src[i]) >> shift) & mask) + 1]++; \
+	}								\
+	for (p = 1; p <= mask + 1; p++)					\
+		cnt[p] += cnt[p - 1];					\
+	memcpy(bnd, cnt, (mask + 2) * sizeof(BUN));			\
+	for (i = 0; i < n; i++) {					\
+		BUN j;							\
+		if (nil && src[i] == *nil)				\
+			continue;					\
+		p = (radix_hash_##TYPE((UTYPE) src[i]) >> shift) & mask; \
+		j = cnt[p]++;						\
+		dst[j] = src[i];					\
+		dsto[j] = srco ? srco[i] : off + i;			\
+	}								\
+}
+
+RADIX_PARTITION(int, unsigned int)
+RADIX_PARTITION(lng, ulng)
+
+typedef struct {
+	MRtask task;			/* scheduler header, must be first */
+	int id, nthreads;
+	int width;			/* 4 or 8 */
+	int bits;			/* total partitioning bits */
+	int nparts;
+	const void *lvals, *rvals;	/* partitioned values */
+	const oid *loids, *roids;	/* and their oids */
+	const BUN *lbnd, *rbnd;		/* partition boundaries */
+	oid *res1, *res2;		/* matching pairs */
+	BUN cnt, cap;
+	BUN *pbnd;			/* result boundaries per partition */
+	BUN *buckets, *next;		/* hash table, reused */
+	BUN nbuckets, nnext;
+	int error;
+} radixjoin_t;
+
+static int
+radix_append(radixjoin_t *rj, oid lo, oid ro)
+{
+	if (rj->cnt == rj->cap) {
+		BUN cap = rj->cap ? 2 * rj->cap : 1024;
+		oid *res1 = GDKrealloc(rj->res1, cap * sizeof(oid));
+		oid *res2;
+
+		if (res1 == NULL)
+			return -1;
+		rj->res1 = res1;
+		if ((res2 = GDKrealloc(rj->res2, cap * sizeof(oid))) == NULL)
+			return -1;
+		rj->res2 = res2;
+		rj->cap = cap;
+	}
+	rj->res1[rj->cnt] = lo;
+	rj->res2[rj->cnt++] = ro;
+	return 0;
+}
+
+/* build a hash table on partition p of the inner side and probe it
+ * with partition p of the outer side */
+#define RADIX_PROBE(TYPE, UTYPE)					\
+	do {								\
+		const TYPE *rv = (const TYPE *) rj->rvals + rj->rbnd[p]; \
+		const TYPE *lv = (const TYPE *) rj->lvals + rj->lbnd[p]; \
+		const oid *ro = rj->roids + rj->rbnd[p];		\
+		const oid *lo = rj->loids + rj->lbnd[p];		\
+		BUN rn = rj->rbnd[p + 1] - rj->rbnd[p];			\
+		BUN ln = rj->lbnd[p + 1] - rj->lbnd[p];			\
+		BUN i, j, mask;						\
+									\
+		if (rn == 0 || ln == 0)					\
+			break;						\
+		for (mask = 1; mask < rn; mask <<= 1)			\
+			;						\
+		if (mask > rj->nbuckets) {				\
+			GDKfree(rj->buckets);				\
+			if ((rj->buckets = GDKmalloc(mask * sizeof(BUN))) == NULL) { \
+				rj->error = 1;				\
+				return;					\
+			}						\
+			rj->nbuckets = mask;				\
+		}							\
+		if (rn > rj->nnext) {					\
+			GDKfree(rj->next);				\
+			if ((rj->next = GDKmalloc(rn * sizeof(BUN))) == NULL) { \
+				rj->error = 1;				\
+				return;					\
+			}						\
+			rj->nnext = rn;					\
+		}							\
+		mask--;							\
+		for (i = 0; i <= mask; i++)				\
+			rj->buckets[i] = BUN_NONE;			\
+		/* insert backwards, so chains run in inner order */	\
+		for (i = rn; i-- > 0; ) {				\
+			BUN h = (radix_hash_##TYPE((UTYPE) rv[i]) >> rj->bits) & mask; \
+			rj->next[i] = rj->buckets[h];			\
+			rj->buckets[h] = i;				\
+		}							\
+		for (i = 0; i < ln; i++) {				\
+			BUN h = (radix_hash_##TYPE((UTYPE) lv[i]) >> rj->bits) & mask; \
+			for (j = rj->buckets[h]; j != BUN_NONE; j = rj->next[j]) \
+				if (rv[j] == lv[i] &&			\
+				    radix_append(rj, lo[i], ro[j]) < 0) { \
+					rj->error = 1;			\
+					return;				\
+				}					\
+		}							\
+	} while (0)
+
+static void
+radix_join_worker(void *arg)
+{
+	radixjoin_t *rj = arg;
+	int p, k;
+
+	for (p = rj->id, k = 0; p < rj->nparts; p += rj->nthreads, k++) {
+		rj->pbnd[k] = rj->cnt;
+		if (rj->width == 4)
+			RADIX_PROBE(int, unsigned int);
+		else
+			RADIX_PROBE(lng, ulng);
+	}
+	rj->pbnd[k] = rj->cnt;
+}
+
+static int
+radixjoin_applies(BAT *l, BAT *r, BAT *sl, BAT *sr)
+{
+	if ((sl && !BATtdense(sl)) || (sr && !BATtdense(sr)))
+		return 0;
+	if (r->T->hash || l->tvarsized)
+		return 0;
+	switch (ATOMstorage(l->ttype)) {
+	case TYPE_int:
+	case TYPE_lng:
+	case TYPE_oid:
+	case TYPE_wrd:
+		break;
+	default:
+		return 0;
+	}
+	if (l->T->width != 4 && l->T->width != 8)
+		return 0;
+	return (size_t) BATcount(sr ? sr : r) * (l->T->width + sizeof(oid) + 2 * sizeof(BUN)) >= RADIX_MINSIZE;
+}
+
+/* Inner join of l and r using radix partitioning; r is the side of
+ * which a partition should fit in the cache.  If ordered is set, the
+ * result is sorted on r1, as hashjoin would produce it. */
+static gdk_return
+radixjoin(BAT *r1, BAT *r2, BAT *l, BAT *r, BAT *sl, BAT *sr, int ordered)
+{
+	BUN lstart, lend, lcnt;
+	const oid *lcand = NULL, *lcandend = NULL;
+	BUN rstart, rend, rcnt;
+	const oid *rcand = NULL, *rcandend = NULL;
+	int width = l->T->width;
+	const void *nil = ATOMnilptr(l->ttype);
+	int bits, bits1, bits2, nparts, nthreads, i, p;
+	void *lv[2] = {NULL, NULL}, *rv[2] = {NULL, NULL};
+	oid *lo[2] = {NULL, NULL}, *ro[2] = {NULL, NULL};
+	BUN *lbnd = NULL, *rbnd = NULL, *lbnd1 = NULL, *rbnd1 = NULL;
+	radixjoin_t *rj = NULL;
+	BUN cnt, n;
+	size_t psize;
+	oid *o1, *o2;
+	gdk_return ret = GDK_FAIL;
+
+	CANDINIT(l, sl, lstart, lend, lcnt, lcand, lcandend);
+	CANDINIT(r, sr, rstart, rend, rcnt, rcand, rcandend);
+	assert(lcand == NULL && rcand == NULL);
+	lcnt = lend - lstart;
+	rcnt = rend - rstart;
+	if (lcnt == 0 || rcnt == 0) {
+		/* the candidate lists miss the BATs: no partitions to
+		 * allocate, and no result */
+		BATsetcount(r1, 0);
+		BATsetcount(r2, 0);
+		r1->tsorted = r1->trevsorted = r1->tkey = 1;
+		r2->tsorted = r2->trevsorted = r2->tkey = 1;
+		return GDK_SUCCEED;
+	}
+
+	/* number of partitions such that an inner one fits in the cache */
+	psize = (size_t) rcnt * (width + sizeof(oid) + 2 * sizeof(BUN));
+	for (bits = 0; bits < 2 * RADIX_PASSBITS && (psize >> bits) > RADIX_CACHE; bits++)
+		;
+	bits1 = bits > RADIX_PASSBITS ? (bits + 1) / 2 : bits;
+	bits2 = bits - bits1;
+	nparts = 1 << bits;
+	nthreads = GDKnr_threads > 1 ? GDKnr_threads : 1;
+	if (nthreads > nparts)
+		nthreads = nparts;
+
+	ALGODEBUG fprintf(stderr, "#radixjoin(l=%s#" BUNFMT ",r=%s#" BUNFMT
+			  ",ordered=%d): %d partitions (%d+%d bits), %d threads\n",
+			  BATgetId(l), lcnt, BATgetId(r), rcnt, ordered,
+			  nparts, bits1, bits2, nthreads);
+
+	for (i = 0; i < 2; i++) {
+		lv[i] = GDKmalloc(lcnt * width);
+		lo[i] = GDKmalloc(lcnt * sizeof(oid));
+		rv[i] = GDKmalloc(rcnt * width);
+		ro[i] = GDKmalloc(rcnt * sizeof(oid));
+		if (lv[i] == NULL || lo[i] == NULL || rv[i] == NULL || ro[i] == NULL)
+			goto bailout;
+		if (bits2 == 0)
+			break;
+	}
+	lbnd = GDKmalloc((nparts + 1) * sizeof(BUN));
+	rbnd = GDKmalloc((nparts + 1) * sizeof(BUN));
+	lbnd1 = GDKmalloc(((1 << bits1) + 1) * sizeof(BUN));
+	rbnd1 = GDKmalloc(((1 << bits1) + 1) * sizeof(BUN));
+	rj = GDKzalloc(nthreads * sizeof(radixjoin_t));
+	if (lbnd == NULL || rbnd == NULL || lbnd1 == NULL || rbnd1 == NULL || rj == NULL)
+		goto bailout;
+
+	/* first pass straight from the BATs, dropping nils */
+	if (width == 4) {
+		radix_partition_int((const int *) Tloc(l, BUNfirst(l)) + lstart, NULL, l->hseqbase + lstart, lcnt, nil, lv[0], lo[0], lbnd1, 0, bits1);
+		radix_partition_int((const int *) Tloc(r, BUNfirst(r)) + rstart, NULL, r->hseqbase + rstart, rcnt, nil, rv[0], ro[0], rbnd1, 0, bits1);
+	} else {
+		radix_partition_lng((const lng *) Tloc(l, BUNfirst(l)) + lstart, NULL, l->hseqbase + lstart, lcnt, nil, lv[0], lo[0], lbnd1, 0, bits1);
+		radix_partition_lng((const lng *) Tloc(r, BUNfirst(r)) + rstart, NULL, r->hseqbase + rstart, rcnt, nil, rv[0], ro[0], rbnd1, 0, bits1);
+	}
+	if (bits2 == 0) {
+		memcpy(lbnd, lbnd1, (nparts + 1) * sizeof(BUN));
+		memcpy(rbnd, rbnd1, (nparts + 1) * sizeof(BUN));
+	} else {
+		/* second pass within each first level partition */
+		int n2 = 1 << bits2, j;
+
+		for (p = 0; p < 1 << bits1; p++) {
+			BUN lb = lbnd1[p], rb = rbnd1[p];
+
+			if (width == 4) {
+				radix_partition_int((const int *) lv[0] + lb, lo[0] + lb, 0, lbnd1[p + 1] - lb, NULL, (int *) lv[1] + lb, lo[1] + lb, lbnd + p * n2, bits1, bits2);
+				radix_partition_int((const int *) rv[0] + rb, ro[0] + rb, 0, rbnd1[p + 1] - rb, NULL, (int *) rv[1] + rb, ro[1] + rb, rbnd + p * n2, bits1, bits2);
+			} else {
+				radix_partition_lng((const lng *) lv[0] + lb, lo[0] + lb, 0, lbnd1[p + 1] - lb, NULL, (lng *) lv[1] + lb, lo[1] + lb, lbnd + p * n2, bits1, bits2);
+				radix_partition_lng((const lng *) rv[0] + rb, ro[0] + rb, 0, rbnd1[p + 1] - rb, NULL, (lng *) rv[1] + rb, ro[1] + rb, rbnd + p * n2, bits1, bits2);
+			}
+			/* boundaries are relative to the first level partition */
+			for (j = 0; j < n2; j++) {
+				lbnd[p * n2 + j] += lb;
+				rbnd[p * n2 + j] += rb;
+			}
+		}
+		lbnd[nparts] = lbnd1[1 << bits1];
+		rbnd[nparts] = rbnd1[1 << bits1];
+	}
+
+	for (i = 0; i < nthreads; i++) {
+		rj[i].id = i;
+		rj[i].nthreads = nthreads;
+		rj[i].width = width;
+		rj[i].bits = bits;
+		rj[i].nparts = nparts;
+		rj[i].lvals = lv[bits2 != 0];
+		rj[i].rvals = rv[bits2 != 0];
+		rj[i].loids = lo[bits2 != 0];
+		rj[i].roids = ro[bits2 != 0];
+		rj[i].lbnd = lbnd;
+		rj[i].rbnd = rbnd;
+		rj[i].pbnd = GDKmalloc(((nparts + nthreads - 1) / nthreads + 1) * sizeof(BUN));
+		if (rj[i].pbnd == NULL)
+			goto bailout;
+	}
+	if (nthreads == 1) {
+		radix_join_worker(&rj[0]);
+	} else {
+		/* probe the partitions on the shared workers */
+		void **tasks = GDKmalloc(nthreads * sizeof(void *));
+
+		if (tasks == NULL)
+			goto bailout;
+		for (i = 0; i < nthreads; i++)
+			tasks[i] = &rj[i];
+		MRschedule(nthreads, tasks, radix_join_worker);
+		GDKfree(tasks);
+	}
+	for (cnt = 0, i = 0; i < nthreads; i++) {
+		if (rj[i].error)
+			goto bailout;
+		cnt += rj[i].cnt;
+	}
+
+	if (cnt > BATcapacity(r1)) {
+		r1 = BATextend(r1, cnt);
+		r2 = BATextend(r2, cnt);
+		if (r1 == NULL || r2 == NULL)
+			goto bailout;
+	}
+	o1 = (oid *) Tloc(r1, BUNfirst(r1));
+	o2 = (oid *) Tloc(r2, BUNfirst(r2));
+	if (ordered) {
+		/* counting sort on the left oid, keeping the inner order */
+		BUN *pos = GDKzalloc((lcnt + 1) * sizeof(BUN));
+		oid lbase = l->hseqbase + lstart;
+
+		if (pos == NULL)
+			goto bailout;
+		for (i = 0; i < nthreads; i++)
+			for (n = 0; n < rj[i].cnt; n++)
+				pos[rj[i].res1[n] - lbase + 1]++;
+		for (n = 1; n <= lcnt; n++)
+			pos[n] += pos[n - 1];
+		for (p = 0; p < nparts; p++) {
+			radixjoin_t *w = &rj[p % nthreads];
+
+			for (n = w->pbnd[p / nthreads]; n < w->pbnd[p / nthreads + 1]; n++) {
+				BUN j = pos[w->res1[n] - lbase]++;
+
+				o1[j] = w->res1[n];
+				o2[j] = w->res2[n];
+			}
+		}
+		GDKfree(pos);
+	} else {
+		for (cnt = 0, p = 0; p < nparts; p++) {
+			radixjoin_t *w = &rj[p % nthreads];
+			BUN b = w->pbnd[p / nthreads], e = w->pbnd[p / nthreads + 1];
+
+			memcpy(o1 + cnt, w->res1 + b, (e - b) * sizeof(oid));
+			memcpy(o2 + cnt, w->res2 + b, (e - b) * sizeof(oid));
+			cnt += e - b;
+		}
+	}
+	BATsetcount(r1, cnt);
+	BATsetcount(r2, cnt);
+
+	/* if an input columns is key, the opposite output column will
+	 * be key */
+	r1->tkey = r->tkey != 0;
+	r2->tkey = l->tkey != 0;
+	r1->tsorted = ordered || cnt <= 1;
+	r1->trevsorted = cnt <= 1;
+	r2->tsorted = cnt <= 1;
+	r2->trevsorted = cnt <= 1;
+	if (cnt <= 1) {
+		r1->tkey = 1;
+		r2->tkey = 1;
+	}
+
+	ret = GDK_SUCCEED;
+
+  bailout:
+	if (rj) {
+		for (i = 0; i < nthreads; i++) {
+			GDKfree(rj[i].res1);
+			GDKfree(rj[i].res2);
+			GDKfree(rj[i].pbnd);
+			GDKfree(rj[i].buckets);
+			GDKfree(rj[i].next);
+		}
+		GDKfree(rj);
+	}
+	for (i = 0; i < 2; i++) {
+		GDKfree(lv[i]);
+		GDKfree(lo[i]);
+		GDKfree(rv[i]);
+		GDKfree(ro[i]);
+	}
+	GDKfree(lbnd);
+	GDKfree(rbnd);
+	GDKfree(lbnd1);
+	GDKfree(rbnd1);
+	if (ret == GDK_FAIL) {
+		if (r1)
+			BBPreclaim(r1);
+		if (r2)
+			BBPreclaim(r2);
+	}
+	return ret;
+}
+
 #define MASK_EQ		1
 #define MASK_LT		2
 #define MASK_GT		4
@@ -1058,17 +1497,37 @@ gdk_return
 BATsubleftjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, BUN estimate)
 {
 	BAT *r1, *r2;
+	BUN lcount, rcount;
 
 	*r1p = NULL;
 	*r2p = NULL;
 	if (joinparamcheck(l, r, sl, sr, "BATsubleftjoin") == GDK_FAIL)
 		return GDK_FAIL;
+	lcount = BATcount(l);
+	if (sl)
+		lcount = MIN(lcount, BATcount(sl));
+	rcount = BATcount(r);
+	if (sr)
+		rcount = MIN(rcount, BATcount(sr));
+	if (lcount == 0 || rcount == 0) {
+		r1 = BATnew(TYPE_void, TYPE_void, 0);
+		BATseqbase(r1, 0);
+		BATseqbase(BATmirror(r1), 0);
+		r2 = BATnew(TYPE_void, TYPE_void, 0);
+		BATseqbase(r2, 0);
+		BATseqbase(BATmirror(r2), 0);
+		*r1p = r1;
+		*r2p = r2;
+		return GDK_SUCCEED;
+	}
 	if (joininitresults(&r1, &r2, estimate != BUN_NONE ? estimate : sl ? BATcount(sl) : BATcount(l), "BATsubleftjoin") == GDK_FAIL)
 		return GDK_FAIL;
 	*r1p = r1;
 	*r2p = r2;
 	if (r->tsorted || r->trevsorted)
 		return mergejoin(r1, r2, l, r, sl, sr, 0, 0, 0);
+	if (radixjoin_applies(l, r, sl, sr))
+		return radixjoin(r1, r2, l, r, sl, sr, 1);
 	return hashjoin(r1, r2, l, r, sl, sr, 0, 0, 0);
 }
 
@@ -1185,6 +1644,12 @@ BATsubjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, BUN estimate)
 	} else if (r->tsorted || r->trevsorted) {
 		/* right is sorted, don't swap */
 		return mergejoin(r1, r2, l, r, sl, sr, 0, 0, 0);
+	} else if (lcount < rcount ? radixjoin_applies(r, l, sr, sl) : radixjoin_applies(l, r, sl, sr)) {
+		/* no hashes, not sorted, and too large for the cache:
+		 * partition, with the smallest BAT as inner side */
+		if (lcount < rcount)
+			return radixjoin(r2, r1, r, l, sr, sl, 0);
+		return radixjoin(r1, r2, l, r, sl, sr, 0);
 	} else if (BATcount(r1) < BATcount(r2)) {
 		/* no hashes, not sorted, create hash on smallest BAT */
 		swap = 1;
@@ -728,7 +728,9 @@ logger_open(logger *lg)
 
 	snprintf(filename, BUFSIZ, "%s%s." LLFMT, lg->dir, LOGFILE, lg->id);
 
+	MT_lock_set(&lg->flushlock, "logger_open");
 	lg->log = open_wstream(filename);
+	MT_lock_unset(&lg->flushlock, "logger_open");
 	lg->end = 0;
 	if (mnstr_errnr(lg->log))
 		return LOG_ERR;
@@ -736,16 +738,104 @@ logger_open(logger *lg)
 	return LOG_OK;
 }
 
+/* the first target commits written are on disk (or not, if err is
+ * set): wake up whoever waits for them */
+static void
+logger_synced(logger *lg, lng target, int err)
+{
+	int waiters;
+
+	MT_lock_set(&lg->commitlock, "logger_synced");
+	if (err)
+		lg->syncerr = 1;
+	else if (lg->synced < target)
+		lg->synced = target;
+	waiters = lg->waiters;
+	lg->waiters = 0;
+	MT_lock_unset(&lg->commitlock, "logger_synced");
+	while (waiters-- > 0)
+		MT_sema_up(&lg->syncsema, "logger_synced");
+}
+
 static void
 logger_close(logger *lg)
 {
 	stream *log = lg->log;
+	int err = 0;
 
+	MT_lock_set(&lg->flushlock, "logger_close");
 	if (log) {
+		/* sync what the flusher didn't get to yet */
+		if (lg->commitmode != LOG_COMMIT_SYNC && lg->synced < lg->written)
+			err = mnstr_fsync(log) != 0;
 		mnstr_close(log);
 		mnstr_destroy(log);
 	}
 	lg->log = NULL;
+	MT_lock_unset(&lg->flushlock, "logger_close");
+	if (lg->commitmode != LOG_COMMIT_SYNC)
+		logger_synced(lg, lg->written, err);
+}
+
+/*
+ * The flusher thread syncs the log on behalf of the committers.
+ * Whatever is written while it syncs (or waits for commitdelay) goes
+ * into the next round, so under a concurrent load one sync covers
+ * many commits.
+ */
+static void
+logger_flusher(void *arg)
+{
+	logger *lg = arg;
+	lng target;
+	int err;
+
+	MT_lock_set(&lg->commitlock, "logger_flusher");
+	while (lg->flushing) {
+		if (lg->synced >= lg->written || lg->syncerr) {
+			/* nothing to do, log_written wakes us */
+			lg->flushidle = 1;
+			MT_lock_unset(&lg->commitlock, "logger_flusher");
+			MT_sema_down(&lg->flushsema, "logger_flusher");
+			MT_lock_set(&lg->commitlock, "logger_flusher");
+			continue;
+		}
+		MT_lock_unset(&lg->commitlock, "logger_flusher");
+		/* let more commits join this round; the delay is
+		 * rounded up to whole milliseconds */
+		if (lg->commitdelay > 0)
+			MT_sleep_ms((unsigned int) ((lg->commitdelay + 999) / 1000));
+		MT_lock_set(&lg->commitlock, "logger_flusher");
+		target = lg->written;
+		MT_lock_unset(&lg->commitlock, "logger_flusher");
+		MT_lock_set(&lg->flushlock, "logger_flusher");
+		err = lg->log != NULL && mnstr_fsync(lg->log) != 0;
+		MT_lock_unset(&lg->flushlock, "logger_flusher");
+		if (lg->debug & 1)
+			fprintf(stderr, "logger_flusher synced up to commit " LLFMT "\n", target);
+		logger_synced(lg, target, err);
+		MT_lock_set(&lg->commitlock, "logger_flusher");
+	}
+	MT_lock_unset(&lg->commitlock, "logger_flusher");
+}
+
+/* a commit is written (and flushed) to the log: sync it ourselves,
+ * or leave it to the flusher */
+static int
+log_written(logger *lg)
+{
+	int wake;
+
+	if (lg->commitmode == LOG_COMMIT_SYNC)
+		return mnstr_fsync(lg->log) ? LOG_ERR : LOG_OK;
+	MT_lock_set(&lg->commitlock, "log_written");
+	lg->written++;
+	wake = lg->flushidle;
+	lg->flushidle = 0;
+	MT_lock_unset(&lg->commitlock, "log_written");
+	if (wake)
+		MT_sema_up(&lg->flushsema, "log_written");
+	return LOG_OK;
 }
 
 static int
@@ -1054,6 +1144,19 @@ logger_new(int debug, char *fn, char *logdir, int version, preversionfix_fptr pr
 	lg->read32bitoid = 0;
 #endif
 
+	/* replaying the log (logger_readlogs) closes it through
+	 * logger_close, so the commit state must be valid from the
+	 * start; the log is replayed in sync mode, logger_create
+	 * picks the configured mode afterwards */
+	MT_lock_init(&lg->commitlock, "commitlock");
+	MT_lock_init(&lg->flushlock, "flushlock");
+	MT_sema_init(&lg->flushsema, 0, "flushsema");
+	MT_sema_init(&lg->syncsema, 0, "syncsema");
+	lg->commitmode = LOG_COMMIT_SYNC;
+	lg->commitdelay = 0;
+	lg->written = lg->synced = 0;
+	lg->syncerr = lg->waiters = lg->flushing = lg->flushidle = 0;
+
 	/* if the path is absolute, it means someone is still calling
 	 * logger_create/logger_new "manually" */
 	assert(!MT_path_absolute(logdir));
@@ -1454,8 +1557,13 @@ logger_new(int debug, char *fn, char *logdir, int version, preversionfix_fptr pr
       error:
 	if (fp)
 		fclose(fp);
-	if (lg)
+	if (lg) {
+		MT_lock_destroy(&lg->commitlock);
+		MT_lock_destroy(&lg->flushlock);
+		MT_sema_destroy(&lg->flushsema);
+		MT_sema_destroy(&lg->syncsema);
 		GDKfree(lg);
+	}
 	return NULL;
 }
 
@@ -1463,9 +1571,20 @@ logger *
 logger_create(int debug, char *fn, char *logdir, int version, preversionfix_fptr prefuncp, postversionfix_fptr postfuncp)
 {
 	logger *lg = logger_new(debug, fn, logdir, version, prefuncp, postfuncp);
+	char *p;
 
 	if (!lg)
 		return NULL;
+	if ((p = GDKgetenv("gdk_log_commit")) != NULL) {
+		if (strcmp(p, "group") == 0)
+			lg->commitmode = LOG_COMMIT_GROUP;
+		else if (strcmp(p, "relaxed") == 0) {
+			/* by default, lose at most the last second */
+			lg->commitmode = LOG_COMMIT_RELAXED;
+			lg->commitdelay = 1000000;
+		}
+	}
+	lg->commitdelay = GDKgetenv_int("gdk_log_commit_delay", lg->commitdelay);
 	if (logger_open(lg) == LOG_ERR) {
 		logger_destroy(lg);
 
@@ -1478,12 +1597,26 @@ logger_create(int debug, char *fn, char *logdir, int version, preversionfix_fptr
 
 		return NULL;
 	}
+	if (lg->commitmode != LOG_COMMIT_SYNC) {
+		lg->flushing = 1;
+		if (MT_create_thread(&lg->flusher, logger_flusher, lg, MT_THR_JOINABLE) < 0) {
+			lg->flushing = 0;
+			lg->commitmode = LOG_COMMIT_SYNC;
+		}
+	}
 	return lg;
 }
 
 void
 logger_destroy(logger *lg)
 {
+	if (lg->flushing) {
+		MT_lock_set(&lg->commitlock, "logger_destroy");
+		lg->flushing = 0;
+		MT_lock_unset(&lg->commitlock, "logger_destroy");
+		MT_sema_up(&lg->flushsema, "logger_destroy");
+		MT_join_thread(lg->flusher);
+	}
 	if (lg->catalog_bid) {
 		BUN p, q;
 		BAT *b = lg->catalog_bid;
@@ -1514,6 +1647,10 @@ logger_destroy(logger *lg)
 	GDKfree(lg->fn);
 	GDKfree(lg->dir);
 	logger_close(lg);
+	MT_lock_destroy(&lg->commitlock);
+	MT_lock_destroy(&lg->flushlock);
+	MT_sema_destroy(&lg->flushsema);
+	MT_sema_destroy(&lg->syncsema);
 	GDKfree(lg);
 }
 
@@ -1924,12 +2061,39 @@ log_tend(logger *lg)
 	if (res ||
 	    log_write_format(lg, &l) == LOG_ERR ||
 	    mnstr_flush(lg->log) ||
-	    mnstr_fsync(lg->log))
+	    log_written(lg) == LOG_ERR)
 		return LOG_ERR;
 	pre_allocate(lg);
 	return LOG_OK;
 }
 
+/*
+ * Wait until everything written to the log so far is on disk. With
+ * group commit, committers call this after they have given up the
+ * locks that serialize writing the log, so others can write theirs
+ * in the meantime and share the sync.
+ */
+int
+log_tsync(logger *lg)
+{
+	lng target;
+	int res;
+
+	if (lg->commitmode != LOG_COMMIT_GROUP)
+		return LOG_OK;	/* synced in log_tend, or nobody waits */
+	MT_lock_set(&lg->commitlock, "log_tsync");
+	target = lg->written;
+	while (lg->synced < target && !lg->syncerr) {
+		lg->waiters++;
+		MT_lock_unset(&lg->commitlock, "log_tsync");
+		MT_sema_down(&lg->syncsema, "log_tsync");
+		MT_lock_set(&lg->commitlock, "log_tsync");
+	}
+	res = lg->syncerr ? LOG_ERR : LOG_OK;
+	MT_lock_unset(&lg->commitlock, "log_tsync");
+	return res;
+}
+
 int
 log_abort(logger *lg)
 {
@@ -1972,7 +2136,7 @@ log_sequence(logger *lg, int seq, lng val)
 	if (log_write_format(lg, &l) == LOG_ERR ||
 	    !mnstr_writeLng(lg->log, val) ||
 	    mnstr_flush(lg->log) ||
-	    mnstr_fsync(lg->log))
+	    log_written(lg) == LOG_ERR)
 		 return LOG_ERR;
 
 	pre_allocate(lg);
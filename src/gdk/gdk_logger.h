@@ -23,6 +23,11 @@
 #define LOG_OK 0
 #define LOG_ERR (-1)
 
+/* how commits are made durable (gdk_log_commit) */
+#define LOG_COMMIT_SYNC		0	/* log_tend syncs the log itself */
+#define LOG_COMMIT_GROUP	1	/* a flusher syncs, log_tsync waits for it */
+#define LOG_COMMIT_RELAXED	2	/* a flusher syncs, nobody waits */
+
 typedef struct logaction {
 	int type;		/* type of change */
 	int nr;
@@ -76,6 +81,22 @@ typedef struct logger {
 				   These snapshot bats should be freed
 				   directly (on transaction
 				   commit). */
+	/* group commit: log_tend only writes the log, the flusher
+	 * thread syncs whatever was written in one go and wakes the
+	 * committers waiting in log_tsync */
+	int commitmode;		/* LOG_COMMIT_SYNC, _GROUP or _RELAXED */
+	int commitdelay;	/* usec the flusher waits for more commits */
+	lng written;		/* number of commits written to the log */
+	lng synced;		/* number of those known to be on disk */
+	int syncerr;		/* syncing the log failed */
+	int waiters;		/* committers waiting in log_tsync */
+	int flushing;		/* the flusher thread is running */
+	int flushidle;		/* the flusher waits for flushsema */
+	MT_Id flusher;
+	MT_Lock commitlock;	/* protects the counters above */
+	MT_Lock flushlock;	/* keeps log open while the flusher syncs */
+	MT_Sema flushsema;	/* wakes the flusher */
+	MT_Sema syncsema;	/* wakes the waiting committers */
 } logger;
 
 #define BATSIZE 0
@@ -116,6 +137,7 @@ gdk_export int log_delta(logger *lg, BAT *b, char *n);
 
 gdk_export int log_tstart(logger *lg);	/* TODO return transaction id */
 gdk_export int log_tend(logger *lg);
+gdk_export int log_tsync(logger *lg);
 gdk_export int log_abort(logger *lg);
 
 gdk_export int log_sequence(logger *lg, int seq, lng id);
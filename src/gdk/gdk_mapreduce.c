@@ -21,140 +21,439 @@
  * (co)  Martin L. Kersten 
  * This module provide a lightweight map-reduce scheduler for multicore systems.
  * A limited number of workers are initialized upfront, which take the tasks
- * from a central queue. The header of these task descriptors should comply
+ * from their work queues. The header of these task descriptors should comply
  * with the MRtask structure.
  *
+ * The workers are shared by the MAL dataflow interpreter and MRschedule.
+ * Each worker owns a double ended queue.  Tasks pushed by a worker go
+ * to its own queue, from which it takes the most recent one first (LIFO
+ * favors garbage collection and cache reuse).  Tasks pushed by other
+ * threads are spread round robin.  A worker that runs out of work
+ * steals the oldest task from another worker's queue, and only goes to
+ * sleep when no task is queued anywhere.  Every queue has its own lock,
+ * so unless a worker is stealing, the locks are not contended.
+ *
+ * With NUMA placement enabled (gdk_numa), worker i is pinned to node
+ * i modulo the number of nodes, stealing looks at workers on the same
+ * node first, and a task can be pushed to a worker on the node that
+ * holds its data (MRpushnode).
  */
 #include "monetdb_config.h"
 #include "gdk.h"
+#include "gdk_atomic.h"
 #include "gdk_mapreduce.h"
 
-/* each entry in the queue contains a list of tasks */
-typedef struct MRQUEUE {
-	MRtask **tasks;
-	int index;		/* next available task */
-	int size;		/* number of tasks */
-} MRqueue;
+typedef struct {
+	MT_Lock lock;		/* protects the queue */
+	MRtask **data;
+	int first, last;	/* queued tasks are data[first..last) */
+	int size;		/* allocated size of data */
+	MT_Id tid;		/* as returned by MT_create_thread */
+	MT_Id pid;		/* as returned by MT_getpid */
+	int node;		/* NUMA node the worker runs on */
+	/* statistics, only updated by the owner */
+	lng executed;		/* tasks run */
+	lng steals;		/* tasks taken from other queues */
+	lng idle;		/* usec spent waiting for work */
+} MRdeque;
 
-static MRqueue *mrqueue;
-static int mrqsize = -1;	/* size of queue */
-static int mrqlast = -1;
-/* it's a shared resource, so we need locks */
-static MT_Lock mrqlock MT_LOCK_INITIALIZER("mrqlock");
-static MT_Sema mrqsema;		/* threads wait on empty queues */
+static MRdeque *mrdeques;
+static int mrworkers;		/* number of queues */
+static int mrthreads;		/* number of workers started */
+static int mrnodes = 1;		/* number of NUMA nodes used */
+static volatile int mrpending;	/* number of tasks queued */
+static volatile int mrsleeping;	/* number of workers waiting for mrsema */
+static volatile int mrnext;	/* round robin for outside pushes */
+static volatile int mrexiting;
+static MT_Sema mrsema;		/* idle workers wait here */
+static MT_Lock mrlock MT_LOCK_INITIALIZER("mrlock");
+#ifdef ATOMIC_LOCK
+static MT_Lock mrAtomicLock MT_LOCK_INITIALIZER("mrAtomicLock");
+#endif
 
+/* add a task to the owner's end of the queue, or, if front is set, to
+ * the end other workers steal from */
+static int
+MRput(MRdeque *d, MRtask *task, int front)
+{
+	MT_lock_set(&d->lock, "MRput");
+	if (front && d->first > 0) {
+		d->data[--d->first] = task;
+	} else {
+		if (d->last == d->size) {
+			if (d->first > 0) {
+				memmove(d->data, d->data + d->first,
+					(d->last - d->first) * sizeof(MRtask *));
+				d->last -= d->first;
+				d->first = 0;
+			} else {
+				int size = d->size ? d->size << 1 : 256;
+				MRtask **data = GDKrealloc(d->data, size * sizeof(MRtask *));
 
-static void MRworker(void *);
+				if (data == NULL) {
+					MT_lock_unset(&d->lock, "MRput");
+					return -1;
+				}
+				d->data = data;
+				d->size = size;
+			}
+		}
+		if (front) {
+			assert(d->first == 0);
+			memmove(d->data + 1, d->data, d->last * sizeof(MRtask *));
+			d->data[0] = task;
+			d->last++;
+		} else {
+			d->data[d->last++] = task;
+		}
+	}
+	MT_lock_unset(&d->lock, "MRput");
+	return 0;
+}
 
-/* There is just a single queue for the workers */
-static void
-MRqueueCreate(int sz)
+/* take a task from the owner's end (own queue) or the other end
+ * (stealing) */
+static MRtask *
+MRget(MRdeque *d, int steal)
 {
-	int i;
-	MT_Id tid;
+	MRtask *task = NULL;
 
-#ifdef NEED_MT_LOCK_INIT
-	MT_lock_init(&mrqlock, "mrqlock");
-#endif
-	MT_lock_set(&mrqlock, "MRqueueCreate");
-	MT_sema_init(&mrqsema, 0, "mrqsema");
-	if ( mrqueue ) {
-		MT_lock_unset(&mrqlock, "MRqueueCreate");
-		GDKerror("One map-reduce queue allowed");
-		return;
+	MT_lock_set(&d->lock, "MRget");
+	if (d->last > d->first) {
+		task = steal ? d->data[d->first++] : d->data[--d->last];
+		if (d->first == d->last)
+			d->first = d->last = 0;
 	}
-	sz *= 2;
-	mrqueue = (MRqueue *) GDKzalloc(sizeof(MRqueue) * sz);
-	if ( mrqueue == 0) {
-		MT_lock_unset(&mrqlock, "MRqueueCreate");
-		GDKerror("Could not create the map-reduce queue");
-		return;
+	MT_lock_unset(&d->lock, "MRget");
+	return task;
+}
+
+static MRtask *
+MRtake(int self)
+{
+	MRdeque *d = &mrdeques[self], *v;
+	MRtask *task;
+	int i, remote;
+
+	task = MRget(d, 0);
+	/* steal from workers on our own node first */
+	for (remote = 0; task == NULL && remote <= (mrnodes > 1); remote++) {
+		for (i = 1; i < mrworkers; i++) {
+			v = &mrdeques[(self + i) % mrworkers];
+			if ((v->node != d->node) != remote)
+				continue;
+			/* peek without the lock, a miss is caught by
+			 * checking mrpending before going to sleep */
+			if (v->last == v->first)
+				continue;
+			if ((task = MRget(v, 1)) != NULL) {
+				d->steals++;
+				break;
+			}
+		}
 	}
-	mrqsize = sz;
-	mrqlast = 0;
-	/* create a worker thread for each core as specified as system parameter */
-	for (i = 0; i < GDKnr_threads; i++)
-		MT_create_thread(&tid, MRworker, (void *) 0, MT_THR_DETACHED);
-	MT_lock_unset(&mrqlock, "MRqueueCreate");
+	if (task)
+		(void) ATOMIC_DEC_int(mrpending, mrAtomicLock, "MRtake");
+	return task;
 }
 
+/* wake up one sleeping worker, if there is one */
 static void
-MRenqueue(int taskcnt, MRtask ** tasks)
-{
-	assert(taskcnt > 0);
-	MT_lock_set(&mrqlock, "MRenqueue");
-	if (mrqlast == mrqsize) {
-		mrqsize <<= 1;
-		mrqueue = (MRqueue *) GDKrealloc(mrqueue, sizeof(MRqueue) * mrqsize);
-		if ( mrqueue == 0) {
-			MT_lock_unset(&mrqlock, "MRenqueue");
-			GDKerror("Could not enlarge the map-reduce queue");
+MRwakeup(void)
+{
+	int s;
+
+	while ((s = ATOMIC_GET_int(mrsleeping, mrAtomicLock, "MRwakeup")) > 0) {
+		if (ATOMIC_CAS_int(mrsleeping, s, s - 1, mrAtomicLock, "MRwakeup") == s) {
+			MT_sema_up(&mrsema, "MRwakeup");
 			return;
 		}
 	}
-	mrqueue[mrqlast].index = 0;
-	mrqueue[mrqlast].tasks = tasks;
-	mrqueue[mrqlast].size = taskcnt;
-	mrqlast++;
-	MT_lock_unset(&mrqlock, "MRenqueue");
-	/* a task list is added for consumption */
-	while (taskcnt-- > 0)
-		MT_sema_up(&mrqsema, "MRenqueue");
 }
 
-static MRtask *
-MRdequeue(void)
-{
-	MRtask *r = NULL;
-	int idx;
-
-	MT_sema_down(&mrqsema, "MRdequeue");
-	assert(mrqlast);
-	MT_lock_set(&mrqlock, "MRdequeue");
-	if (mrqlast > 0) {
-		idx = mrqueue[mrqlast - 1].index;
-		r = mrqueue[mrqlast - 1].tasks[idx++];
-		if (mrqueue[mrqlast - 1].size == idx)
-			mrqlast--;
-		else
-			mrqueue[mrqlast - 1].index = idx;
+static void
+MRworker(void *arg)
+{
+	MRdeque *d = arg;
+	int self = (int) (d - mrdeques), s;
+	MRtask *task;
+	MT_Sema *sema;
+	Thread thr;
+	lng clk;
+
+	d->pid = MT_getpid();
+	if (mrnodes > 1)
+		MT_numa_run_on_node(d->node);
+	thr = THRnew("MRworker");
+	GDKsetbuf(GDKmalloc(GDKMAXERRLEN)); /* where to leave errors */
+	GDKerrbuf[0] = 0;
+	while (!mrexiting) {
+		if ((task = MRtake(self)) != NULL) {
+			/* the task may be gone once cmd returns, e.g.
+			 * because its owner saw it finish */
+			sema = task->sema;
+			(task->cmd) (task);
+			d->executed++;
+			if (sema)
+				MT_sema_up(sema, "MRworker");
+			continue;
+		}
+		/* nothing to do: announce that we go to sleep, and look
+		 * once more, since a task may have been queued since */
+		clk = GDKusec();
+		(void) ATOMIC_INC_int(mrsleeping, mrAtomicLock, "MRworker");
+		if (ATOMIC_GET_int(mrpending, mrAtomicLock, "MRworker") > 0 || mrexiting) {
+			/* withdraw, unless someone is already waking us */
+			while ((s = ATOMIC_GET_int(mrsleeping, mrAtomicLock, "MRworker")) > 0 &&
+			       ATOMIC_CAS_int(mrsleeping, s, s - 1, mrAtomicLock, "MRworker") != s)
+				;
+			if (s > 0)
+				continue;
+		}
+		MT_sema_down(&mrsema, "MRworker");
+		d->idle += GDKusec() - clk;
+	}
+	GDKfree(GDKerrbuf);
+	GDKsetbuf(0);
+	THRdel(thr);
+}
+
+/* Create the work queues and start a worker for each core as
+ * specified as system parameter */
+gdk_return
+MRinit(void)
+{
+	int i, n;
+
+	if (mrworkers > 0)
+		return GDK_SUCCEED;
+#ifdef NEED_MT_LOCK_INIT
+	{
+		static int initialized = 0;
+		if (initialized++ == 0) {
+			MT_lock_init(&mrlock, "mrlock");
+			ATOMIC_INIT(mrAtomicLock, "mrAtomicLock");
+		}
+	}
+#endif
+	MT_lock_set(&mrlock, "MRinit");
+	if (mrworkers > 0) {
+		MT_lock_unset(&mrlock, "MRinit");
+		return GDK_SUCCEED;
+	}
+	n = GDKnr_threads > 0 ? GDKnr_threads : 1;
+	mrdeques = (MRdeque *) GDKzalloc(sizeof(MRdeque) * n);
+	if (mrdeques == NULL) {
+		MT_lock_unset(&mrlock, "MRinit");
+		GDKerror("MRinit: could not create the work queues\n");
+		return GDK_FAIL;
+	}
+	mrnodes = GDK_numa != GDK_NUMA_OFF ? MIN(MT_numa_nodes(), n) : 1;
+	for (i = 0; i < n; i++) {
+		MT_lock_init(&mrdeques[i].lock, "mrdeque");
+		mrdeques[i].node = i % mrnodes;
+	}
+	MT_sema_init(&mrsema, 0, "mrsema");
+	mrexiting = 0;
+	mrpending = mrsleeping = 0;
+	mrworkers = n;
+	for (i = 0; i < n; i++)
+		if (MT_create_thread(&mrdeques[i].tid, MRworker, &mrdeques[i], MT_THR_JOINABLE) < 0)
+			break;
+	mrthreads = i;
+	if (i == 0) {
+		/* queues without workers are useless */
+		mrworkers = 0;
+		mrnodes = 1;
+		MT_sema_destroy(&mrsema);
+		for (i = 0; i < n; i++)
+			MT_lock_destroy(&mrdeques[i].lock);
+		GDKfree(mrdeques);
+		mrdeques = NULL;
+		MT_lock_unset(&mrlock, "MRinit");
+		GDKerror("MRinit: could not create worker threads\n");
+		return GDK_FAIL;
+	}
+	/* if not all workers started, their queues are emptied by
+	 * stealing */
+	MT_lock_unset(&mrlock, "MRinit");
+	return GDK_SUCCEED;
+}
+
+/* stop the workers and wait for them to finish */
+void
+MRstop(void)
+{
+	int i;
+
+	MT_lock_set(&mrlock, "MRstop");
+	if (mrworkers > 0) {
+		mrexiting = 1;
+		for (i = 0; i < mrthreads; i++)
+			MT_sema_up(&mrsema, "MRstop");
+		for (i = 0; i < mrthreads; i++)
+			MT_join_thread(mrdeques[i].tid);
+		for (i = 0; i < mrworkers; i++) {
+			MT_lock_destroy(&mrdeques[i].lock);
+			GDKfree(mrdeques[i].data);
+		}
+		MT_sema_destroy(&mrsema);
+		GDKfree(mrdeques);
+		mrdeques = NULL;
+		mrworkers = mrthreads = 0;
+		mrnodes = 1;
 	}
-	MT_lock_unset(&mrqlock, "MRdequeue");
-	assert(r);
-	return r;
+	MT_lock_unset(&mrlock, "MRstop");
+}
+
+/* the queue number of the calling worker, or -1 for other threads */
+int
+MRworkerid(void)
+{
+	MT_Id pid = MT_getpid();
+	int i;
+
+	for (i = 0; i < mrworkers; i++)
+		if (mrdeques[i].pid == pid)
+			return i;
+	return -1;
 }
 
 static void
-MRworker(void *arg)
+MRenqueue(MRtask *task, int front, int node)
 {
-	MRtask *task;
-	(void) arg;
-	do {
-		task = MRdequeue();
+	int w;
+	MT_Sema *sema;
+
+	assert(task);
+	assert(mrworkers > 0);
+	w = MRworkerid();
+	if (mrnodes > 1 && node >= 0 && (w < 0 || mrdeques[w].node != node % mrnodes)) {
+		/* one of the workers of that node, round robin;
+		 * worker i runs on node i % mrnodes */
+		node %= mrnodes;
+		w = (mrworkers - node + mrnodes - 1) / mrnodes;
+		w = node + mrnodes * (int) ((unsigned int) ATOMIC_INC_int(mrnext, mrAtomicLock, "MRenqueue") % (unsigned int) w);
+	} else if (w < 0)
+		w = (int) ((unsigned int) ATOMIC_INC_int(mrnext, mrAtomicLock, "MRenqueue") % (unsigned int) mrworkers);
+	if (MRput(&mrdeques[w], task, front) < 0) {
+		/* no room in the queue: do it ourselves */
+		sema = task->sema;
 		(task->cmd) (task);
-		MT_sema_up(task->sema, "MRworker");
-	} while (1);
+		if (sema)
+			MT_sema_up(sema, "MRenqueue");
+		return;
+	}
+	(void) ATOMIC_INC_int(mrpending, mrAtomicLock, "MRenqueue");
+	MRwakeup();
+}
+
+/* hand a task to the workers */
+void
+MRpush(MRtask *task)
+{
+	MRenqueue(task, 0, -1);
+}
+
+/* hand a task to a worker on the given NUMA node (-1: don't care) */
+void
+MRpushnode(MRtask *task, int node)
+{
+	MRenqueue(task, 0, node);
+}
+
+/* hand a task back to the workers, behind all others queued by this
+ * thread, e.g. when it could not be run yet */
+void
+MRrequeue(MRtask *task)
+{
+	MRenqueue(task, 1, -1);
+}
+
+/* the number of tasks waiting for a worker */
+int
+MRpending(void)
+{
+	return ATOMIC_GET_int(mrpending, mrAtomicLock, "MRpending");
+}
+
+int
+MRnrworkers(void)
+{
+	return mrworkers;
+}
+
+/* the number of NUMA nodes the workers are spread over */
+int
+MRnrnodes(void)
+{
+	return mrnodes;
+}
+
+/* the statistics of one worker, as far as they are known */
+void
+MRstatistics(int w, MRstat *st)
+{
+	MRdeque *d;
+
+	memset(st, 0, sizeof(*st));
+	if (w < 0 || w >= mrworkers)
+		return;
+	d = &mrdeques[w];
+	st->executed = d->executed;
+	st->steals = d->steals;
+	st->idle = d->idle;
+	st->depth = d->last - d->first;
 }
 
 /* schedule the tasks and return when all are done */
 void
 MRschedule(int taskcnt, void **arg, void (*cmd) (void *p))
 {
-	int i;
+	int i, self, done = 0;
 	MT_Sema sema;
-	MRtask **task = (MRtask **) arg;
+	MRtask **task = (MRtask **) arg, *t;
 
-	if (mrqueue == 0)
-		MRqueueCreate(1024);
+	if (MRinit() != GDK_SUCCEED) {
+		/* no workers: do it ourselves */
+		for (i = 0; i < taskcnt; i++)
+			(*cmd) (task[i]);
+		return;
+	}
 
 	MT_sema_init(&sema, 0, "sema");
 	for (i = 0; i < taskcnt; i++) {
 		task[i]->sema = &sema;
 		task[i]->cmd = cmd;
 	}
-	MRenqueue(taskcnt, task);
-	/* waiting for all report result */
 	for (i = 0; i < taskcnt; i++)
+		MRpush(task[i]);
+	if ((self = MRworkerid()) >= 0) {
+		/* a worker must not just wait, the tasks would compete
+		 * for one worker less; run our own tasks until the
+		 * rest has been stolen */
+		while ((t = MRget(&mrdeques[self], 0)) != NULL) {
+			if (t->sema != &sema) {
+				/* not ours, put it back */
+				if (MRput(&mrdeques[self], t, 0) < 0) {
+					MT_Sema *s = t->sema;
+
+					(t->cmd) (t);
+					if (s)
+						MT_sema_up(s, "MRschedule");
+					(void) ATOMIC_DEC_int(mrpending, mrAtomicLock, "MRschedule");
+				}
+				MRwakeup();
+				break;
+			}
+			(void) ATOMIC_DEC_int(mrpending, mrAtomicLock, "MRschedule");
+			(t->cmd) (t);
+			mrdeques[self].executed++;
+			done++;
+		}
+	}
+	/* waiting for all report result */
+	for (i = done; i < taskcnt; i++)
 		MT_sema_down(&sema, "MRschedule");
 	MT_sema_destroy(&sema);
 }
@@ -25,6 +25,23 @@ typedef struct {
 	void (*cmd) (void *);		/* the function to be executed */
 } MRtask;
 
+typedef struct {
+	lng executed;			/* tasks run */
+	lng steals;			/* tasks taken from other workers */
+	lng idle;			/* usec spent waiting for work */
+	int depth;			/* tasks in the worker's queue */
+} MRstat;
+
+gdk_export gdk_return MRinit(void);
+gdk_export void MRstop(void);
+gdk_export void MRpush(MRtask *task);
+gdk_export void MRpushnode(MRtask *task, int node);
+gdk_export void MRrequeue(MRtask *task);
+gdk_export int MRpending(void);
+gdk_export int MRworkerid(void);
+gdk_export int MRnrworkers(void);
+gdk_export int MRnrnodes(void);
+gdk_export void MRstatistics(int w, MRstat *st);
 gdk_export void MRschedule(int taskcnt, void **arg, void (*cmd) (void *p));
 
 #endif /* _GDK_MAPREDUCE_H_ */
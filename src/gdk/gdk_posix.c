@@ -1028,3 +1028,83 @@ MT_sleep_ms(unsigned int ms)
 }
 
 #endif
+
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#include <numaif.h>
+
+static int MT_numa_nnodes = 0;
+
+int
+MT_numa_nodes(void)
+{
+	if (MT_numa_nnodes == 0)
+		MT_numa_nnodes = numa_available() < 0 ? 1 : numa_max_node() + 1;
+	return MT_numa_nnodes;
+}
+
+/* the node on which the page holding p lives, -1 if not known (yet) */
+int
+MT_numa_node_of(const void *p)
+{
+	int node = -1;
+
+	if (p == NULL || MT_numa_nodes() <= 1)
+		return -1;
+	if (get_mempolicy(&node, NULL, 0, (void *) p, MPOL_F_NODE | MPOL_F_ADDR) < 0)
+		return -1;
+	return node;
+}
+
+void
+MT_numa_run_on_node(int node)
+{
+	if (MT_numa_nodes() > 1 && node >= 0)
+		(void) numa_run_on_node(node % MT_numa_nodes());
+}
+
+/* spread the pages of [p,p+len) over all nodes; only pages that have
+ * not been touched yet are affected */
+void
+MT_numa_interleave(void *p, size_t len)
+{
+	size_t pg = (size_t) MT_pagesize();
+	char *lo, *hi;
+
+	if (p == NULL || MT_numa_nodes() <= 1)
+		return;
+	lo = (char *) (((size_t) p + pg - 1) & ~(pg - 1));
+	hi = (char *) (((size_t) p + len) & ~(pg - 1));
+	if (lo < hi)
+		numa_interleave_memory(lo, (size_t) (hi - lo), numa_all_nodes_ptr);
+}
+
+#else
+
+int
+MT_numa_nodes(void)
+{
+	return 1;
+}
+
+int
+MT_numa_node_of(const void *p)
+{
+	(void) p;
+	return -1;
+}
+
+void
+MT_numa_run_on_node(int node)
+{
+	(void) node;
+}
+
+void
+MT_numa_interleave(void *p, size_t len)
+{
+	(void) p;
+	(void) len;
+}
+
+#endif
@@ -199,6 +199,13 @@ gdk_export int MT_munmap(void *p, size_t len);
 
 gdk_export int MT_path_absolute(const char *path);
 
+/* NUMA support; without libnuma there is a single node and these
+ * are no-ops */
+gdk_export int MT_numa_nodes(void);
+gdk_export int MT_numa_node_of(const void *p);
+gdk_export void MT_numa_run_on_node(int node);
+gdk_export void MT_numa_interleave(void *p, size_t len);
+
 
 /*
  * @+ Posix under WIN32
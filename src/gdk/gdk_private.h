@@ -60,21 +60,26 @@ void *GDKmallocmax(size_t size, size_t *maxsize, int emergency);
 int GDKmove(const char *dir1, const char *nme1, const char *ext1, const char *dir2, const char *nme2, const char *ext2);
 int GDKmunmap(void *addr, size_t len);
 void *GDKreallocmax(void *pold, size_t size, size_t *maxsize, int emergency);
+int GDKpsort(void *h, void *t, const void *base, size_t n, int hs, int ts, int tpe, int reverse, int stable);
 int GDKremovedir(const char *nme);
 int GDKsave(const char *nme, const char *ext, void *buf, size_t size, storage_t mode);
 int GDKssort_rev(void *h, void *t, const void *base, size_t n, int hs, int ts, int tpe);
 int GDKssort(void *h, void *t, const void *base, size_t n, int hs, int ts, int tpe);
 int GDKunlink(const char *dir, const char *nme, const char *extension);
+void HASHfree(BAT *b);
 int HASHgonebad(BAT *b, const void *v);
+int HASHgrow(Hash *h, BUN cap);
 BUN HASHmask(BUN cnt);
 Hash *HASHnew(Heap *hp, int tpe, BUN size, BUN mask);
 void HASHremove(BAT *b);
+int HASHsave(BAT *b);
 int HEAPalloc(Heap *h, size_t nitems, size_t itemsize);
 void HEAPcacheInit(void);
 int HEAP_check(Heap *h, HeapRepair *hr);
 int HEAPdelete(Heap *h, const char *o, const char *ext);
 void HEAP_init(Heap *heap, int tpe);
 int HEAPload(Heap *h, const char *nme, const char *ext, int trunc);
+int HEAPloadindex(Heap *h, const char *nme, const char *ext);
 int HEAP_mmappable(Heap *heap);
 int HEAPsave(Heap *h, const char *nme, const char *ext);
 int HEAPwarm(Heap *h);
@@ -94,8 +99,17 @@ var_t strLocate(Heap *h, const char *v);
 void VIEWdestroy(BAT *b);
 BAT *VIEWreset(BAT *b);
 int IMPSgetbin(int tpe, bte bits, char *bins, const void *v);
+lng IMPSstrkey(const char *v);
+void IMPSappend(BAT *b, BUN first);
+void IMPSfree(BAT *b);
 void IMPSremove(BAT *b);
+int IMPSsave(BAT *b);
 void IMPSprint(BAT *b);
+void CMPfree(BAT *b);
+int CMPsave(BAT *b);
+int CMPselectable(BAT *b, const void *tl, const void *th, int li, int hi, int equi, int lval, int hval, lng *clo, lng *chi);
+int CMPselect(BAT *b, BAT *bn, BUN start, BUN end, lng lo, lng hi);
+int CMPsum(BAT *b, BUN start, BUN end, lng *sum, BUN *nils);
 
 #define BBP_BATMASK	511
 #define BBP_THREADMASK	63
@@ -104,6 +118,7 @@ typedef struct {
 	MT_Lock swap;
 	MT_Lock hash;
 	MT_Lock imprints;
+	MT_Lock compress;
 } batlock_t;
 
 typedef struct {
@@ -130,6 +145,7 @@ extern MT_Lock MT_system_lock;
 #define GDKswapLock(x)  GDKbatLock[(x)&BBP_BATMASK].swap
 #define GDKhashLock(x)  GDKbatLock[(x)&BBP_BATMASK].hash
 #define GDKimprintsLock(x)  GDKbatLock[(x)&BBP_BATMASK].imprints
+#define GDKcompressLock(x)  GDKbatLock[(x)&BBP_BATMASK].compress
 #define GDKtrimLock(y)  GDKbbpLock[(y)&BBP_THREADMASK].trim
 #define GDKcacheLock(y) GDKbbpLock[(y)&BBP_THREADMASK].alloc
 #define BBP_free(y)	GDKbbpLock[(y)&BBP_THREADMASK].free
@@ -0,0 +1,269 @@
+/*
+ * The contents of this file are subject to the MonetDB Public License
+ * Version 1.1 (the "License"); you may not use this file except in
+ * compliance with the License. You may obtain a copy of the License at
+ * http://www.monetdb.org/Legal/MonetDBLicense
+ *
+ * Software distributed under the License is distributed on an "AS IS"
+ * basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+ * License for the specific language governing rights and limitations
+ * under the License.
+ *
+ * The Original Code is the MonetDB Database System.
+ *
+ * The Initial Developer of the Original Code is CWI.
+ * Portions created by CWI are Copyright (C) 1997-July 2008 CWI.
+ * Copyright August 2008-2013 MonetDB B.V.
+ * All Rights Reserved.
+ */
+
+/*
+ * Parallel sort.  The array is cut into one run per thread, the runs
+ * are sorted concurrently with GDKqsort or GDKssort, and the runs are
+ * then merged pairwise.  Each merge round is spread over all threads
+ * by cutting the output along merge paths, so no round is
+ * single-threaded.  On ties the left run goes first, which keeps a
+ * stable sort stable.  The interface is that of GDKssort, plus the
+ * reverse and stable flags.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_mapreduce.h"
+
+typedef struct {
+	MRtask task;		/* scheduler header, must be first */
+	/* the arrays to sort and where to merge them to */
+	char *sh, *st;
+	char *dh, *dt;
+	const char *base;
+	int hs, ts, tpe;
+	int reverse, stable;
+	int (*cmp)(const void *, const void *);
+	/* sort: the run [alo,ahi); merge: runs [alo,ahi) and
+	 * [blo,bhi) of the source go to dlo in the destination */
+	size_t alo, ahi, blo, bhi, dlo;
+	int error;
+} psorttask;
+
+#define VAL(t, a, i)	((t)->base ?					\
+			 (const void *) ((t)->base + VarHeapVal(a, i, (t)->hs)) : \
+			 (const void *) ((a) + (i) * (t)->hs))
+
+/* compare element i of the left run with element j of the right run */
+static inline int
+psort_cmp(const psorttask *t, size_t i, size_t j)
+{
+	int c = (*t->cmp)(VAL(t, t->sh, i), VAL(t, t->sh, j));
+
+	return t->reverse ? -c : c;
+}
+
+static void
+psort_run(void *arg)
+{
+	psorttask *t = arg;
+	void *h = t->sh + t->alo * t->hs;
+	void *tl = t->ts ? t->st + t->alo * t->ts : NULL;
+	size_t n = t->ahi - t->alo;
+
+	if (t->stable) {
+		if ((t->reverse ?
+		     GDKssort_rev(h, tl, t->base, n, t->hs, t->ts, t->tpe) :
+		     GDKssort(h, tl, t->base, n, t->hs, t->ts, t->tpe)) < 0)
+			t->error = 1;
+	} else if (t->reverse) {
+		GDKqsort_rev(h, tl, t->base, n, t->hs, t->ts, t->tpe);
+	} else {
+		GDKqsort(h, tl, t->base, n, t->hs, t->ts, t->tpe);
+	}
+}
+
+static void
+psort_merge(void *arg)
+{
+	psorttask *t = arg;
+	size_t i = t->alo, j = t->blo, d = t->dlo, hs = t->hs, ts = t->ts;
+
+	while (i < t->ahi && j < t->bhi) {
+		if (psort_cmp(t, i, j) <= 0) {
+			memcpy(t->dh + d * hs, t->sh + i * hs, hs);
+			if (ts)
+				memcpy(t->dt + d * ts, t->st + i * ts, ts);
+			i++;
+		} else {
+			memcpy(t->dh + d * hs, t->sh + j * hs, hs);
+			if (ts)
+				memcpy(t->dt + d * ts, t->st + j * ts, ts);
+			j++;
+		}
+		d++;
+	}
+	if (i < t->ahi) {
+		memcpy(t->dh + d * hs, t->sh + i * hs, (t->ahi - i) * hs);
+		if (ts)
+			memcpy(t->dt + d * ts, t->st + i * ts, (t->ahi - i) * ts);
+	} else if (j < t->bhi) {
+		memcpy(t->dh + d * hs, t->sh + j * hs, (t->bhi - j) * hs);
+		if (ts)
+			memcpy(t->dt + d * ts, t->st + j * ts, (t->bhi - j) * ts);
+	}
+}
+
+/* the number of elements of run [alo,ahi) among the first d
+ * elements of its merge with run [blo,bhi) */
+static size_t
+psort_path(const psorttask *t, size_t alo, size_t ahi, size_t blo,
+	   size_t bhi, size_t d)
+{
+	size_t lo = d > bhi - blo ? d - (bhi - blo) : 0;
+	size_t hi = MIN(d, ahi - alo);
+
+	while (lo < hi) {
+		size_t mid = (lo + hi) / 2;
+
+		if (psort_cmp(t, alo + mid, blo + d - mid - 1) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* run fcn on all tasks on the shared workers */
+static void
+psort_exec(void (*fcn)(void *), psorttask *tasks, int ntasks)
+{
+	void **args = GDKmalloc(ntasks * sizeof(void *));
+	int i;
+
+	if (args == NULL) {
+		/* just do it ourselves */
+		for (i = 0; i < ntasks; i++)
+			(*fcn)(&tasks[i]);
+		return;
+	}
+	for (i = 0; i < ntasks; i++)
+		args[i] = &tasks[i];
+	MRschedule(ntasks, args, fcn);
+	GDKfree(args);
+}
+
+int
+GDKpsort(void *h, void *t, const void *base, size_t n, int hs, int ts,
+	 int tpe, int reverse, int stable)
+{
+	int nthreads = GDKnr_threads, nruns, ntasks, i, r;
+	size_t *bnd = NULL;
+	psorttask proto, *tasks = NULL;
+	char *hb = NULL, *tb = NULL;
+
+	assert(hs > 0);
+	assert(ts >= 0);
+	assert(tpe != TYPE_void);
+
+	if (nthreads <= 1 || n < (size_t) nthreads * 2)
+		return -1;
+	if ((bnd = GDKmalloc((nthreads + 1) * sizeof(size_t))) == NULL ||
+	    (tasks = GDKmalloc(2 * nthreads * sizeof(psorttask))) == NULL ||
+	    (hb = GDKmalloc(n * hs)) == NULL ||
+	    (ts && (tb = GDKmalloc(n * ts)) == NULL))
+		goto bailout;
+	ALGODEBUG fprintf(stderr, "#GDKpsort(n=" SZFMT ",reverse=%d,"
+			  "stable=%d): %d threads\n", n, reverse, stable,
+			  nthreads);
+
+	memset(&proto, 0, sizeof(proto));
+	proto.sh = h;
+	proto.st = t;
+	proto.dh = hb;
+	proto.dt = tb;
+	proto.base = base;
+	proto.hs = hs;
+	proto.ts = ts;
+	proto.tpe = tpe;
+	proto.reverse = reverse;
+	proto.stable = stable;
+	proto.cmp = BATatoms[tpe].atomCmp;
+
+	/* sort one run per thread */
+	nruns = nthreads;
+	for (i = 0; i <= nruns; i++)
+		bnd[i] = n / nruns * i + MIN((size_t) i, n % nruns);
+	for (i = 0; i < nruns; i++) {
+		tasks[i] = proto;
+		tasks[i].alo = bnd[i];
+		tasks[i].ahi = bnd[i + 1];
+	}
+	psort_exec(psort_run, tasks, nruns);
+	for (i = 0; i < nruns; i++)
+		if (tasks[i].error)
+			goto bailout;
+
+	/* merge pairs of runs until one is left */
+	while (nruns > 1) {
+		ntasks = 0;
+		for (r = 0; r + 1 < nruns; r += 2) {
+			size_t alo = bnd[r], mid = bnd[r + 1], bhi = bnd[r + 2];
+			/* share of the threads for this pair */
+			int k, nseg = (int) (((bhi - alo) * nthreads + n - 1) / n);
+			size_t pa = 0, pd = 0;
+
+			if (nseg < 1)
+				nseg = 1;
+			for (k = 1; k <= nseg; k++) {
+				size_t d = (bhi - alo) * k / nseg;
+				size_t a = k == nseg ? mid - alo :
+					psort_path(&proto, alo, mid, mid, bhi, d);
+
+				tasks[ntasks] = proto;
+				tasks[ntasks].alo = alo + pa;
+				tasks[ntasks].ahi = alo + a;
+				tasks[ntasks].blo = mid + pd - pa;
+				tasks[ntasks].bhi = mid + d - a;
+				tasks[ntasks].dlo = alo + pd;
+				ntasks++;
+				pa = a;
+				pd = d;
+			}
+		}
+		if (nruns & 1) {
+			/* the odd run out is copied as is */
+			tasks[ntasks] = proto;
+			tasks[ntasks].alo = bnd[nruns - 1];
+			tasks[ntasks].ahi = bnd[nruns];
+			tasks[ntasks].blo = tasks[ntasks].bhi = bnd[nruns];
+			tasks[ntasks].dlo = bnd[nruns - 1];
+			ntasks++;
+		}
+		assert(ntasks <= 2 * nthreads);
+		psort_exec(psort_merge, tasks, ntasks);
+		for (r = 0; 2 * r < nruns; r++)
+			bnd[r] = bnd[2 * r];
+		bnd[r] = n;
+		nruns = r;
+		/* the merged runs are the source of the next round */
+		proto.sh = proto.dh;
+		proto.st = proto.dt;
+		proto.dh = proto.sh == hb ? h : hb;
+		proto.dt = proto.st == tb ? t : tb;
+	}
+	if (proto.sh != h) {
+		memcpy(h, hb, n * hs);
+		if (ts)
+			memcpy(t, tb, n * ts);
+	}
+	GDKfree(bnd);
+	GDKfree(tasks);
+	GDKfree(hb);
+	GDKfree(tb);
+	return 0;
+
+  bailout:
+	GDKfree(bnd);
+	GDKfree(tasks);
+	GDKfree(hb);
+	GDKfree(tb);
+	return -1;
+}
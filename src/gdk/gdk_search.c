@@ -127,18 +127,13 @@ HASHclear(Hash *h)
 		(void) HASHput(h,i,nil);
 }
 
-Hash *
-HASHnew(Heap *hp, int tpe, BUN size, BUN mask)
+/* set up the administration of hash table h with size links and mask
+ * buckets, stored in hp */
+static void
+HASHinit(Hash *h, Heap *hp, int tpe, BUN size, BUN mask)
 {
-	Hash *h = NULL;
 	int width = HASHwidth(size);
 
-	if (HEAPalloc(hp, mask + size, width) < 0)
-		return NULL;
-	hp->free = (mask + size) * width;
-	h = (Hash *) GDKmalloc(sizeof(Hash));
-	if (!h)
-		return h;
 	h->lim = size;
 	h->mask = mask - 1;
 	h->width = width;
@@ -164,6 +159,21 @@ HASHnew(Heap *hp, int tpe, BUN size, BUN mask)
 	h->Hash = (void *) ((char *) h->Link + h->lim * width);
 	h->type = tpe;
 	h->heap = hp;
+}
+
+Hash *
+HASHnew(Heap *hp, int tpe, BUN size, BUN mask)
+{
+	Hash *h = NULL;
+	int width = HASHwidth(size);
+
+	if (HEAPalloc(hp, mask + size, width) < 0)
+		return NULL;
+	hp->free = (mask + size) * width;
+	h = (Hash *) GDKmalloc(sizeof(Hash));
+	if (!h)
+		return h;
+	HASHinit(h, hp, tpe, size, mask);
 	HASHclear(h);		/* zero the mask */
 	ALGODEBUG fprintf(stderr, "#HASHnew: create hash(size " BUNFMT ", mask " BUNFMT ",width %d, nil "BUNFMT ", total "BUNFMT " bytes);\n", size, mask, width, h->nil, (size+mask) * width);
 	return h;
@@ -213,6 +223,139 @@ static void HASHcollisions(BAT *b, Hash *h)
 	fprintf(stderr, "#BAThash: statistics (" BUNFMT ", entries " LLFMT", mask " BUNFMT", max " LLFMT ", avg %2.6f);\n", BATcount(b), entries, h->mask, max, total/entries);
 }
 
+/*
+ * @- Persistent hash tables
+ * The hash table of a persistent bat is saved next to the bat (files
+ * hhash/thash) when the bat is saved, or as soon as it is built on a
+ * bat that is clean on disk.  A footer at the end of the file records
+ * the extent of the bat it covers; a saved hash table is only used if
+ * it matches the bat as loaded.  These hash tables live in malloced or
+ * privately mapped memory, so that updates never reach the saved
+ * image before the bat itself is saved.  A bat that is saved without
+ * its hash table in memory loses the saved image, since in-place
+ * updates leave the extent in the footer unchanged.
+ */
+#define HASH_MAGIC	((BUN) 0x48415348)	/* "HASH" */
+#define HASHext(b)	((b)->batCacheid > 0 ? "hhash" : "thash")
+
+typedef struct {
+	BUN magic;
+	BUN first;		/* BUNfirst of the bat */
+	BUN last;		/* BUNlast of the bat */
+	BUN lim;		/* number of links */
+	BUN mask;		/* mask of the buckets */
+} HashFooter;
+
+int
+HASHsave(BAT *b)
+{
+	Hash *h = b->H->hash;
+	str nme = BBP_physical(b->batCacheid);
+	HashFooter f;
+	Heap *hp;
+	size_t free;
+	int ret;
+
+	if (VIEWhparent(b) || b->batPersistence != PERSISTENT)
+		return 0;
+	if (h == NULL || h == (Hash *) -1 || h->heap->storage == STORE_MMAP) {
+		/* the bat is saved without this hash table (a
+		 * shared-mmapped one is updated in place, so it is
+		 * never saved), so an image saved with an earlier
+		 * version of the bat is stale now: the footer cannot
+		 * tell in-place updates apart */
+		return GDKunlink(BATDIR, nme, HASHext(b));
+	}
+	hp = h->heap;
+	free = hp->free;
+	if (HEAPextend(hp, free + sizeof(f)) < 0)
+		return -1;
+	h->Link = (void *) hp->base;
+	h->Hash = (void *) ((char *) h->Link + h->lim * h->width);
+	f.magic = HASH_MAGIC;
+	f.first = BUNfirst(b);
+	f.last = BUNlast(b);
+	f.lim = h->lim;
+	f.mask = h->mask;
+	memcpy(hp->base + free, &f, sizeof(f));
+	hp->free = free + sizeof(f);
+	ret = HEAPsave(hp, nme, HASHext(b));
+	hp->free = free;
+	ALGODEBUG fprintf(stderr, "#HASHsave(%s): saved " BUNFMT " links = %d\n", BATgetId(b), h->lim, ret);
+	if (ret < 0)
+		GDKunlink(BATDIR, nme, HASHext(b));
+	return ret;
+}
+
+/* load the saved hash table of b, if it is still valid */
+static Hash *
+HASHload(BAT *b)
+{
+	str nme = BBP_physical(b->batCacheid);
+	HashFooter f;
+	Heap *hp;
+	Hash *h;
+
+	if (b->batPersistence != PERSISTENT || BATdirty(b))
+		return NULL;
+	if ((hp = (Heap *) GDKzalloc(sizeof(Heap))) == NULL)
+		return NULL;
+	if (HEAPloadindex(hp, nme, HASHext(b)) < 0) {
+		GDKfree(hp->filename);
+		GDKfree(hp);
+		return NULL;
+	}
+	if (hp->free < sizeof(f))
+		goto bailout;
+	memcpy(&f, hp->base + hp->free - sizeof(f), sizeof(f));
+	if (f.magic != HASH_MAGIC ||
+	    f.first != BUNfirst(b) ||
+	    f.last != BUNlast(b) ||
+	    (f.lim + f.mask + 1) * HASHwidth(f.lim) + sizeof(f) != hp->free ||
+	    (h = (Hash *) GDKmalloc(sizeof(Hash))) == NULL)
+		goto bailout;
+	hp->free -= sizeof(f);
+	HASHinit(h, hp, ATOMtype(b->htype), f.lim, f.mask + 1);
+	if (HASHgrow(h, BATcapacity(b)) < 0) {
+		GDKfree(h);
+		goto bailout;
+	}
+	ALGODEBUG fprintf(stderr, "#HASHload(%s): loaded " BUNFMT " links\n", BATgetId(b), h->lim);
+	return h;
+
+  bailout:
+	/* stale or damaged: throw it away */
+	ALGODEBUG fprintf(stderr, "#HASHload(%s): discarded saved hash\n", BATgetId(b));
+	HEAPdelete(hp, nme, HASHext(b));
+	GDKfree(hp);
+	return NULL;
+}
+
+/*
+ * Grow the links of hash table h to cap entries, moving the buckets
+ * up.  This keeps a hash table in use when its bat is extended.
+ */
+int
+HASHgrow(Hash *h, BUN cap)
+{
+	Heap *hp = h->heap;
+	size_t len = (size_t) (h->mask + 1) * h->width;
+
+	if (cap <= h->lim)
+		return 0;
+	if (HASHwidth(cap) != h->width)
+		return -1;	/* would need wider links */
+	if (HEAPextend(hp, ((size_t) cap + h->mask + 1) * h->width) < 0)
+		return -1;
+	memmove(hp->base + (size_t) cap * h->width,
+		hp->base + (size_t) h->lim * h->width, len);
+	h->lim = cap;
+	h->Link = (void *) hp->base;
+	h->Hash = (void *) ((char *) h->Link + h->lim * h->width);
+	hp->free = (size_t) (cap + h->mask + 1) * h->width;
+	return 0;
+}
+
 /*
  * The prime routine for the BAT layer is to create a new hash index.
  * Its argument is the element type and the maximum number of BUNs be
@@ -237,6 +380,8 @@ BAThash(BAT *b, BUN masksize)
 		}
 	}
 	MT_lock_set(&GDKhashLock(ABS(b->batCacheid)), "BAThash");
+	if (b->H->hash == NULL)
+		b->H->hash = HASHload(b);
 	if (b->H->hash == NULL) {
 		unsigned int tpe = ATOMstorage(b->htype);
 		BUN cnt = BATcount(b);
@@ -246,6 +391,8 @@ BAThash(BAT *b, BUN masksize)
 		Heap *hp = NULL;
 		str nme = BBP_physical(b->batCacheid);
 		BATiter bi = bat_iterator(b);
+		char *fnme;
+		int persist = b->batPersistence == PERSISTENT && !VIEWhparent(b);
 
 		ALGODEBUG fprintf(stderr, "#BAThash: create hash(" BUNFMT ");\n", BATcount(b));
 		/* cnt = 0, hopefully there is a proper capacity from
@@ -305,17 +452,23 @@ BAThash(BAT *b, BUN masksize)
 			if (hp &&
 			    (hp->filename = GDKmalloc(strlen(nme) + 12)) != NULL)
 				sprintf(hp->filename, "%s.%chash", nme, b->batCacheid > 0 ? 'h' : 't');
+			/* the hash of a persistent bat is kept off the
+			 * file system until it is saved */
+			fnme = hp ? hp->filename : NULL;
+			if (hp && persist)
+				hp->filename = NULL;
 			if (hp == NULL ||
-			    hp->filename == NULL ||
+			    fnme == NULL ||
 			    (h = HASHnew(hp, ATOMtype(b->htype), BATcapacity(b), mask)) == NULL) {
 
 				MT_lock_unset(&GDKhashLock(ABS(b->batCacheid)), "BAThash");
 				if (hp != NULL) {
-					GDKfree(hp->filename);
+					GDKfree(fnme);
 					GDKfree(hp);
 				}
 				return NULL;
 			}
+			hp->filename = fnme;
 
 			switch (tpe) {
 			case TYPE_bte:
@@ -375,6 +528,9 @@ BAThash(BAT *b, BUN masksize)
 			break;
 		}
 		b->H->hash = h;
+		/* a clean bat on disk can have its hash saved now */
+		if (persist && !BATdirty(b))
+			(void) HASHsave(b);
 		t1 = GDKusec();
 		ALGODEBUG 
 				fprintf(stderr, "#BAThash: hash construction "LLFMT" usec\n", t1-t0);
@@ -423,8 +579,8 @@ HASHlist(Hash *h, BUN i)
 	return c;
 }
 
-void
-HASHremove(BAT *b)
+static void
+HASHdrop(BAT *b, int keepfile)
 {
 	if (b && b->H->hash) {
 		bat p = VIEWhparent(b);
@@ -434,17 +590,35 @@ HASHremove(BAT *b)
 			hp = BBP_cache(p);
 
 		if ((!hp || b->H->hash != hp->H->hash) && b->H->hash != (Hash *) -1) {
-			if (b->H->hash->heap->storage != STORE_MEM)
-				HEAPdelete(b->H->hash->heap, BBP_physical(b->batCacheid), (b->batCacheid > 0) ? "hhash" : "thash");
+			Heap *heap = b->H->hash->heap;
+
+			if (heap->storage == STORE_MMAP ||
+			    (!keepfile && (heap->storage != STORE_MEM ||
+					   b->batPersistence == PERSISTENT)))
+				HEAPdelete(heap, BBP_physical(b->batCacheid), HASHext(b));
 			else
-				HEAPfree(b->H->hash->heap);
-			GDKfree(b->H->hash->heap);
+				HEAPfree(heap);
+			GDKfree(heap);
 			GDKfree(b->H->hash);
 		}
 		b->H->hash = NULL;
 	}
 }
 
+/* release the hash table of b, but keep a saved image */
+void
+HASHfree(BAT *b)
+{
+	HASHdrop(b, 1);
+}
+
+/* throw away the hash table of b, including a saved image */
+void
+HASHremove(BAT *b)
+{
+	HASHdrop(b, 0);
+}
+
 void
 HASHdestroy(BAT *b)
 {
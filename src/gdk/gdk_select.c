@@ -525,9 +525,70 @@ fullscan_any(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 
 	(void) candlist;
 	(void) maximum;
-	(void) use_imprints;
 
-	if (equi) {
+	if (use_imprints) {
+		/* string range select on the prefix imprints: only
+		 * the cache lines whose imprint shares a bin with the
+		 * range of prefix keys are compared; a view uses
+		 * those of its parent */
+		Imprints *imprints;
+		cchdc_t *d;
+		BUN rpp = IMPS_PAGE >> b->T->shift;
+		BUN dcnt, icnt, i, j, pr_off = 0;
+		uint64_t mask = 0, vec = 0;
+		int bin, lbin, hbin;
+
+		if (VIEWtparent(b)) {
+			BAT *parent = BATmirror(BATdescriptor(VIEWtparent(b)));
+			imprints = parent->T->imprints;
+			pr_off = (BUN) ((Tloc(b, 0) - Tloc(parent, 0)) >> b->T->shift) + BUNfirst(parent);
+			BBPunfix(parent->batCacheid);
+		} else {
+			imprints = b->T->imprints;
+		}
+		d = (cchdc_t *) imprints->dict->base;
+		assert(ATOMstorage(b->ttype) == TYPE_str);
+		assert(!equi && !anti);
+		lbin = lval ? IMPSgetbin(TYPE_str, imprints->bits,
+					 imprints->bins->base, tl) : 0;
+		hbin = hval ? IMPSgetbin(TYPE_str, imprints->bits,
+					 imprints->bins->base, th) :
+			imprints->bits - 1;
+		for (bin = lbin; bin <= hbin; bin++)
+			mask |= (uint64_t) 1 << bin;
+		ALGODEBUG fprintf(stderr,
+				  "#BATsubselect(b=%s#"BUNFMT",s=%s,anti=%d): "
+				  "imprints select range\n", BATgetId(b),
+				  BATcount(b), s ? BATgetId(s) : "NULL", anti);
+		/* i runs over the rows of the imprinted bat, p over b */
+		for (dcnt = 0, icnt = 0, i = 0;
+		     dcnt < imprints->dictcnt && i < q + pr_off;
+		     dcnt++) {
+			for (j = 0; j < d[dcnt].cnt && i < q + pr_off; j++, i += rpp) {
+				if (j == 0 || !d[dcnt].repeat)
+					vec = IMPSvector(imprints, icnt++);
+				if (i + rpp <= r + pr_off || (vec & mask) == 0)
+					continue;
+				for (p = MAX(i, r + pr_off) - pr_off;
+				     p + pr_off < i + rpp && p < q;
+				     p++) {
+					o = p + off;
+					v = BUNtail(bi,p);
+					buninsfix(bn, T, dst, cnt, oid, o,
+						  (BUN) ((dbl) cnt / (dbl) (p-r+1)
+							 * (dbl) (q-p) * 1.1 + 1024),
+						  BATcapacity(bn) + q - p, BUN_NONE);
+					cnt += ((*cmp)(v, nil) != 0 &&
+						(!lval ||
+						 (c = cmp(tl, v)) < 0 ||
+						 (li && c == 0)) &&
+						(!hval ||
+						 (c = cmp(th, v)) > 0 ||
+						 (hi && c == 0)));
+				}
+			}
+		}
+	} else if (equi) {
 		ALGODEBUG fprintf(stderr,
 				  "#BATsubselect(b=%s#"BUNFMT",s=%s,anti=%d): "
 				  "scanselect equi\n", BATgetId(b), BATcount(b),
@@ -924,6 +985,7 @@ BATsubselect(BAT *b, BAT *s, const void *tl, const void *th,
 	const void *nil;
 	BAT *bn;
 	BUN estimate = BUN_NONE, maximum = BUN_NONE;
+	lng clo, chi;
 	union {
 		bte v_bte;
 		sht v_sht;
@@ -1326,6 +1388,32 @@ BATsubselect(BAT *b, BAT *s, const void *tl, const void *th,
 	if (bn == NULL)
 		return NULL;
 
+	if (!anti && !(equi && b->T->hash) &&
+	    (s == NULL || BATtdense(s)) &&
+	    ((b->batPersistence == PERSISTENT) ||
+	     ((parent = VIEWtparent(b)) &&
+	      (BBPquickdesc(ABS(parent),0)->batPersistence == PERSISTENT))) &&
+	    CMPselectable(b, tl, th, li, hi, equi, lval, hval, &clo, &chi)) {
+		/* evaluate on the compressed image, if there is one;
+		 * nils never qualify, so the result has the same
+		 * properties as that of a scan select */
+		BUN start = 0, end = BATcount(b);
+		int r;
+
+		if (s) {
+			if (s->tseqbase > b->hseqbase)
+				start = (BUN) (s->tseqbase - b->hseqbase);
+			if (s->tseqbase + BATcount(s) < b->hseqbase + end)
+				end = s->tseqbase + BATcount(s) > b->hseqbase ?
+					(BUN) (s->tseqbase + BATcount(s) - b->hseqbase) : 0;
+		}
+		if (start >= end) {
+			BBPreclaim(bn);
+			return newempty();
+		}
+		if ((r = CMPselect(b, bn, start, end, clo, chi)) != 0)
+			return r < 0 ? NULL : bn;
+	}
 	if (equi && (b->T->hash || hash)) {
 		ALGODEBUG fprintf(stderr, "#BATsubselect(b=%s#" BUNFMT
 				  ",s=%s,anti=%d): hash select\n",
@@ -1338,11 +1426,15 @@ BATsubselect(BAT *b, BAT *s, const void *tl, const void *th,
 		    ((parent = VIEWtparent(b)) &&
 		     (BBPquickdesc(ABS(parent),0)->batPersistence == PERSISTENT)))
 		   && !equi
-		   && !ATOMvarsized(b->ttype)) {
+		   && (!ATOMvarsized(b->ttype) ||
+		       (b->ttype == TYPE_str && !anti &&
+			(s == NULL || BATtdense(s))))) {
 			/* use imprints if
 			*   i) bat is persistent, or parent is persistent
 			*  ii) it is not an equi-select, and
-			* iii) is not var-sized.
+			* iii) is not var-sized, or is a range select
+			*      on a string bat that has no candidate
+			*      list (prefix imprints).
 			*/
 			use_imprints = 1;
 		}
@@ -44,10 +44,8 @@
 #include <fcntl.h>
 #endif
 
-#include <Rinternals.h>
-#ifndef RHS
-#define RHS Rf_sizeofHeader()
-#endif
+/* headroom in front of malloced heaps, see GDK_heap_headroom */
+#define RHS GDK_heap_headroom
 
 void
 GDKfilepath(str path, const char *dir, const char *name, const char *ext)
@@ -212,6 +210,46 @@ GDKunlink(const char *dir, const char *nme, const char *ext)
 	return -1;
 }
 
+/*
+ * A rename does not work across file systems, e.g. when a raw column
+ * file is attached from outside the dbfarm. In that case the contents
+ * are copied instead.
+ */
+static int
+GDKcopyfile(const char *src, const char *dst)
+{
+	FILE *fi, *fo;
+	char *buf;
+	size_t n;
+	int ret = 0;
+
+	if ((buf = GDKmalloc(REMAP_PAGE_MAXSIZE)) == NULL)
+		return -1;
+	if ((fi = fopen(src, "rb")) == NULL) {
+		GDKfree(buf);
+		return -1;
+	}
+	if ((fo = fopen(dst, "wb")) == NULL) {
+		fclose(fi);
+		GDKfree(buf);
+		return -1;
+	}
+	while ((n = fread(buf, 1, REMAP_PAGE_MAXSIZE, fi)) > 0)
+		if (fwrite(buf, 1, n, fo) < n) {
+			ret = -1;
+			break;
+		}
+	if (ferror(fi))
+		ret = -1;
+	fclose(fi);
+	if (fclose(fo) != 0)
+		ret = -1;
+	if (ret < 0)
+		unlink(dst);
+	GDKfree(buf);
+	return ret;
+}
+
 /*
  * A move routine is overloaded to deal with extensions.
  */
@@ -230,6 +268,11 @@ GDKmove(const char *dir1, const char *nme1, const char *ext1, const char *dir2,
 	GDKfilepath(path1, dir1, nme1, ext1);
 	GDKfilepath(path2, dir2, nme2, ext2);
 	ret = rename(path1, path2);
+#ifdef EXDEV
+	if (ret < 0 && errno == EXDEV && (ret = GDKcopyfile(path1, path2)) == 0 &&
+	    (ret = unlink(path1)) < 0)
+		unlink(path2);
+#endif
 
 	IODEBUG THRprintf(GDKstdout, "#move %s %s = %d (%dms)\n", path1, path2, ret, GDKms() - t0);
 
@@ -358,11 +401,13 @@ GDKload(const char *nme, const char *ext, size_t size, size_t maxsize, storage_t
 		int fd = GDKfdlocate(nme, "rb", ext);
 
 		if (fd >= 0) {
-			// R hack
-			char *dst = ret = ((char *) GDKmalloc(maxsize + RHS)) + RHS;
+			char *dst = ret = (char *) GDKmalloc(maxsize + RHS);
 			ssize_t n_expected, n = 0;
 
 			if (ret) {
+				dst = ret += RHS;
+				if (GDK_numa == GDK_NUMA_INTERLEAVE && maxsize >= GDK_mem_bigsize)
+					MT_numa_interleave(ret, maxsize);
 				/* read in chunks, some OSs do not
 				 * give you all at once and Windows
 				 * only accepts int */
@@ -375,7 +420,7 @@ GDKload(const char *nme, const char *ext, size_t size, size_t maxsize, storage_t
 					dst += n;
 				}
 				if (n_expected > 0) {
-					GDKfree(ret);
+					GDKfree(ret - RHS);
 					GDKsyserror("GDKload: cannot read: name=%s, ext=%s, " SZFMT " bytes missing.\n", nme, ext ? ext : "", (size_t) n_expected);
 					ret = NULL;
 				}
@@ -406,6 +451,8 @@ GDKload(const char *nme, const char *ext, size_t size, size_t maxsize, storage_t
 			ret = (char *) GDKmmap(path, mod, maxsize);
 			if (ret == (char *) -1L) {
 				ret = NULL;
+			} else if (GDK_numa == GDK_NUMA_INTERLEAVE && maxsize >= GDK_mem_bigsize) {
+				MT_numa_interleave(ret, maxsize);
 			}
 			IODEBUG THRprintf(GDKstdout, "#mmap(NULL, 0, maxsize " SZFMT ", mod %d, path %s, 0) = " PTRFMT "\n", maxsize, mod, path, PTRFMTCAST(void *)ret);
 		}
@@ -602,6 +649,16 @@ BATsave(BAT *bd)
 		GDKfree(b->T->vheap);
 
 	if (err == 0) {
+		/* save the search accelerators along; they are
+		 * optional, so failing to save them is not fatal */
+		if (bd->batPersistence == PERSISTENT) {
+			(void) HASHsave(bd);
+			(void) HASHsave(BATmirror(bd));
+			(void) IMPSsave(bd);
+			(void) IMPSsave(BATmirror(bd));
+			(void) CMPsave(bd);
+			(void) CMPsave(BATmirror(bd));
+		}
 		bd->batCopiedtodisk = 1;
 		DESCclean(bd);
 		return bd;
@@ -739,6 +796,7 @@ BATdelete(BAT *b)
 		b = loaded;
 		HASHdestroy(b);
 		IMPSdestroy(b);
+		CMPdestroy(b);
 	}
 	assert(!b->H->heap.base || !b->T->heap.base || b->H->heap.base != b->T->heap.base);
 	if (b->batCopiedtodisk || (b->H->heap.storage != STORE_MEM)) {
@@ -286,6 +286,11 @@ static size_t GDK_mem_maxsize_max = GDK_VM_MAXSIZE;
 size_t GDK_mem_maxsize = GDK_VM_MAXSIZE;
 size_t GDK_mem_bigsize = GDK_VM_MAXSIZE;
 size_t GDK_vm_maxsize = GDK_VM_MAXSIZE;
+/* Free space reserved in front of the base of malloced heaps, so that
+ * an embedding application (e.g. R) can put its own object header
+ * right before the data and use it in place.  Only set at GDKinit,
+ * since HEAPfree relies on it to find the start of the block. */
+size_t GDK_heap_headroom = 0;
 
 int GDK_vm_trim = 1;
 
@@ -333,6 +338,7 @@ static MT_Lock GDKstoppedLock MT_LOCK_INITIALIZER("GDKstoppedLock");
 
 size_t _MT_pagesize = 0;	/* variable holding memory size */
 size_t _MT_npages = 0;		/* variable holding page size */
+size_t _MT_cachesize = 0;	/* variable holding last level cache size */
 
 void
 MT_init(void)
@@ -428,6 +434,16 @@ MT_init(void)
 #else
 # error "don't know how to get the amount of physical memory for your OS"
 #endif
+
+#if defined(HAVE_SYSCONF) && defined(_SC_LEVEL3_CACHE_SIZE)
+	_MT_cachesize = (size_t) sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+#if defined(HAVE_SYSCONF) && defined(_SC_LEVEL2_CACHE_SIZE)
+	if (_MT_cachesize == 0 || _MT_cachesize == (size_t) -1)
+		_MT_cachesize = (size_t) sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+	if (_MT_cachesize == 0 || _MT_cachesize == (size_t) -1)
+		_MT_cachesize = (size_t) 4 << 20;	/* default */
 }
 
 size_t
@@ -965,6 +981,7 @@ GDKinit(opt *set, int setlen)
 		MT_lock_init(&GDKbatLock[i].swap, "GDKswapLock");
 		MT_lock_init(&GDKbatLock[i].hash, "GDKhashLock");
 		MT_lock_init(&GDKbatLock[i].imprints, "GDKimprintsLock");
+		MT_lock_init(&GDKbatLock[i].compress, "GDKcompressLock");
 	}
 	for (i = 0; i <= BBP_THREADMASK; i++) {
 		MT_lock_init(&GDKbbpLock[i].alloc, "GDKcacheLock");
@@ -981,6 +998,10 @@ GDKinit(opt *set, int setlen)
 	if ((p = mo_find_option(set, setlen, "gdk_mem_pagebits")))
 		GDK_mem_pagebits = (int) strtol(p, NULL, 10);
 
+	/* must be known before the first heap is allocated */
+	if ((p = mo_find_option(set, setlen, "gdk_heap_headroom")))
+		GDK_heap_headroom = ((size_t) strtoll(p, NULL, 10) + 15) & ~(size_t) 15;
+
 	mnstr_init();
 	MT_init_posix();
 	THRinit();
@@ -1097,6 +1118,13 @@ GDKinit(opt *set, int setlen)
 	/*    per op:  2 args + 1 res, each with head & tail  =>  (2+1)*2 = 6  ^ */
 #endif
 
+	if ((p = GDKgetenv("gdk_numa")) != NULL && MT_numa_nodes() > 1) {
+		if (strcasecmp(p, "interleave") == 0)
+			GDK_numa = GDK_NUMA_INTERLEAVE;
+		else if (strcasecmp(p, "local") == 0)
+			GDK_numa = GDK_NUMA_LOCAL;
+	}
+
 	if ((p = mo_find_option(set, setlen, "gdk_vmtrim")) == NULL ||
 	    strcasecmp(p, "yes") == 0)
 		MT_create_thread(&GDKvmtrim_id, GDKvmtrim, &GDK_mem_maxsize,
@@ -1106,6 +1134,7 @@ GDKinit(opt *set, int setlen)
 }
 
 int GDKnr_threads = 0;
+int GDK_numa = GDK_NUMA_OFF;
 static int GDKnrofthreads;
 
 int
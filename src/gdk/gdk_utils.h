@@ -83,9 +83,11 @@ gdk_export void GDKsetenv(str name, str value);
 /* virtual memory defines */
 gdk_export size_t _MT_npages;
 gdk_export size_t _MT_pagesize;
+gdk_export size_t _MT_cachesize;
 
 #define MT_pagesize()	_MT_pagesize
 #define MT_npages()	_MT_npages
+#define MT_cachesize()	_MT_cachesize	/* size of the last level cache */
 
 gdk_export void MT_init(void);	/*  init the package. */
 gdk_export int GDKinit(opt *set, int setlen);
@@ -97,6 +99,14 @@ gdk_export int GDKinit(opt *set, int setlen);
  */
 gdk_export int GDKnr_threads;
 
+/* NUMA placement of large heaps (gdk_numa option): off, interleaved
+ * over all nodes, or local to the (pinned) worker that first touches
+ * them */
+#define GDK_NUMA_OFF		0
+#define GDK_NUMA_INTERLEAVE	1
+#define GDK_NUMA_LOCAL		2
+gdk_export int GDK_numa;
+
 gdk_export void GDKexit(int status);
 gdk_export int GDKexiting(void);
 
@@ -40,13 +40,12 @@
 /* ----------------------------------- Dirty Macros ----------------------------------------*/
 
 static ChainedINT **LB__;
-static RResultPtr *LD__;
 static void *HD__ = NULL;
 
 // Macros to access leaked_data.h global variables from the dynamic library.
 // If you access it statically, you may access not the same variables than ones edited by the MAL code.
 #define LB (((LB__ = (ChainedINT **) dlsym(HD__, "leaked_bids")) == NULL) ? ((ChainedINT **)(access_error("load leaked_bids failed"))) : LB__)
-#define LD (((LD__ = (RResultPtr *) dlsym(HD__, "leaked_data")) == NULL) ? *((RResultPtr *)(access_error("load leaked_data failed"))) : *LD__)
+#define LD(idx) leakState(idx)
 static void *
 access_error(const char *msg)
 {
@@ -54,6 +53,36 @@ access_error(const char *msg)
 	return NULL;
 }
 
+// Result record of one MAL client, see leak_state.
+static RResultPtr
+leakState(int idx)
+{
+	RResultPtr (*state)(int);
+	RResultPtr ld;
+
+	*(void **)(&state) = dlsym(HD__, "leak_state");
+	if (state == NULL)
+		access_error("load leak_state failed");
+	if ((ld = (*state)(idx)) == NULL)
+		Rf_error("No leak state for client %d", idx);
+	return ld;
+}
+
+// Bumped each time a client slot is closed, so that a slot taken by a new connection can be told apart.
+// Never freed: the finalizers that look at it may run in any order at exit.
+static int *clientGeneration = NULL;
+
+// MAL client of a connection, conn is the client index kept in the R connection object.
+static Client
+connClient(SEXP conn)
+{
+	int idx = INTEGER_VALUE(conn);
+
+	if (idx < 0 || idx >= MAL_MAXCLIENTS || mal_clients[idx].mode == FREECLIENT)
+		Rf_error("Connection %d is closed", idx);
+	return mal_clients + idx;
+}
+
 static ChainedSEXP *preserved = NULL;
 static ChainedSEXP *CSEXP_pushValue(SEXP val, ChainedSEXP *c) {
 	ChainedSEXP *r = (ChainedSEXP *) malloc(sizeof(ChainedSEXP));
@@ -86,11 +115,17 @@ SEXP monetinR_batinUse(void) {
 	return ScalarLogical(preserved != NULL && leakedBatInUse(*LB));
 }
 
+// External pointer to finalizerArg, finalized on gc or at R exit; prot is kept alive with it.
+static SEXP finalizedPtr(R_CFinalizer_t finalizer, void *finalizerArg, SEXP prot) {
+	SEXP extptr = R_MakeExternalPtr(finalizerArg, R_NilValue, prot);
+	R_MakeWeakRefC(extptr, R_NilValue, finalizer, TRUE);
+	return extptr;
+}
+
 static void executeOnExit(R_CFinalizer_t finalizer, void *finalizerArg) {
 	SEXP extptr;
-	R_PreserveObject(extptr = R_MakeExternalPtr(finalizerArg, R_NilValue, R_NilValue));
+	R_PreserveObject(extptr = finalizedPtr(finalizer, finalizerArg, R_NilValue));
 	preserved = CSEXP_pushValue(extptr, preserved);
-	R_MakeWeakRefC(extptr, R_NilValue, finalizer, TRUE);
 }
 
 #define EXITFUN_def( destroyer ) static void (R_CFinalizer_from_ ## destroyer)(SEXP p) { destroyer(R_ExternalPtrAddr(p)); }
@@ -101,8 +136,11 @@ EXITFUN_def(buffer_destroy)
 EXITFUN_def(mR_destroyMsg)
 EXITFUN_def(GDKfree)
 
+// Cleared before GDKexit: finalizers that run later must not touch the kernel.
+static int gdk_alive = 0;
+
 static void
-monetinR_on_exit(SEXP ptr) { (void) ptr; GDKexit(0); }
+monetinR_on_exit(SEXP ptr) { (void) ptr; gdk_alive = 0; GDKexit(0); }
 
 /*
 static void
@@ -120,7 +158,7 @@ mysighandler(int sigint) {
 */
 
 // Based on the mserver5 main()
-str monetinR_init(const char *dbpath, int debug) {
+str monetinR_init(const char *dbpath, int debug, int relaxed) {
 
 	long_str buf;
 	opt *set = NULL;
@@ -133,7 +171,7 @@ str monetinR_init(const char *dbpath, int debug) {
 
 	if(preserved != NULL) Rf_error("Only one instance of monetinR at a time. Sorry, can't do better than that.");
 
-#define N_OPTIONS	6	/*MUST MATCH # OPTIONS BELOW */
+#define N_OPTIONS	8	/*MUST MATCH # OPTIONS BELOW */
 	set = malloc(sizeof(opt) * N_OPTIONS);
 	if (set == NULL) {
 		err = "Malloc of set failed"; return err;
@@ -163,6 +201,19 @@ str monetinR_init(const char *dbpath, int debug) {
 	set[setlen].name = strdup("gdk_single_user");
 	set[setlen].value = strdup("yes");
 	setlen++;
+	/* room for the R vector header in front of every heap, so
+	 * results can be wrapped in place (see leak_addColumn) */
+	set[setlen].kind = opt_builtin;
+	set[setlen].name = strdup("gdk_heap_headroom");
+	snprintf(buf, sizeof(long_str) - 1, SZFMT, (size_t) Rf_sizeofHeader());
+	set[setlen].value = strdup(buf);
+	setlen++;
+	/* relaxed durability: commits don't wait for the log to be
+	 * synced, at most the last second of them is lost in a crash */
+	set[setlen].kind = opt_builtin;
+	set[setlen].name = strdup("gdk_log_commit");
+	set[setlen].value = strdup(relaxed ? "relaxed" : "sync");
+	setlen++;
 
 	assert(setlen == N_OPTIONS);
 
@@ -170,6 +221,7 @@ str monetinR_init(const char *dbpath, int debug) {
 		err = "GDKInit failed"; return err;
 	}
 
+	gdk_alive = 1;
 	executeOnExit(monetinR_on_exit, NULL);
 	R_ShowMessage("Powered by MonetDB 5\n");
 
@@ -296,16 +348,19 @@ str monetinR_init(const char *dbpath, int debug) {
 	if(HD__ == NULL)
 		Rf_error("leak module not found");
 	{
-		int (*adr)();
+		int (*adr)(int);
 		*(void **)(&adr) = dlsym(HD__, "leak_init");
 		if(adr == NULL)
 			Rf_error("leak_init function not found");
-		if ((*adr)())
+		if ((*adr)(0))
 			Rf_error("leak_init failed");
-		mal_clients->fdout = LD->msg;
-		executeOnExit(EXITFUN_fun(mR_destroyMsg), LD->msg);
-		executeOnExit(EXITFUN_fun(GDKfree), LD);
+		mal_clients->fdout = LD(0)->msg;
+		executeOnExit(EXITFUN_fun(mR_destroyMsg), LD(0)->msg);
+		executeOnExit(EXITFUN_fun(GDKfree), LD(0));
 	}
+	if (clientGeneration == NULL &&
+	    (clientGeneration = calloc(MAL_MAXCLIENTS, sizeof(int))) == NULL)
+		Rf_error("Malloc of client generations failed");
 
 #ifdef RDEBUG
 	R_ShowMessage("customs callString ok\n");
@@ -341,16 +396,82 @@ str monetinR_init(const char *dbpath, int debug) {
 	return err;
 }
 
-SEXP monetinR_wrapper(SEXP dbpath, SEXP debug)
+SEXP monetinR_wrapper(SEXP dbpath, SEXP debug, SEXP relaxed)
 {
 	//str err;
 	//SEXP e;
-	/*err =*/ monetinR_init(STRING_VALUE(dbpath), INTEGER_VALUE(debug));
+	/*err =*/ monetinR_init(STRING_VALUE(dbpath), INTEGER_VALUE(debug), LOGICAL_VALUE(relaxed));
 	//PROTECT(e = allocVector(STRSXP, 1));
 	//SET_STRING_ELT(e, 0, mkChar(err));
 	//UNPROTECT(1);
 	return ScalarInteger(0);
 }
+/*
+ * Additional connections get a MAL client of their own, with their own
+ * SQL session and leak result record (leak_init), so their queries
+ * and transactions don't interfere with those of the other ones. The
+ * console client (index 0) is the connection of monetinR_init.
+ */
+SEXP
+monetinR_newClient(void)
+{
+	int (*adr)(int);
+	buffer *b;
+	bstream *fdin;
+	Client c;
+	str err;
+
+	*(void **)(&adr) = dlsym(HD__, "leak_init");
+	if (adr == NULL)
+		Rf_error("leak_init function not found");
+	if ((b = buffer_create(1024)) == NULL ||
+	    (fdin = bstream_create(buffer_rastream(b, "Rinput"), 0)) == NULL)
+		Rf_error("Malloc of client input failed");
+	if ((c = MCinitClient(mal_clients->user, fdin, NULL)) == NULL) {
+		bstream_destroy(fdin);
+		buffer_destroy(b);
+		Rf_error("No free client slot (max %d)", MAL_MAXCLIENTS);
+	}
+	if ((*adr)(c->idx)) {
+		MCcloseClient(c);
+		buffer_destroy(b);
+		Rf_error("leak_init failed");
+	}
+	c->fdout = LD(c->idx)->msg;
+	MSinitClientPrg(c, "user", "main");
+	if ((err = SQLinitEnvironment(c)) != MAL_SUCCEED) {
+		monetinR_closeClient(ScalarInteger(c->idx));
+		Rf_error("ERROR: %s", err);
+	}
+	return ScalarInteger(c->idx);
+}
+
+SEXP
+monetinR_closeClient(SEXP conn)
+{
+	Client c = connClient(conn);
+	void (*adr)(int);
+	buffer *in, *out;
+
+	if (c == mal_clients)
+		Rf_error("The first connection lasts until monetinR_stop");
+	*(void **)(&adr) = dlsym(HD__, "leak_exit");
+	if (adr == NULL)
+		Rf_error("leak_exit function not found");
+	if (c->sqlcontext)
+		SQLexitClient(c);
+	// MCcloseClient destroys both streams, but not their buffers
+	in = mnstr_get_buffer(c->fdin->s);
+	out = mnstr_get_buffer(c->fdout);
+	MCcloseClient(c);
+	buffer_destroy(in);
+	buffer_destroy(out);
+	(*adr)(INTEGER_VALUE(conn));
+	// whatever still refers to this connection must not touch the next one
+	clientGeneration[INTEGER_VALUE(conn)]++;
+	return ScalarLogical(1);
+}
+
 SEXP
 monetinR_dummy(void)
 {
@@ -388,14 +509,15 @@ monetinR_dummy(void)
 
 
 SEXP
-monetinR_executeQuery(SEXP q)
+monetinR_executeQuery(SEXP q, SEXP conn)
 {
 	SEXP res;
+	Client c = connClient(conn);
 	str query = strdup(STRING_VALUE(q));
-	RResultPtr ld = LD;
+	RResultPtr ld = LD(c->idx);
 	char *msg, *msgdup;
 
-	SQLstatementIntern(mal_clients, &query, "main", 1, 1);
+	SQLstatementIntern(c, &query, "main", 1, 1);
 	msg = mR_getMsg(ld->msg);
 	msgdup = strdup(msg);
 	free(msg);
@@ -421,16 +543,182 @@ monetinR_executeQuery(SEXP q)
 	return ScalarInteger(1); // never reached
 }
 
+/*
+ * Streamed results (dbSendQuery/fetch). The query runs with
+ * leaked_data->stream set, so the result columns stay in BATs that
+ * leak_addColumn fixed for us (and put on leaked_bids, which makes
+ * monetinR_batinUse see them). The handle owns these fixes; fetch
+ * exports the next rows of every column, and clearing or collecting
+ * the handle unfixes the BATs again.
+ */
+typedef struct {
+	int ncol;
+	int *bids;
+	int *scale;	/* of decimal columns, -1 for the others */
+	BUN nrow;
+	BUN next;	/* first row not fetched yet */
+} ResultHandle;
+
+// Gives up the fix leak_addColumn took on a streamed column, and its place on leaked_bids.
+// No leaked_lock: this may run as a finalizer inside a leak instruction that holds it.
+static void
+monetinR_releaseColumn(int bid)
+{
+	ChainedINT **lb;
+
+	if (bid == 0 || !gdk_alive)
+		return;
+	lb = LB;
+	*lb = CINT_removeValue(bid, *lb);
+	BBPunfix(bid);
+}
+
+static void
+monetinR_releaseResult(void *p)
+{
+	ResultHandle *h = p;
+	int i;
+
+	if (h == NULL)
+		return;
+	for (i = 0; i < h->ncol; i++)
+		monetinR_releaseColumn(h->bids[i]);
+	free(h->bids);
+	free(h->scale);
+	free(h);
+}
+EXITFUN_def(monetinR_releaseResult)
+
+SEXP
+monetinR_sendQuery(SEXP q, SEXP conn)
+{
+	SEXP res;
+	Client c = connClient(conn);
+	str query = strdup(STRING_VALUE(q));
+	RResultPtr ld = LD(c->idx);
+	ResultHandle *h;
+	char *msg, *msgdup;
+	int i;
+
+	ld->stream = 1;
+	SQLstatementIntern(c, &query, "main", 1, 1);
+	ld->stream = 0;
+	msg = mR_getMsg(ld->msg);
+	msgdup = strdup(msg);
+	free(msg);
+	switch(ld->type) {
+	case LD_PROCESSING:
+		if (TYPEOF(ld->value) == INTSXP)
+			for (i = 0; i < LENGTH(ld->value); i++)
+				monetinR_releaseColumn(INTEGER(ld->value)[i]);
+		UNPROTECT(3);
+	case LD_ERROR:
+		Rf_error("ERROR: %s", msgdup);
+		break;
+	case LD_MESSAGE:
+		if (*msgdup) R_ShowMessage(msgdup);
+		return ScalarInteger(0);
+	case LD_RESULT:
+		if (*msgdup) R_ShowMessage(msgdup);
+		res = ld->value;
+		setAttrib(res, R_NamesSymbol, ld->name);
+		UNPROTECT(3);
+		return res;
+	case LD_STREAM:
+		if (*msgdup) R_ShowMessage(msgdup);
+		h = malloc(sizeof(ResultHandle));
+		if (h != NULL) {
+			h->bids = malloc(LENGTH(ld->value) * sizeof(int));
+			h->scale = malloc(LENGTH(ld->value) * sizeof(int));
+			if (h->bids == NULL || h->scale == NULL) {
+				free(h->bids);
+				free(h->scale);
+				free(h);
+				h = NULL;
+			}
+		}
+		if (h == NULL) {
+			for (i = 0; i < LENGTH(ld->value); i++)
+				monetinR_releaseColumn(INTEGER(ld->value)[i]);
+			UNPROTECT(3);
+			Rf_error("Malloc of result handle failed");
+		}
+		h->ncol = LENGTH(ld->value);
+		memcpy(h->bids, INTEGER(ld->value), h->ncol * sizeof(int));
+		memcpy(h->scale, ld->scale, h->ncol * sizeof(int));
+		h->nrow = BATcount(BBPquickdesc(h->bids[0], FALSE));
+		h->next = 0;
+		PROTECT(res = finalizedPtr(EXITFUN_fun(monetinR_releaseResult), h, R_NilValue));
+		setAttrib(res, install("colnames"), ld->name);
+		setAttrib(res, install("rows"), ScalarReal((double) h->nrow));
+		UNPROTECT(4);
+		return res;
+	default:
+		Rf_error("You should never see this message [%d]", ld->type);
+	}
+	return ScalarInteger(1); // never reached
+}
+
+// The next n rows (all remaining ones if n < 0) as a list of columns.
+SEXP
+monetinR_fetch(SEXP handle, SEXP n)
+{
+	ResultHandle *h = R_ExternalPtrAddr(handle);
+	SEXP (*fetch)(int, BUN, BUN, int);
+	SEXP res, col;
+	BUN cnt;
+	int i;
+
+	if (h == NULL)
+		Rf_error("Result set already cleared");
+	*(void **)(&fetch) = dlsym(HD__, "leak_fetchColumn");
+	if (fetch == NULL)
+		Rf_error("leak_fetchColumn function not found");
+	cnt = h->nrow - h->next;
+	if (INTEGER_VALUE(n) >= 0 && (BUN) INTEGER_VALUE(n) < cnt)
+		cnt = (BUN) INTEGER_VALUE(n);
+	PROTECT(res = NEW_LIST(h->ncol));
+	for (i = 0; i < h->ncol; i++) {
+		if ((col = (*fetch)(h->bids[i], h->next, cnt, h->scale[i])) == NULL) {
+			UNPROTECT(1);
+			Rf_error("Fetch of column %d failed", i + 1);
+		}
+		SET_VECTOR_ELT(res, i, col);
+	}
+	h->next += cnt;
+	UNPROTECT(1);
+	return res;
+}
+
 SEXP
-monetinR_explainQuery(SEXP q)
+monetinR_hasCompleted(SEXP handle)
 {
+	ResultHandle *h = R_ExternalPtrAddr(handle);
+
+	return ScalarLogical(h == NULL || h->next >= h->nrow);
+}
+
+SEXP
+monetinR_clearResult(SEXP handle)
+{
+	void *h = R_ExternalPtrAddr(handle);
+
+	R_ClearExternalPtr(handle);
+	monetinR_releaseResult(h);
+	return ScalarLogical(h != NULL);
+}
+
+SEXP
+monetinR_explainQuery(SEXP q, SEXP conn)
+{
+	Client c = connClient(conn);
 	str query = malloc(GDKMAXERRLEN);
-	RResultPtr ld = LD;
+	RResultPtr ld = LD(c->idx);
 	char *msg, *msgdup;
 	if (!query)
 		return ScalarInteger(1);
 	sprintf(query, "EXPLAIN %s\n", STRING_VALUE(q));
-	callString(mal_clients, query, 0);
+	callString(c, query, 0);
 	free(query);
 	msg = mR_getMsg(ld->msg);
 	msgdup = strdup(msg);
@@ -438,3 +726,181 @@ monetinR_explainQuery(SEXP q)
 	if (*msgdup) R_ShowMessage(msgdup);
 	return ScalarInteger(0); // never reached
 }
+
+/*
+ * Column of a data.frame as a BAT. Integer and NA-free double vectors
+ * are wrapped without copy (BATwrap), R's NA_INTEGER being int_nil
+ * already; logicals and doubles with NA need a conversion pass.
+ */
+static BAT *
+monetinR_column2bat(SEXP v)
+{
+	BUN i, n = (BUN) LENGTH(v);
+	BAT *b;
+
+	switch (TYPEOF(v)) {
+	case INTSXP:
+		if (isFactor(v))
+			return NULL;
+		return BATwrap(TYPE_int, INTEGER(v), n);
+	case REALSXP: {
+		double *d = REAL(v);
+		dbl *o;
+
+		for (i = 0; i < n; i++)
+			if (isnan(d[i]))
+				break;
+		if (i == n)
+			return BATwrap(TYPE_dbl, d, n);
+		if ((b = BATnew(TYPE_void, TYPE_dbl, n)) == NULL)
+			return NULL;
+		o = (dbl *) Tloc(b, BUNfirst(b));
+		for (i = 0; i < n; i++)
+			o[i] = isnan(d[i]) ? dbl_nil : d[i];
+		b->T->nonil = 0;
+		break;
+	}
+	case LGLSXP: {
+		int *l = LOGICAL(v);
+		bit *o;
+
+		if ((b = BATnew(TYPE_void, TYPE_bit, n)) == NULL)
+			return NULL;
+		o = (bit *) Tloc(b, BUNfirst(b));
+		for (i = 0; i < n; i++)
+			o[i] = l[i] == NA_LOGICAL ? bit_nil : (bit) (l[i] != 0);
+		b->T->nonil = 0;
+		break;
+	}
+	default:
+		return NULL;
+	}
+	BATsetcount(b, n);
+	BATseqbase(b, 0);
+	b->tsorted = b->trevsorted = 0;
+	return b;
+}
+
+SEXP
+monetinR_appendTable(SEXP tname, SEXP df, SEXP conn)
+{
+	Client c = connClient(conn);
+	int i, ncol = LENGTH(df);
+	BAT **cols;
+	str err = MAL_SUCCEED;
+	str (*append)(Client, str, BAT **, int);
+
+	// Same dynamic lookup as leak_init, the SQL catalogue only lives there.
+	*(void **)(&append) = dlsym(HD__, "leak_appendTable");
+	if (append == NULL)
+		Rf_error("leak_appendTable function not found");
+	if ((cols = GDKzalloc(ncol * sizeof(BAT *))) == NULL)
+		Rf_error("Malloc of columns failed");
+	for (i = 0; i < ncol; i++) {
+		if ((cols[i] = monetinR_column2bat(VECTOR_ELT(df, i))) == NULL) {
+			err = "unsupported column type for bulk append";
+			break;
+		}
+	}
+	if (err == MAL_SUCCEED)
+		err = (*append)(c, (str) STRING_VALUE(tname), cols, ncol);
+	for (i = 0; i < ncol; i++)
+		if (cols[i])
+			BBPreclaim(cols[i]);
+	GDKfree(cols);
+	if (err != MAL_SUCCEED)
+		Rf_error("ERROR: %s", err);
+	return ScalarLogical(1);
+}
+
+/*
+ * Registered data.frames: SQL temporary tables whose columns share the
+ * memory of the R vectors (see leak_registerTable). The handle returned
+ * to R protects the data.frame; once it is garbage collected, or
+ * explicitly unregistered, the table is dropped again.
+ */
+typedef struct {
+	int idx;	/* temporary tables belong to the session of a connection */
+	int gen;	/* clientGeneration[idx] at registration */
+	char *name;
+} Registration;
+
+static void
+monetinR_dropRegistered(void *p)
+{
+	Registration *r = p;
+	str (*unregister)(Client, str);
+	str err;
+
+	if (r == NULL)
+		return;
+	// once the connection is closed its temporary tables are gone,
+	// and the slot may belong to another connection by now
+	*(void **)(&unregister) = gdk_alive && clientGeneration[r->idx] == r->gen &&
+		mal_clients[r->idx].mode != FREECLIENT ? dlsym(HD__, "leak_unregisterTable") : NULL;
+	if (unregister != NULL && (err = (*unregister)(mal_clients + r->idx, r->name)) != MAL_SUCCEED)
+		fprintf(stderr, "!%s\n", err);
+	free(r->name);
+	free(r);
+}
+EXITFUN_def(monetinR_dropRegistered)
+
+SEXP
+monetinR_register(SEXP tname, SEXP cnames, SEXP df, SEXP conn)
+{
+	int i, ncol = LENGTH(df);
+	Client c = connClient(conn);
+	BAT **cols;
+	str *names;
+	str err = MAL_SUCCEED;
+	str (*reg)(Client, str, str *, BAT **, int);
+	Registration *r;
+
+	*(void **)(&reg) = dlsym(HD__, "leak_registerTable");
+	if (reg == NULL)
+		Rf_error("leak_registerTable function not found");
+	if (LENGTH(cnames) != ncol)
+		Rf_error("Need one name per column");
+	cols = GDKzalloc(ncol * sizeof(BAT *));
+	names = GDKzalloc(ncol * sizeof(str));
+	if (cols == NULL || names == NULL) {
+		GDKfree(cols);
+		GDKfree(names);
+		Rf_error("Malloc of columns failed");
+	}
+	for (i = 0; i < ncol; i++) {
+		names[i] = (str) CHAR(STRING_ELT(cnames, i));
+		if ((cols[i] = monetinR_column2bat(VECTOR_ELT(df, i))) == NULL) {
+			err = "unsupported column type for register";
+			break;
+		}
+	}
+	if (err == MAL_SUCCEED)
+		err = (*reg)(c, (str) STRING_VALUE(tname), names, cols, ncol);
+	// the table keeps its own references to the columns
+	for (i = 0; i < ncol; i++)
+		if (cols[i])
+			BBPunfix(cols[i]->batCacheid);
+	GDKfree(cols);
+	GDKfree(names);
+	if (err != MAL_SUCCEED)
+		Rf_error("ERROR: %s", err);
+	if ((r = malloc(sizeof(Registration))) == NULL || (r->name = strdup(STRING_VALUE(tname))) == NULL) {
+		free(r);
+		Rf_error("Malloc of registration failed");
+	}
+	r->idx = c->idx;
+	r->gen = clientGeneration[c->idx];
+	return finalizedPtr(EXITFUN_fun(monetinR_dropRegistered), r, df);
+}
+
+SEXP
+monetinR_unregister(SEXP handle)
+{
+	void *r = R_ExternalPtrAddr(handle);
+
+	R_ClearExternalPtr(handle);
+	R_SetExternalPtrProtected(handle, R_NilValue);
+	monetinR_dropRegistered(r);
+	return ScalarLogical(r != NULL);
+}
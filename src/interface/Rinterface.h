@@ -13,9 +13,9 @@ typedef struct CHAINEDSEXP {
 
 //void *access_error(const char *msg);
 
-SEXP monetinR_wrapper(SEXP dbpath, SEXP debug);
+SEXP monetinR_wrapper(SEXP dbpath, SEXP debug, SEXP relaxed);
 
-str monetinR_init(const char *dbpath, int debug);
+str monetinR_init(const char *dbpath, int debug, int relaxed);
 SEXP monetinR_stop(void);
 SEXP monetinR_isRunning(void);
 SEXP monetinR_batinUse(void);
@@ -29,8 +29,18 @@ SEXP monetinR_batinUse(void);
 
 SEXP monetinR_dummy(void);
 
-SEXP monetinR_executeQuery(SEXP query);
-SEXP monetinR_explainQuery(SEXP query);
+SEXP monetinR_newClient(void);
+SEXP monetinR_closeClient(SEXP conn);
+
+SEXP monetinR_executeQuery(SEXP query, SEXP conn);
+SEXP monetinR_explainQuery(SEXP query, SEXP conn);
+SEXP monetinR_sendQuery(SEXP query, SEXP conn);
+SEXP monetinR_fetch(SEXP handle, SEXP n);
+SEXP monetinR_hasCompleted(SEXP handle);
+SEXP monetinR_clearResult(SEXP handle);
+SEXP monetinR_appendTable(SEXP tname, SEXP df, SEXP conn);
+SEXP monetinR_register(SEXP tname, SEXP cnames, SEXP df, SEXP conn);
+SEXP monetinR_unregister(SEXP handle);
 void destroyBat(SEXP);
 
 #endif
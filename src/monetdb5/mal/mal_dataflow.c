@@ -34,8 +34,16 @@
  *
  * The flow graphs should be organized such that parallel threads can
  * access it mostly without expensive locking.
+ *
+ * The instructions are executed by the workers of the GDK map-reduce
+ * scheduler, which keeps a work queue per worker and lets idle workers
+ * steal from busy ones.  An instruction made eligible by a worker is
+ * queued on that worker's own queue, so it typically picks it up next.
+ * On a NUMA machine the scheduler hands an instruction to a worker on
+ * the node that holds the heap of its first BAT argument.
  */
 #include "mal_dataflow.h"
+#include "gdk_mapreduce.h"
 
 #define DFLOWpending 0		/* runnable */
 #define DFLOWrunning 1		/* currently in progress */
@@ -45,6 +53,7 @@
 
 /* The per instruction status of execution */
 typedef struct FLOWEVENT {
+	MRtask task;    /* scheduler header, must be first */
 	struct DATAFLOW *flow;/* execution context */
 	int pc;         /* pc in underlying malblock */
 	int blocks;     /* awaiting for variables */
@@ -81,8 +90,6 @@ typedef struct DATAFLOW {
 	queue *done;        /* instructions handled */
 } *DataFlow, DataFlowRec;
 
-static MT_Id workers[THREADS];
-static queue *todo = 0;	/* pending instructions */
 static int volatile exiting;
 
 /*
@@ -158,41 +165,6 @@ q_enqueue(queue *q, FlowEvent d)
 	MT_sema_up(&q->s, "q_enqueue");
 }
 
-/*
- * A priority queue over the hot claims of memory may
- * be more effective. It priorizes those instructions
- * that want to use a big recent result
- */
-
-#ifdef USE_MAL_ADMISSION
-static void
-q_requeue_(queue *q, FlowEvent d)
-{
-	int i;
-
-	if (q->last == q->size) {
-		/* enlarge buffer */
-		q->size <<= 1;
-		q->data = (FlowEvent*) GDKrealloc(q->data, sizeof(FlowEvent) * q->size);
-		assert(q->data);
-	}
-	for (i = q->last; i > 0; i--)
-		q->data[i] = q->data[i - 1];
-	q->data[0] = d;
-	q->last++;
-}
-static void
-q_requeue(queue *q, FlowEvent d)
-{
-	assert(q);
-	assert(d);
-	MT_lock_set(&q->l, "q_requeue");
-	q_requeue_(q, d);
-	MT_lock_unset(&q->l, "q_requeue");
-	MT_sema_up(&q->s, "q_requeue");
-}
-#endif
-
 static void *
 q_dequeue(queue *q)
 {
@@ -245,150 +217,139 @@ q_dequeue(queue *q)
  */
 
 static void
-DFLOWworker(void *t)
+DFLOWstep(void *t)
 {
-	DataFlow flow;
-	FlowEvent fe = 0, fnxt = 0;
-	int id = (int) ((MT_Id *) t - workers), last = 0;
-	Thread thr;
+	FlowEvent fe = (FlowEvent) t, fnxt = 0;
+	DataFlow flow = fe->flow;
+	int last = 0;
 	str error = 0;
 
 	int i;
 	lng usec = 0;
 
-	thr = THRnew("DFLOWworker");
+	assert(flow);
 
-	GDKsetbuf(GDKmalloc(GDKMAXERRLEN)); /* where to leave errors */
-	GDKerrbuf[0] = 0;
-	while (1) {
-		if (fnxt == 0)
-			fe = q_dequeue(todo);
-		else
-			fe = fnxt;
-		if (exiting) {
-			break;
-		}
-		fnxt = 0;
-		assert(fe);
-		flow = fe->flow;
-		assert(flow);
-
-		/* whenever we have a (concurrent) error, skip it */
-		if (flow->error) {
-			q_enqueue(flow->done, fe);
-			continue;
-		}
+	/* whenever we have a (concurrent) error, skip it */
+	if (flow->error) {
+		q_enqueue(flow->done, fe);
+		return;
+	}
 
-		usec = GDKusec();
-		/* skip all instructions when we have encontered an error */
-		if (flow->error == 0) {
+	usec = GDKusec();
 #ifdef USE_MAL_ADMISSION
-			if (MALadmission(fe->argclaim, fe->hotclaim)) {
-				fe->hotclaim = 0;   /* don't assume priority anymore */
-				assert(todo);
-				if (todo->last == 0)
-					MT_sleep_ms(DELAYUNIT);
-				q_requeue(todo, fe);
-				continue;
-			}
+	if (MALadmission(fe->argclaim, fe->hotclaim)) {
+		fe->hotclaim = 0;   /* don't assume priority anymore */
+		if (MRpending() == 0)
+			MT_sleep_ms(DELAYUNIT);
+		MRrequeue(&fe->task);
+		return;
+	}
 #endif
-			error = runMALsequence(flow->cntxt, flow->mb, fe->pc, fe->pc + 1, flow->stk, 0, 0);
-			PARDEBUG mnstr_printf(GDKstdout, "#executed pc= %d wrk= %d claim= " LLFMT "," LLFMT " %s\n",
-								  fe->pc, id, fe->argclaim, fe->hotclaim, error ? error : "");
+	error = runMALsequence(flow->cntxt, flow->mb, fe->pc, fe->pc + 1, flow->stk, 0, 0);
+	PARDEBUG mnstr_printf(GDKstdout, "#executed pc= %d wrk= %d claim= " LLFMT "," LLFMT " %s\n",
+						  fe->pc, MRworkerid(), fe->argclaim, fe->hotclaim, error ? error : "");
 #ifdef USE_MAL_ADMISSION
-			/* release the memory claim */
-			MALadmission(-fe->argclaim, -fe->hotclaim);
+	/* release the memory claim */
+	MALadmission(-fe->argclaim, -fe->hotclaim);
 #endif
 
-			fe->state = DFLOWwrapup;
-			if (error) {
-				MT_lock_set(&flow->flowlock, "runMALdataflow");
-				/* only collect one error (from one thread, needed for stable testing) */
-				if (!flow->error) 
-					flow->error = error;
-				MT_lock_unset(&flow->flowlock, "runMALdataflow");
-				/* after an error we skip the rest of the block */
-				q_enqueue(flow->done, fe);
-				continue;
-			}
-		}
+	fe->state = DFLOWwrapup;
+	if (error) {
+		MT_lock_set(&flow->flowlock, "runMALdataflow");
+		/* only collect one error (from one thread, needed for stable testing) */
+		if (!flow->error) 
+			flow->error = error;
+		MT_lock_unset(&flow->flowlock, "runMALdataflow");
+		/* after an error we skip the rest of the block */
+		q_enqueue(flow->done, fe);
+		return;
+	}
 
-		/* see if you can find an eligible instruction that uses the
-		 * result just produced. Then we can continue with it right away.
-		 * We are just looking forward for the last block, which means we
-		 * are safe from concurrent actions. No other thread can steal it,
-		 * because we hold the logical lock.
-		 * All eligible instructions are queued
-		 */
+	/* see if you can find an eligible instruction that uses the
+	 * result just produced. Then we can continue with it right away.
+	 * We are just looking forward for the last block, which means we
+	 * are safe from concurrent actions. No other thread can steal it,
+	 * because we hold the logical lock.
+	 * All eligible instructions are queued
+	 */
 #ifdef USE_MAL_ADMISSION
-		{
-		InstrPtr p = getInstrPtr(flow->mb, fe->pc);
-		assert(p);
-		fe->hotclaim = 0;
-		for (i = 0; i < p->retc; i++)
-			fe->hotclaim += getMemoryClaim(flow->mb, flow->stk, fe->pc, i, FALSE);
-		}
+	{
+	InstrPtr p = getInstrPtr(flow->mb, fe->pc);
+	assert(p);
+	fe->hotclaim = 0;
+	for (i = 0; i < p->retc; i++)
+		fe->hotclaim += getMemoryClaim(flow->mb, flow->stk, fe->pc, i, FALSE);
+	}
 #endif
-		MT_lock_set(&flow->flowlock, "MALworker");
-	
-		for (last = fe->pc - flow->start; last >= 0 && (i = flow->nodes[last]) > 0; last = flow->edges[last])
-			if (flow->status[i].state == DFLOWpending &&
-				flow->status[i].blocks == 1) {
-				flow->status[i].state = DFLOWrunning;
-				flow->status[i].blocks = 0;
-				flow->status[i].hotclaim = fe->hotclaim;
-				flow->status[i].argclaim += fe->hotclaim;
-				fnxt = flow->status + i;
-				break;
-			}
-		MT_lock_unset(&flow->flowlock, "MALworker");
+	MT_lock_set(&flow->flowlock, "MALworker");
 
-		q_enqueue(flow->done, fe);
-		if ( fnxt == 0) {
-			assert(todo);
-			if (todo->last == 0)
-				profilerHeartbeatEvent("wait");
-			else
-				MALresourceFairness(usec);
+	for (last = fe->pc - flow->start; last >= 0 && (i = flow->nodes[last]) > 0; last = flow->edges[last])
+		if (flow->status[i].state == DFLOWpending &&
+			flow->status[i].blocks == 1) {
+			flow->status[i].state = DFLOWrunning;
+			flow->status[i].blocks = 0;
+			flow->status[i].hotclaim = fe->hotclaim;
+			flow->status[i].argclaim += fe->hotclaim;
+			fnxt = flow->status + i;
+			break;
 		}
+	MT_lock_unset(&flow->flowlock, "MALworker");
+
+	/* the successor goes to our own queue, where we pick it up
+	 * next, unless an idle worker steals it first */
+	if (fnxt)
+		MRpush(&fnxt->task);
+	q_enqueue(flow->done, fe);
+	if (fnxt == 0) {
+		if (MRpending() == 0)
+			profilerHeartbeatEvent("wait");
+		else
+			MALresourceFairness(usec);
+	}
+}
+
+/*
+ * The NUMA node holding the data of the first BAT argument of an
+ * instruction, -1 if unknown or if there is only one node.
+ */
+static int
+DFLOWnode(DataFlow flow, int pc)
+{
+	InstrPtr p = getInstrPtr(flow->mb, pc);
+	ValPtr v;
+	BAT *b;
+	int j;
+
+	if (MRnrnodes() <= 1 || p == NULL)
+		return -1;
+	for (j = p->retc; j < p->argc; j++) {
+		v = &flow->stk->stk[getArg(p, j)];
+		if (v->vtype != TYPE_bat || v->val.bval == 0)
+			continue;
+		/* don't load it, just look where it is */
+		if ((b = BBP_cache(ABS(v->val.bval))) == NULL)
+			return -1;
+		if (b->T->heap.base)
+			return MT_numa_node_of(Tloc(b, BUNfirst(b)));
+		if (b->H->heap.base)
+			return MT_numa_node_of(Hloc(b, BUNfirst(b)));
+		return -1;
 	}
-	GDKfree(GDKerrbuf);
-	GDKsetbuf(0);
-	THRdel(thr);
+	return -1;
 }
 
 /* 
- * Create a set of DFLOW interpreters.
- * One worker will adaptively be available for each client.
- * The remainder are taken from the GDKnr_threads argument and
+ * The DFLOW interpreters are the workers of the map-reduce scheduler.
+ * Their number is taken from the GDKnr_threads argument and
  * typically is equal to the number of cores.
  * A recursive MAL function call would make for one worker less,
  * which limits the number of cores for parallel processing.
- * The workers are assembled in a local table to enable debugging.
  */
 static str
 DFLOWinitialize(void)
 {
-	int i, limit;
-
-	MT_lock_set(&mal_contextLock, "DFLOWinitialize");
-	if (todo) {
-		MT_lock_unset(&mal_contextLock, "DFLOWinitialize");
-		return MAL_SUCCEED;
-	}
-	todo = q_create(2048, "todo");
-	if (todo == NULL) {
-		MT_lock_unset(&mal_contextLock, "DFLOWinitialize");
-		throw(MAL, "dataflow", "DFLOWinitialize(): Failed to create todo queue");
-	}
-	limit = GDKnr_threads ? GDKnr_threads : 1;
-	for (i = 0; i < limit && i < THREADS; i++) {
-		if (MT_create_thread(&workers[i], DFLOWworker, (void *) &workers[i], MT_THR_JOINABLE) < 0) {
-			MT_lock_unset(&mal_contextLock, "DFLOWinitialize");
-			throw(MAL, "dataflow", "Can not create interpreter thread");
-		}
-	}
-	MT_lock_unset(&mal_contextLock, "DFLOWinitialize");
+	if (MRinit() != GDK_SUCCEED)
+		throw(MAL, "dataflow", "Can not create interpreter thread");
 	return MAL_SUCCEED;
 }
  
@@ -422,6 +383,8 @@ DFLOWinitBlk(DataFlow flow, MalBlkPtr mb, int size)
 		}
 
 		/* initial state, ie everything can run */
+		flow->status[n].task.cmd = DFLOWstep;
+		flow->status[n].task.sema = NULL;
 		flow->status[n].flow = flow;
 		flow->status[n].pc = pc;
 		flow->status[n].state = DFLOWpending;
@@ -536,7 +499,8 @@ DFLOWscheduler(DataFlow flow)
 	int j;
 	InstrPtr p;
 #endif
-	int tasks=0, actions;
+	int tasks=0, actions, nready;
+	int *ready;
 	str ret = MAL_SUCCEED;
 	FlowEvent fe, f = 0;
 
@@ -545,26 +509,35 @@ DFLOWscheduler(DataFlow flow)
 	actions = flow->stop - flow->start;
 	if (actions == 0)
 		throw(MAL, "dataflow", "Empty dataflow block");
+	/* the instructions that became eligible are handed to the workers
+	 * after the flowlock is released, as a worker queue that is full
+	 * runs the instruction inline, which takes the flowlock again */
+	ready = (int *) GDKmalloc(actions * sizeof(int));
+	if (ready == NULL)
+		throw(MAL, "dataflow", MAL_MALLOC_FAIL);
 	/* initialize the eligible statements */
 	fe = flow->status;
 
 	MT_lock_set(&flow->flowlock, "MALworker");
-	for (i = 0; i < actions; i++)
+	for (nready = 0, i = 0; i < actions; i++)
 		if (fe[i].blocks == 0) {
 #ifdef USE_MAL_ADMISSION
 			p = getInstrPtr(flow->mb,fe[i].pc);
 			if (p == NULL) {
 				MT_lock_unset(&flow->flowlock, "MALworker");
+				GDKfree(ready);
 				throw(MAL, "dataflow", "DFLOWscheduler(): getInstrPtr(flow->mb,fe[i].pc) returned NULL");
 			}
 			for (j = p->retc; j < p->argc; j++)
 				fe[i].argclaim = getMemoryClaim(fe[0].flow->mb, fe[0].flow->stk, fe[i].pc, j, FALSE);
 #endif
-			q_enqueue(todo, flow->status + i);
 			flow->status[i].state = DFLOWrunning;
+			ready[nready++] = i;
 			PARDEBUG mnstr_printf(GDKstdout, "#enqueue pc=%d claim=" LLFMT "\n", flow->status[i].pc, flow->status[i].argclaim);
 		}
 	MT_lock_unset(&flow->flowlock, "MALworker");
+	for (i = 0; i < nready; i++)
+		MRpushnode(&flow->status[ready[i]].task, DFLOWnode(flow, flow->status[ready[i]].pc));
 
 	PARDEBUG mnstr_printf(GDKstdout, "#run %d instructions in dataflow block\n", actions);
 
@@ -572,8 +545,10 @@ DFLOWscheduler(DataFlow flow)
 		f = q_dequeue(flow->done);
 		if (exiting)
 			break;
-		if (f == NULL)
+		if (f == NULL) {
+			GDKfree(ready);
 			throw(MAL, "dataflow", "DFLOWscheduler(): q_dequeue(flow->done) returned NULL");
+		}
 
 		/*
 		 * When an instruction is finished we have to reduce the blocked
@@ -583,13 +558,14 @@ DFLOWscheduler(DataFlow flow)
 
 		MT_lock_set(&flow->flowlock, "MALworker");
 		tasks++;
+		nready = 0;
 		for (last = f->pc - flow->start; last >= 0 && (i = flow->nodes[last]) > 0; last = flow->edges[last])
 			if (flow->status[i].state == DFLOWpending) {
 				flow->status[i].argclaim += f->hotclaim;
 				if (flow->status[i].blocks == 1 ) {
 					flow->status[i].state = DFLOWrunning;
 					flow->status[i].blocks--;
-					q_enqueue(todo, flow->status + i);
+					ready[nready++] = i;
 					PARDEBUG
 					mnstr_printf(GDKstdout, "#enqueue pc=%d claim= " LLFMT "\n", flow->status[i].pc, flow->status[i].argclaim);
 				} else {
@@ -597,7 +573,10 @@ DFLOWscheduler(DataFlow flow)
 				}
 			} 
 		MT_lock_unset(&flow->flowlock, "MALworker");
+		for (i = 0; i < nready; i++)
+			MRpushnode(&flow->status[ready[i]].task, DFLOWnode(flow, flow->status[ready[i]].pc));
 	}
+	GDKfree(ready);
 	/* wrap up errors */
 	assert(flow->done->last == 0);
 	if (flow->error ) {
@@ -628,12 +607,8 @@ runMALdataflow(Client cntxt, MalBlkPtr mb, int startpc, int stoppc, MalStkPtr st
 	assert(stoppc > startpc);
 
 	/* check existence of workers */
-	if (workers[0] == 0)
-		ret = DFLOWinitialize();
-	if ( ret != MAL_SUCCEED)
+	if ((ret = DFLOWinitialize()) != MAL_SUCCEED)
 		return ret;
-	assert(workers[0]);
-	assert(todo);
 
 	flow = (DataFlow)GDKzalloc(sizeof(DataFlowRec));
 	if (flow == NULL)
@@ -699,16 +674,6 @@ runMALdataflow(Client cntxt, MalBlkPtr mb, int startpc, int stoppc, MalStkPtr st
 void
 stopMALdataflow(void)
 {
-	int i;
-
 	exiting = 1;
-	if (todo) {
-		for (i = 0; i < THREADS; i++)
-			MT_sema_up(&todo->s, "stopMALdataflow");
-		for (i = 0; i < THREADS; i++) {
-			if (workers[i])
-				MT_join_thread(workers[i]);
-			workers[i] = 0;
-		}
-	}
+	MRstop();
 }
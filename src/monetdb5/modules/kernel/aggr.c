@@ -1149,3 +1149,121 @@ AGGRsubmediancand(bat *retval, bat *bid, bat *gid, bat *eid, bat *sid, bit *skip
 	return AGGRsubgrouped(retval, NULL, bid, gid, eid, sid, *skip_nils,
 						  0, TYPE_any, BATgroupmedian, NULL, "aggr.submedian");
 }
+
+/* the quantile argument is a column (SQL turns constant arguments of
+ * aggregates into columns), of which we use the first value; the
+ * column is empty when the aggregate's input is, in which case every
+ * group gets a nil */
+static str
+AGGRsubquantile_(bat *retval, bat *bid, bat *qid, bat *gid, bat *eid,
+				 bat *sid, int skip_nils,
+				 BAT *(*quantfunc)(BAT *, BAT *, BAT *, BAT *, int, dbl, int, int),
+				 const char *malfunc)
+{
+	BAT *b, *q, *g, *e, *s, *bn;
+	dbl quantile = 0.5;
+	int noquantile;
+
+	if ((q = BATdescriptor(*qid)) == NULL)
+		throw(MAL, malfunc, RUNTIME_OBJECT_MISSING);
+	noquantile = BATcount(q) == 0;
+	if (!noquantile)
+		quantile = * (dbl *) Tloc(q, BUNfirst(q));
+	BBPreleaseref(q->batCacheid);
+	if (quantile == dbl_nil || quantile < 0 || quantile > 1)
+		throw(MAL, malfunc, "quantile must be between 0 and 1");
+
+	b = BATdescriptor(*bid);
+	g = gid ? BATdescriptor(*gid) : NULL;
+	e = eid ? BATdescriptor(*eid) : NULL;
+	s = sid ? BATdescriptor(*sid) : NULL;
+	if (b == NULL || (gid != NULL && g == NULL) ||
+		(eid != NULL && e == NULL) || (sid != NULL && s == NULL)) {
+		if (b)
+			BBPreleaseref(b->batCacheid);
+		if (g)
+			BBPreleaseref(g->batCacheid);
+		if (e)
+			BBPreleaseref(e->batCacheid);
+		if (s)
+			BBPreleaseref(s->batCacheid);
+		throw(MAL, malfunc, RUNTIME_OBJECT_MISSING);
+	}
+
+	bn = (*quantfunc)(b, g, e, s, b->ttype, quantile, skip_nils, 0);
+
+	BBPreleaseref(b->batCacheid);
+	if (g)
+		BBPreleaseref(g->batCacheid);
+	if (e)
+		BBPreleaseref(e->batCacheid);
+	if (s)
+		BBPreleaseref(s->batCacheid);
+	if (bn == NULL) {
+		char *errbuf = GDKerrbuf;
+		char *err;
+
+		if (errbuf && *errbuf) {
+			if (strncmp(errbuf, "!ERROR: ", 8) == 0)
+				errbuf += 8;
+			if ((err = strchr(errbuf, ':')) != NULL && err[1] == ' ')
+				err = createException(MAL, malfunc, "%s", err + 2);
+			else
+				err = createException(MAL, malfunc, "%s", errbuf);
+			*GDKerrbuf = 0;
+			return err;
+		}
+		throw(MAL, malfunc, OPERATION_FAILED);
+	}
+	if (noquantile) {
+		/* the groups as computed, but all nil */
+		BAT *bnn = BATconstant(bn->ttype, ATOMnilptr(bn->ttype), BATcount(bn));
+
+		BBPreleaseref(bn->batCacheid);
+		if (bnn == NULL)
+			throw(MAL, malfunc, MAL_MALLOC_FAIL);
+		bn = bnn;
+	}
+	BBPkeepref(*retval = bn->batCacheid);
+	return MAL_SUCCEED;
+}
+
+aggr_export str AGGRquantile(bat *retval, bat *bid, bat *qid, bit *skip_nils);
+str
+AGGRquantile(bat *retval, bat *bid, bat *qid, bit *skip_nils)
+{
+	return AGGRsubquantile_(retval, bid, qid, NULL, NULL, NULL, *skip_nils,
+							BATgroupquantile, "aggr.subquantile");
+}
+
+aggr_export str AGGRsubquantile(bat *retval, bat *bid, bat *qid, bat *gid, bat *eid, bit *skip_nils);
+str
+AGGRsubquantile(bat *retval, bat *bid, bat *qid, bat *gid, bat *eid, bit *skip_nils)
+{
+	return AGGRsubquantile_(retval, bid, qid, gid, eid, NULL, *skip_nils,
+							BATgroupquantile, "aggr.subquantile");
+}
+
+aggr_export str AGGRsubquantilecand(bat *retval, bat *bid, bat *qid, bat *gid, bat *eid, bat *sid, bit *skip_nils);
+str
+AGGRsubquantilecand(bat *retval, bat *bid, bat *qid, bat *gid, bat *eid, bat *sid, bit *skip_nils)
+{
+	return AGGRsubquantile_(retval, bid, qid, gid, eid, sid, *skip_nils,
+							BATgroupquantile, "aggr.subquantile");
+}
+
+aggr_export str AGGRquantile_approx(bat *retval, bat *bid, bat *qid, bit *skip_nils);
+str
+AGGRquantile_approx(bat *retval, bat *bid, bat *qid, bit *skip_nils)
+{
+	return AGGRsubquantile_(retval, bid, qid, NULL, NULL, NULL, *skip_nils,
+							BATgroupquantile_approx, "aggr.subquantile_approx");
+}
+
+aggr_export str AGGRsubquantile_approx(bat *retval, bat *bid, bat *qid, bat *gid, bat *eid, bit *skip_nils);
+str
+AGGRsubquantile_approx(bat *retval, bat *bid, bat *qid, bat *gid, bat *eid, bit *skip_nils)
+{
+	return AGGRsubquantile_(retval, bid, qid, gid, eid, NULL, *skip_nils,
+							BATgroupquantile_approx, "aggr.subquantile_approx");
+}
@@ -317,4 +317,34 @@ comment "Grouped median aggregate";
 command submedian(b:bat[:oid,:any_1],g:bat[:oid,:oid],e:bat[:oid,:any_2],s:bat[:oid,:oid],skip_nils:bit) :bat[:oid,:any_1]
 address AGGRsubmediancand
 comment "Grouped median aggregate with candidate list";
+
+function quantile(b:bat[:oid,:any_1],q:bat[:oid,:dbl]) :any_1;
+	bn := subquantile(b, q, false);
+	return algebra.fetch(bn, 0);
+end aggr.quantile;
+
+command subquantile(b:bat[:oid,:any_1],q:bat[:oid,:dbl],skip_nils:bit) :bat[:oid,:any_1]
+address AGGRquantile
+comment "Quantile aggregate, the quantile is the first value of q";
+
+command subquantile(b:bat[:oid,:any_1],q:bat[:oid,:dbl],g:bat[:oid,:oid],e:bat[:oid,:any_2],skip_nils:bit) :bat[:oid,:any_1]
+address AGGRsubquantile
+comment "Grouped quantile aggregate";
+
+command subquantile(b:bat[:oid,:any_1],q:bat[:oid,:dbl],g:bat[:oid,:oid],e:bat[:oid,:any_2],s:bat[:oid,:oid],skip_nils:bit) :bat[:oid,:any_1]
+address AGGRsubquantilecand
+comment "Grouped quantile aggregate with candidate list";
+
+function quantile_approx(b:bat[:oid,:any_1],q:bat[:oid,:dbl]) :any_1;
+	bn := subquantile_approx(b, q, false);
+	return algebra.fetch(bn, 0);
+end aggr.quantile_approx;
+
+command subquantile_approx(b:bat[:oid,:any_1],q:bat[:oid,:dbl],skip_nils:bit) :bat[:oid,:any_1]
+address AGGRquantile_approx
+comment "Approximate quantile aggregate, computed in parallel";
+
+command subquantile_approx(b:bat[:oid,:any_1],q:bat[:oid,:dbl],g:bat[:oid,:oid],e:bat[:oid,:any_2],skip_nils:bit) :bat[:oid,:any_1]
+address AGGRsubquantile_approx
+comment "Grouped quantile aggregate (computed exactly)";
 EOF
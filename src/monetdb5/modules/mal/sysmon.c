@@ -21,6 +21,7 @@
 #include "mal_authorize.h"
 #include "mal_runtime.h"
 #include "mtime.h"
+#include "gdk_mapreduce.h"
 
 /* (c) M.L. Kersten
  * The query runtime monitor facility is hardwired 
@@ -199,3 +200,53 @@ SYSMONstop(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	MT_lock_unset(&mal_delayLock, "sysmon");
 	return MAL_SUCCEED;
 }
+
+/* the per worker statistics of the work-stealing scheduler */
+str
+SYSMONworkers(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	BAT *worker, *executed, *steals, *idle, *depth;
+	int *w = (int*) getArgReference(stk,pci,0);
+	int *x = (int*) getArgReference(stk,pci,1);
+	int *s = (int*) getArgReference(stk,pci,2);
+	int *i = (int*) getArgReference(stk,pci,3);
+	int *d = (int*) getArgReference(stk,pci,4);
+	int k, n = MRnrworkers();
+	MRstat st;
+
+	(void) cntxt;
+	(void) mb;
+	worker = BATnew(TYPE_void, TYPE_int, n);
+	executed = BATnew(TYPE_void, TYPE_lng, n);
+	steals = BATnew(TYPE_void, TYPE_lng, n);
+	idle = BATnew(TYPE_void, TYPE_lng, n);
+	depth = BATnew(TYPE_void, TYPE_int, n);
+	if ( worker == NULL || executed == NULL || steals == NULL || idle == NULL || depth == NULL){
+		if (worker) BBPreleaseref(worker->batCacheid);
+		if (executed) BBPreleaseref(executed->batCacheid);
+		if (steals) BBPreleaseref(steals->batCacheid);
+		if (idle) BBPreleaseref(idle->batCacheid);
+		if (depth) BBPreleaseref(depth->batCacheid);
+		throw(MAL, "SYSMONworkers", MAL_MALLOC_FAIL);
+	}
+	BATseqbase(worker, 0);
+	BATseqbase(executed, 0);
+	BATseqbase(steals, 0);
+	BATseqbase(idle, 0);
+	BATseqbase(depth, 0);
+
+	for ( k = 0; k < n; k++) {
+		MRstatistics(k, &st);
+		BUNappend(worker, &k, FALSE);
+		BUNappend(executed, &st.executed, FALSE);
+		BUNappend(steals, &st.steals, FALSE);
+		BUNappend(idle, &st.idle, FALSE);
+		BUNappend(depth, &st.depth, FALSE);
+	}
+	BBPkeepref( *w = worker->batCacheid);
+	BBPkeepref( *x = executed->batCacheid);
+	BBPkeepref( *s = steals->batCacheid);
+	BBPkeepref( *i = idle->batCacheid);
+	BBPkeepref( *d = depth->batCacheid);
+	return MAL_SUCCEED;
+}
@@ -49,6 +49,7 @@
 #include "monetdb_config.h"
 #include "tablet.h"
 #include "algebra.h"
+#include "gdk_mapreduce.h"
 
 #include <string.h>
 #include <ctype.h>
@@ -869,6 +870,236 @@ output_file_ordered(Tablet *as, BAT *order, stream *fd, oid base)
 	return res;
 }
 
+/*
+ * Parallel export.  Large results are cut into chunks of DUMPCHUNK
+ * rows, which are formatted on the shared workers into buffers of
+ * their own.  Each round also holds one task that writes the chunks of
+ * the previous round in order, so a compressing output stream (e.g. a
+ * .gz file) does its work next to the formatting.
+ * Integer and floating point columns that use the plain atom format
+ * are formatted in place, other columns go through their tostr.
+ */
+#define DUMPCHUNK 16384			/* rows per formatting task */
+
+typedef struct dumptask {
+	MRtask task;				/* scheduler header, must be first */
+	Tablet *as;
+	BATiter *ci;				/* private iterators, one per column */
+	BATiter orderi;
+	BAT *order;					/* NULL for dense output */
+	oid base;
+	BUN lo, hi;					/* rows to format */
+	char *buf;
+	size_t len, fill;
+	char *localbuf;
+	int locallen;
+	int error;
+	stream *fd;					/* the writer: where to */
+	struct dumptask *round;		/* and which chunks */
+	int nround;
+} DUMPtask;
+
+static inline int
+dump_reserve(DUMPtask *t, size_t n)
+{
+	if (t->fill + n > t->len) {
+		size_t len = MAX(2 * t->len, t->fill + n);
+		char *buf = GDKrealloc(t->buf, len);
+
+		if (buf == NULL)
+			return -1;
+		t->buf = buf;
+		t->len = len;
+	}
+	return 0;
+}
+
+/* decimal representation of v, as "%d" would produce it */
+static inline size_t
+dump_lng(char *dst, lng v)
+{
+	char tmp[24], *p = tmp + sizeof(tmp);
+	unsigned long long u = v < 0 ? 0 - (unsigned long long) v : (unsigned long long) v;
+	size_t l;
+
+	do {
+		*--p = (char) ('0' + u % 10);
+		u /= 10;
+	} while (u > 0);
+	if (v < 0)
+		*--p = '-';
+	l = (size_t) (tmp + sizeof(tmp) - p);
+	memcpy(dst, p, l);
+	return l;
+}
+
+static void
+dump_chunk(void *arg)
+{
+	DUMPtask *t = arg;
+	Column *fmt = t->as->format;
+	BUN nr_attrs = t->as->nr_attrs, r, i, id = 0;
+
+	t->fill = 0;
+	for (r = t->lo; r < t->hi; r++) {
+		if (t->order)
+			id = (BUN) (*(oid *) BUNhead(t->orderi, BUNfirst(t->order) + t->as->offset + r) - t->base);
+		for (i = 0; i < nr_attrs; i++) {
+			Column *f = fmt + i;
+
+			if (f->c[0]) {
+				char *p = BUNtail(t->ci[i], t->order ? BUNfirst(f->c[0]) + id : f->p + r);
+				size_t l;
+
+				if (dump_reserve(t, 32) < 0)
+					goto bailout;
+				if (!p || ATOMcmp(f->adt, ATOMnilptr(f->adt), p) == 0) {
+					l = strlen(f->nullstr);
+					if (dump_reserve(t, l) < 0)
+						goto bailout;
+					memcpy(t->buf + t->fill, f->nullstr, l);
+				} else if (f->plain && f->adt == TYPE_bte) {
+					l = dump_lng(t->buf + t->fill, *(bte *) p);
+				} else if (f->plain && f->adt == TYPE_sht) {
+					l = dump_lng(t->buf + t->fill, *(sht *) p);
+				} else if (f->plain && f->adt == TYPE_int) {
+					l = dump_lng(t->buf + t->fill, *(int *) p);
+				} else if (f->plain && f->adt == TYPE_lng) {
+					l = dump_lng(t->buf + t->fill, *(lng *) p);
+				} else if (f->plain && f->adt == TYPE_dbl) {
+					l = (size_t) snprintf(t->buf + t->fill, 32, "%.17g", *(dbl *) p);
+				} else if (f->plain && f->adt == TYPE_flt) {
+					l = (size_t) snprintf(t->buf + t->fill, 32, "%.9g", *(flt *) p);
+				} else {
+					int ll = f->tostr(f->extra, &t->localbuf, &t->locallen, f->adt, p);
+
+					if (ll < 0 || dump_reserve(t, (size_t) ll) < 0)
+						goto bailout;
+					l = (size_t) ll;
+					memcpy(t->buf + t->fill, t->localbuf, l);
+				}
+				t->fill += l;
+			}
+			if (dump_reserve(t, (size_t) f->seplen) < 0)
+				goto bailout;
+			memcpy(t->buf + t->fill, f->sep, f->seplen);
+			t->fill += f->seplen;
+		}
+	}
+	return;
+  bailout:
+	t->error = 1;
+}
+
+static void
+dump_write(DUMPtask *w)
+{
+	int i;
+
+	for (i = 0; i < w->nround && w->error == 0; i++) {
+		if (w->round[i].error)
+			w->error = -1;
+		else if (mnstr_write(w->fd, w->round[i].buf, 1, w->round[i].fill) != (ssize_t) w->round[i].fill)
+			w->error = TABLET_error(w->fd);
+	}
+}
+
+static void
+dump_task(void *arg)
+{
+	DUMPtask *t = arg;
+
+	if (t->round)
+		dump_write(t);
+	else
+		dump_chunk(t);
+}
+
+/* hand the next rows to the tasks of a round, returns the number of
+ * tasks filled */
+static int
+dump_start(DUMPtask *tasks, int ntasks, BUN *next, BUN nr, void **args)
+{
+	int i;
+
+	for (i = 0; i < ntasks && *next < nr; i++) {
+		DUMPtask *t = tasks + i;
+
+		t->lo = *next;
+		t->hi = MIN(*next + DUMPCHUNK, nr);
+		*next = t->hi;
+		args[i] = t;
+	}
+	return i;
+}
+
+static int
+output_file_parallel(Tablet *as, BAT *order, stream *fd, oid base)
+{
+	int nthreads = GDKnr_threads, n[2], i, k, r, res = 0;
+	DUMPtask *tasks = GDKzalloc(2 * nthreads * sizeof(DUMPtask)), writer;
+	void **args = GDKmalloc((nthreads + 1) * sizeof(void *));
+	BUN next = 0, j;
+
+	if (tasks == NULL || args == NULL) {
+		GDKfree(tasks);
+		GDKfree(args);
+		return -1;
+	}
+	memset(&writer, 0, sizeof(writer));
+	writer.fd = fd;
+	for (i = 0; i < 2 * nthreads; i++) {
+		DUMPtask *t = tasks + i;
+
+		t->as = as;
+		t->order = order;
+		t->base = base;
+		if (order)
+			t->orderi = bat_iterator(order);
+		t->len = BUFSIZ;
+		t->locallen = BUFSIZ;
+		if ((t->ci = GDKmalloc(as->nr_attrs * sizeof(BATiter))) == NULL ||
+		    (t->buf = GDKmalloc(t->len)) == NULL ||
+		    (t->localbuf = GDKmalloc(t->locallen)) == NULL) {
+			res = -1;
+			goto bailout;
+		}
+		for (j = 0; j < as->nr_attrs; j++)
+			if (as->format[j].c[0])
+				t->ci[j] = bat_iterator(as->format[j].c[0]);
+	}
+#ifdef _DEBUG_TABLET_
+	mnstr_printf(GDKout, "#parallel dump of " BUNFMT " lines by %d threads\n", as->nr, nthreads);
+#endif
+
+	/* while one round is written, the next one is formatted */
+	n[1] = 0;
+	for (r = 0; ; r++) {
+		k = n[r & 1] = res == 0 ? dump_start(tasks + (r & 1) * nthreads, nthreads, &next, as->nr, args) : 0;
+		writer.round = NULL;
+		if (n[(r + 1) & 1] > 0 && res == 0) {
+			writer.round = tasks + ((r + 1) & 1) * nthreads;
+			writer.nround = n[(r + 1) & 1];
+			args[k++] = &writer;
+		}
+		if (k == 0)
+			break;
+		MRschedule(k, args, dump_task);
+		if (writer.round && writer.error)
+			res = writer.error;
+	}
+
+  bailout:
+	for (i = 0; i < 2 * nthreads; i++) {
+		GDKfree(tasks[i].ci);
+		GDKfree(tasks[i].buf);
+		GDKfree(tasks[i].localbuf);
+	}
+	GDKfree(tasks);
+	GDKfree(args);
+	return res;
+}
+
 int
 TABLEToutput_file(Tablet *as, BAT *order, stream *s)
 {
@@ -885,7 +1116,11 @@ TABLEToutput_file(Tablet *as, BAT *order, stream *s)
 		as->nr = maxnr;
 
 	if ((base = check_BATs(as)) != oid_nil) {
-		if (BAThdense(order) && order->hseqbase == base)
+		int dense = BAThdense(order) && order->hseqbase == base;
+
+		if (GDKnr_threads > 1 && as->nr >= 2 * DUMPCHUNK)
+			ret = output_file_parallel(as, dense ? NULL : order, s, base);
+		else if (dense)
 			ret = output_file_dense(as, s);
 		else
 			ret = output_file_ordered(as, order, s, base);
@@ -921,6 +1156,17 @@ TABLEToutput_file(Tablet *as, BAT *order, stream *s)
  *
  * The work divider allocates subtasks to threads based on the
  * observed time spending so far.
+ *
+ * Large buffers are instead cut into one byte range per worker, and
+ * each worker does all the work for the records that start in its
+ * range.  First every worker counts the quotes in its range, which
+ * tells where a range starts inside a quoted field; then each one
+ * collects its records, breaks them into fields and converts the
+ * fixed width columns straight into their place in the BATs, which
+ * keeps the input order.  Variable sized columns can't be filled
+ * concurrently, they are appended one column per worker, walking the
+ * ranges in order.  The minimal range size (in K) is taken from
+ * copy_splitsize, where a non-positive value disables the split.
  */
 
 /* #define _DEBUG_TABLET_*/
@@ -928,8 +1174,14 @@ TABLEToutput_file(Tablet *as, BAT *order, stream *s)
 
 #define BREAKLINE 1
 #define UPDATEBAT 2
+#define SPLITLINE 3
+#define SPLITQUOTE 4
+#define SPLITPARSE 5
+#define SPLITCONVERT 6
 
-typedef struct {
+#define SPLITSIZE 64			/* minimal range per worker in K */
+
+typedef struct readertask {
 	int id;						/* for self reference */
 	int state;					/* line break=1 , 2 = update bat */
 	int workers;				/* how many concurrent ones */
@@ -955,6 +1207,18 @@ typedef struct {
 	size_t basesize;
 	int *cols;					/* columns to handle */
 	char ***fields;
+	char *lo, *hi;				/* byte range to split */
+	char *sob, *eob;			/* start of the records, end of buffer */
+	struct readertask *ranges;	/* the tasks of all ranges */
+	int quotes;					/* odd number of quotes in the range */
+	int inquote;				/* range starts inside a quoted field */
+	char **lines;				/* record start/end pairs found in range */
+	int nlines, maxlines;
+	int first, last;			/* records of the range taken */
+	BUN row;					/* row of the first one in the load */
+	char ***rfields;			/* fields of the records taken */
+	int rlimit;
+	int ambiguous;				/* range can not be split */
 } READERtask;
 
 /*
@@ -997,13 +1261,12 @@ SQLload_error(READERtask *task, int idx)
  * If the string starts with the quote identified from SQL, we locate the tail
  * and interpret the body.
  */
-static inline int
-SQLinsert_val(Column *fmt, char *s, char quote, ptr key, str *err, int col)
+static inline ptr
+SQLconvert_val(Column *fmt, char *s, char quote, str *err, BUN line, int col)
 {
 	ptr *adt;
 	char buf[BUFSIZ];
 	char *e, *t;
-	int ret = 0;
 
 	/* include testing on the terminating null byte !! */
 	if (fmt->nullstr && strncasecmp(s, fmt->nullstr, fmt->null_length + 1) == 0) {
@@ -1041,14 +1304,27 @@ SQLinsert_val(Column *fmt, char *s, char quote, ptr key, str *err, int col)
 						 " field %d not inserted, expecting type %s\n",
 						 BUFSIZ - 200, val,
 						 strlen(val) > (size_t) BUFSIZ - 200 ? "..." : "",
-						 BATcount(fmt->c[0]) + 1, col, fmt->type) < 0)
+						 line, col, fmt->type) < 0)
 				snprintf(buf, BUFSIZ,
 						 "value from line " BUNFMT
 						 " field %d not inserted, expecting type %s\n",
-						 BATcount(fmt->c[0]) + 1, col, fmt->type);
+						 line, col, fmt->type);
 			*err = GDKstrdup(buf);
 		}
 		GDKfree(val);
+		return NULL;
+	}
+	return adt;
+}
+
+static inline int
+SQLinsert_val(Column *fmt, char *s, char quote, ptr key, str *err, int col)
+{
+	ptr adt;
+	char buf[BUFSIZ];
+	int ret = 0;
+
+	if ((adt = SQLconvert_val(fmt, s, quote, err, BATcount(fmt->c[0]) + 1, col)) == NULL) {
 		/* replace it with a nil */
 		adt = fmt->nildata;
 		fmt->c[0]->T->nonil = 0;
@@ -1071,8 +1347,9 @@ SQLinsert_val(Column *fmt, char *s, char quote, ptr key, str *err, int col)
 	return -1;
 }
 
+/* append the values fields[0..n) to column col */
 static int
-SQLworker_column(READERtask *task, int col)
+SQLappend_column(READERtask *task, int col, char **fields, int n)
 {
 	int i;
 	Column *fmt = task->as->format;
@@ -1080,8 +1357,8 @@ SQLworker_column(READERtask *task, int col)
 
 	/* watch out for concurrent threads */
 	MT_lock_set(&mal_copyLock, "tablet insert value");
-	if (BATcapacity(fmt[col].c[0]) < BATcount(fmt[col].c[0]) + task->next) {
-		if ((fmt[col].c[0] = BATextend(fmt[col].c[0], BATgrows(fmt[col].c[0]) + task->limit)) == NULL) {
+	if (BATcapacity(fmt[col].c[0]) < BATcount(fmt[col].c[0]) + n) {
+		if ((fmt[col].c[0] = BATextend(fmt[col].c[0], BATgrows(fmt[col].c[0]) + MAX(task->limit, n))) == NULL) {
 			if (task->as->error == NULL)
 				task->as->error = GDKstrdup("Failed to extend the BAT, perhaps disk full");
 			MT_lock_unset(&mal_copyLock, "tablet insert value");
@@ -1091,9 +1368,9 @@ SQLworker_column(READERtask *task, int col)
 	}
 	MT_lock_unset(&mal_copyLock, "tablet insert value");
 
-	for (i = 0; i < task->next; i++)
-		if (task->fields[col][i]) {	/* no errors */
-			if (SQLinsert_val(&fmt[col], task->fields[col][i], task->quote, NULL, &err, col + 1)) {
+	for (i = 0; i < n; i++)
+		if (fields[i]) {	/* no errors */
+			if (SQLinsert_val(&fmt[col], fields[i], task->quote, NULL, &err, col + 1)) {
 				assert(err != NULL);
 				MT_lock_set(&mal_copyLock, "tablet insert value");
 				if (!task->as->tryall) {
@@ -1117,6 +1394,12 @@ SQLworker_column(READERtask *task, int col)
 	return err ? -1 : 0;
 }
 
+static int
+SQLworker_column(READERtask *task, int col)
+{
+	return SQLappend_column(task, col, task->fields[col], task->next);
+}
+
 /*
  * The lines are broken on the column separator. Any error is shown and reflected with
  * setting the reference of the offending row fields to NULL.
@@ -1193,6 +1476,227 @@ SQLload_file_line(READERtask *task, int idx)
 	return as->error ? -1 : 0;
 }
 
+/*
+ * Splitting a buffer in ranges.  The column separator, quote and escape
+ * handling are those of the scan in SQLload_file: a quote toggles
+ * between inside and outside a quoted field, a backslash escapes the
+ * next byte, and a record ends on an unquoted, unescaped record
+ * separator.  Records start outside quotes, so the state at the start
+ * of a range follows from the number of quotes in front of it, and
+ * whether it is escaped from the backslashes just in front of it.
+ */
+static inline int
+SQLsplit_escaped(READERtask *task, char *p)
+{
+	char *b = p;
+
+	while (b > task->sob && b[-1] == '\\')
+		b--;
+	return (int) ((p - b) & 1);
+}
+
+static void
+SQLsplit_quotes(READERtask *task)
+{
+	char *e = task->lo + SQLsplit_escaped(task, task->lo);
+	char quote = task->quote;
+	int n = 0;
+
+	for (; e < task->hi; e++)
+		if (*e == '\\')
+			e++;
+		else if (*e == quote)
+			n ^= 1;
+	task->quotes = n;
+}
+
+/* the end of the record or field that continues at e, in quote state q */
+static inline char *
+SQLsplit_record(READERtask *task, char *e, char q)
+{
+	char rs = *task->rsep, quote = task->quote;
+	size_t rseplen = task->rseplen;
+
+	for (; *e; e++) {
+		if (q) {
+			if (*e == q)
+				q = 0;
+			else if (*e == '\\' && e[1])
+				e++;
+		} else if (quote && *e == quote) {
+			q = quote;
+		} else if (*e == '\\') {
+			if (e[1])
+				e++;
+		} else if (*e == rs && (rseplen == 1 || strncmp(e, task->rsep, rseplen) == 0))
+			return e;
+	}
+	/* a nonterminated record is left for the next buffer, a null
+	 * byte in the middle is for the serial scan to report */
+	task->ambiguous |= e != task->eob;
+	return NULL;
+}
+
+/*
+ * A range owns all records that start within it.  The first one starts
+ * after the first record separator that ends in the range, or right
+ * before it.  One that started in front of the range is recognised as
+ * such, as the split is only used for separators that hold no quotes or
+ * escapes, and can't overlap.
+ */
+static void
+SQLsplit_range(READERtask *task)
+{
+	char *s = task->lo, *e;
+	size_t k;
+
+	task->nlines = 0;
+	task->ambiguous = 0;
+	if (s > task->sob) {
+		e = NULL;
+		for (k = task->rseplen; k > 0 && e == NULL; k--)
+			if (s - k >= task->sob && !task->inquote &&
+				strncmp(s - k, task->rsep, task->rseplen) == 0 &&
+				!SQLsplit_escaped(task, s - k))
+				e = s - k;
+		if (e == NULL) {
+			s += SQLsplit_escaped(task, s);
+			if ((e = SQLsplit_record(task, s, task->inquote ? task->quote : 0)) == NULL)
+				return;
+		}
+		s = e + task->rseplen;
+	}
+	for (; s < task->hi; s = e + task->rseplen) {
+		if ((e = SQLsplit_record(task, s, 0)) == NULL)
+			return;
+		if (task->nlines + 2 > task->maxlines) {
+			int n = task->maxlines ? 2 * task->maxlines : 1024;
+			char **l = GDKrealloc(task->lines, n * sizeof(char *));
+
+			if (l == NULL) {
+				task->ambiguous = 1;
+				return;
+			}
+			task->lines = l;
+			task->maxlines = n;
+		}
+		task->lines[task->nlines++] = s;
+		task->lines[task->nlines++] = e;
+	}
+}
+
+/* break the records taken from the range into fields */
+static int
+SQLsplit_parse(READERtask *task)
+{
+	int i, n = task->last - task->first;
+	unsigned int c;
+
+	/* one more, error reports look one past the records */
+	if (n + 1 > task->rlimit) {
+		for (c = 0; c < task->as->nr_attrs; c++) {
+			char **f = GDKrealloc(task->rfields[c], (n + 1) * sizeof(char *));
+
+			if (f == NULL) {
+				MT_lock_set(&mal_copyLock, "tablet line break");
+				if (task->as->error == NULL)
+					task->as->error = M5OutOfMemory;
+				MT_lock_unset(&mal_copyLock, "tablet line break");
+				return -1;
+			}
+			task->rfields[c] = f;
+		}
+		task->rlimit = n + 1;
+	}
+	for (c = 0; c < task->as->nr_attrs; c++)
+		task->rfields[c][n] = NULL;
+	for (i = 0; i < n; i++) {
+		task->rfields[0][i] = task->lines[2 * (task->first + i)];
+		*task->lines[2 * (task->first + i) + 1] = '\0';
+	}
+	task->fields = task->rfields;
+	task->next = n;
+	for (i = 0; i < n; i++)
+		if (SQLload_file_line(task, i) < 0)
+			return -1;
+	return 0;
+}
+
+/* columns filled in place by the ranges, the others are appended */
+static inline int
+SQLsplit_fixed(Column *fmt)
+{
+	return !ATOMvarsized(fmt->adt) && fmt->raw == NULL;
+}
+
+/*
+ * Convert the fixed width columns of the records of a range into the
+ * room the caller made for them in the BATs.  The conversion buffer
+ * of the column is shared, each range uses one of its own.
+ */
+static void
+SQLsplit_convert(READERtask *task)
+{
+	Tablet *as = task->as;
+	unsigned int c;
+	int i, n = task->last - task->first;
+
+	for (c = 0; c < as->nr_attrs; c++) {
+		Column fmt = as->format[c];
+		BAT *b = fmt.c[0];
+		int width = Tsize(b);
+		char *dst = Tloc(b, BUNlast(b) + task->row);
+		str err = NULL;
+		ptr adt;
+
+		if (!SQLsplit_fixed(&fmt))
+			continue;
+		fmt.data = NULL;
+		fmt.len = 0;
+		for (i = 0; i < n; i++, dst += width) {
+			adt = SQLconvert_val(&fmt, task->fields[c][i], task->quote, &err, BATcount(b) + task->row + i + 1, (int) c + 1);
+			if (adt == NULL) {
+				adt = fmt.nildata;
+				b->T->nonil = 0;
+			}
+			memcpy(dst, adt, width);
+		}
+		GDKfree(fmt.data);
+		if (err) {
+			MT_lock_set(&mal_copyLock, "tablet insert value");
+			if (as->tryall)
+				BUNins(as->complaints, NULL, err, TRUE);
+			if (as->error == NULL)
+				as->error = err;
+			else
+				GDKfree(err);
+			MT_lock_unset(&mal_copyLock, "tablet insert value");
+		}
+	}
+}
+
+/* append the variable sized columns of this worker, range by range */
+static void
+SQLsplit_append(READERtask *task)
+{
+	unsigned int i;
+	int r;
+	lng t0;
+
+	for (i = 0; i < task->as->nr_attrs; i++) {
+		int col = task->cols[i] - 1;
+
+		if (task->cols[i] == 0 || SQLsplit_fixed(&task->as->format[col]))
+			continue;
+		t0 = GDKusec();
+		for (r = 0; r < task->workers; r++)
+			if (SQLappend_column(task, col, task->ranges[r].rfields[col],
+								 task->ranges[r].last - task->ranges[r].first) < 0)
+				break;
+		task->time[i] += GDKusec() - t0;
+	}
+}
+
 static void
 SQLworker(void *arg)
 {
@@ -1239,7 +1743,26 @@ SQLworker(void *arg)
 						task->error++;
 						break;
 					}
-			task->wtime = GDKusec() - t0;
+			task->wtime += GDKusec() - t0;
+		} else if (task->state == SPLITQUOTE) {
+			t0 = GDKusec();
+			SQLsplit_quotes(task);
+			task->wtime += GDKusec() - t0;
+		} else if (task->state == SPLITLINE) {
+			t0 = GDKusec();
+			SQLsplit_range(task);
+			task->wtime += GDKusec() - t0;
+		} else if (task->state == SPLITPARSE) {
+			t0 = GDKusec();
+			if (task->last > task->first && SQLsplit_parse(task) < 0)
+				task->error++;
+			task->wtime += GDKusec() - t0;
+		} else if (task->state == SPLITCONVERT) {
+			t0 = GDKusec();
+			if (task->last > task->first)
+				SQLsplit_convert(task);
+			SQLsplit_append(task);
+			task->wtime += GDKusec() - t0;
 		} else if (task->state == UPDATEBAT)
 			/* stage two, updating the BATs */
 			for (i = 0; i < task->as->nr_attrs; i++)
@@ -1341,6 +1864,120 @@ SQLloader(void *p)
 	}
 }
 
+static void
+SQLsplit_free(READERtask *task, int all)
+{
+	unsigned int c;
+
+	GDKfree(task->lines);
+	task->lines = NULL;
+	task->nlines = task->maxlines = 0;
+	if (all && task->rfields) {
+		for (c = 0; c < task->as->nr_attrs; c++)
+			GDKfree(task->rfields[c]);
+		GDKfree(task->rfields);
+		task->rfields = NULL;
+		task->rlimit = 0;
+	}
+}
+
+/* run one stage on all workers and wait for them; returns the errors */
+static int
+SQLsplit_stage(READERtask *ptask, int threads, int state)
+{
+	int j, error = 0;
+
+	for (j = 0; j < threads; j++) {
+		ptask[j].state = state;
+		ptask[j].error = 0;
+		MT_sema_up(&ptask[j].sema, "SQLsplit_stage");
+	}
+	for (j = 0; j < threads; j++) {
+		MT_sema_down(&ptask[j].reply, "SQLsplit_stage");
+		error += ptask[j].error;
+	}
+	return error;
+}
+
+/*
+ * Load the records in the buffer in ranges, skipping tuples as needed.
+ * It returns 0 if the buffer could not be split, leaving the buffer
+ * untouched, -1 on errors, and 1 when all complete records are loaded.
+ */
+static int
+SQLsplit_buffer(READERtask *task, READERtask *ptask, int threads, char *s, char *end, lng *skip, BUN *cnt, lng maxrow)
+{
+	size_t piece = (size_t) (end - s + threads - 1) / threads;
+	Column *fmt = task->as->format;
+	int j, n, q, ambiguous = 0;
+	BUN i, total = 0;
+
+	for (j = 0; j < threads; j++) {
+		ptask[j].lo = s + j * piece;
+		ptask[j].hi = j == threads - 1 ? end : ptask[j].lo + piece;
+		ptask[j].sob = s;
+		ptask[j].eob = end;
+		ptask[j].inquote = 0;
+		ptask[j].first = ptask[j].last = 0;
+	}
+	if (task->quote) {
+		SQLsplit_stage(ptask, threads, SPLITQUOTE);
+		for (q = 0, j = 0; j < threads; j++) {
+			ptask[j].inquote = q;
+			q ^= ptask[j].quotes;
+		}
+	}
+	SQLsplit_stage(ptask, threads, SPLITLINE);
+	for (j = 0; j < threads; j++)
+		ambiguous |= ptask[j].ambiguous;
+	if (ambiguous) {
+		/* the serial scan takes over, don't keep the lines */
+		for (j = 0; j < threads; j++)
+			SQLsplit_free(&ptask[j], 0);
+		return 0;
+	}
+
+	/* the records to take from each range */
+	for (j = 0; j < threads && (maxrow < 0 || *cnt < (BUN) maxrow); j++) {
+		n = ptask[j].nlines / 2;
+		if (*skip > 0) {
+			ptask[j].first = *skip < n ? (int) *skip : n;
+			*skip -= ptask[j].first;
+		}
+		ptask[j].last = n;
+		if (maxrow >= 0 && *cnt + (n - ptask[j].first) > (BUN) maxrow)
+			ptask[j].last = ptask[j].first + (int) ((BUN) maxrow - *cnt);
+		ptask[j].row = total;
+		total += ptask[j].last - ptask[j].first;
+		*cnt += ptask[j].last - ptask[j].first;
+		if (ptask[j].last > 0)
+			task->b->pos = (size_t) (ptask[j].lines[2 * ptask[j].last - 1] + task->rseplen - task->input);
+	}
+	if (total == 0)
+		return 1;
+
+	if (SQLsplit_stage(ptask, threads, SPLITPARSE))
+		return -1;
+	/* room for the fixed width columns */
+	for (i = 0; i < task->as->nr_attrs; i++) {
+		BAT *b = fmt[i].c[0];
+
+		if (SQLsplit_fixed(&fmt[i]) && BATcapacity(b) < BATcount(b) + total &&
+			(fmt[i].c[0] = b = BATextend(b, BATgrows(b) + total)) == NULL) {
+			if (task->as->error == NULL)
+				task->as->error = GDKstrdup("Failed to extend the BAT, perhaps disk full");
+			return -1;
+		}
+	}
+	SQLworkdivider(task, ptask, (int) task->as->nr_attrs, threads);
+	SQLsplit_stage(ptask, threads, SPLITCONVERT);
+	for (i = 0; i < task->as->nr_attrs; i++)
+		if (SQLsplit_fixed(&fmt[i]))
+			BATsetcount(fmt[i].c[0], BATcount(fmt[i].c[0]) + total);
+	/* conversion errors are reported as the serial updates do */
+	return 1;
+}
+
 BUN
 SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out, char *csep, char *rsep, char quote, lng skip, lng maxrow)
 {
@@ -1351,15 +1988,14 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out, char *csep, char
 	BUN i;
 	size_t rseplen;
 	READERtask *task = (READERtask *) GDKzalloc(sizeof(READERtask));
-	READERtask ptask[16];
-	int threads = (!maxrow || maxrow > (1 << 16)) ? (GDKnr_threads < 16 ? GDKnr_threads : 16) : 1;
+	READERtask *ptask = NULL;
+	int threads = (maxrow <= 0 || maxrow > (1 << 16)) ? GDKnr_threads : 1;
+	int splitsize = GDKgetenv_int("copy_splitsize", SPLITSIZE);
+	size_t split = splitsize > 0 ? (size_t) splitsize * 1024 : 0;
 	lng lio = 0, tio, t1 = 0, total = 0, iototal = 0;
 	int vmtrim = GDK_vm_trim;
 	str msg = MAL_SUCCEED;
 
-	for (i = 0; i < 16; i++)
-		ptask[i].cols = 0;
-
 	if (task == 0) {
 		as->error = M5OutOfMemory;
 		return BUN_NONE;
@@ -1409,9 +2045,26 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out, char *csep, char
 #endif
 	as->error = NULL;
 
-	/* there is no point in creating more threads than we have columns */
-	if (as->nr_attrs < (BUN) threads)
+	/* the split scans the records on its own, keep it to the plain
+	 * separators and columns */
+	if (quote == '\\' || strchr(rsep, '\\') || (quote && strchr(rsep, quote)))
+		split = 0;
+	for (i = 1; i < (BUN) rseplen && split; i++)
+		if (strncmp(rsep, rsep + rseplen - i, i) == 0)
+			split = 0;			/* separators could overlap */
+	for (i = 0; i < as->nr_attrs && split; i++)
+		if (as->format[i].c[0] == NULL || as->format[i].raw)
+			split = 0;
+
+	/* there is no point in creating more threads than we have columns,
+	 * unless they can share the record split */
+	if (as->nr_attrs < (BUN) threads && split == 0)
 		threads = (int) as->nr_attrs;
+	ptask = (READERtask *) GDKzalloc(threads * sizeof(READERtask));
+	if (ptask == 0) {
+		as->error = M5OutOfMemory;
+		goto bailout;
+	}
 
 	/* allocate enough space for pointers into the buffer pool.  */
 	/* the record separator is considered a column */
@@ -1436,7 +2089,10 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out, char *csep, char
 		ptask[j] = *task;
 		ptask[j].id = j;
 		ptask[j].cols = (int *) GDKzalloc(as->nr_attrs * sizeof(int));
-		if (ptask[j].cols == 0) {
+		ptask[j].ranges = ptask;
+		if (split)
+			ptask[j].rfields = (char ***) GDKzalloc(as->nr_attrs * sizeof(char **));
+		if (ptask[j].cols == 0 || (split && ptask[j].rfields == 0)) {
 			as->error = M5OutOfMemory;
 			goto bailout;
 		}
@@ -1513,6 +2169,15 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out, char *csep, char
 		 * the middle of the record separator).  If this is too
 		 * costly, we have to rethink the matter. */
 		e = s;
+		if (threads > 1 && split && (size_t) (end - s) >= threads * split) {
+			switch (SQLsplit_buffer(task, ptask, threads, s, end, &skip, &cnt, maxrow)) {
+			case -1:
+				res = -1;
+				/* fall through */
+			case 1:
+				s = end;		/* all complete records are loaded */
+			}
+		}
 		while (s < end && (maxrow < 0 || cnt < (BUN) maxrow)) {
 			char q = 0;
 			/* tokenize the record completely the format of the input
@@ -1687,10 +2352,12 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out, char *csep, char
 	for (j = 0; j < threads; j++) {
 		MT_join_thread(ptask[j].tid);
 		GDKfree(ptask[j].cols);
+		SQLsplit_free(&ptask[j], 1);
 		MT_sema_destroy(&ptask[j].sema);
 		MT_sema_destroy(&ptask[j].reply);
 	}
 	MT_join_thread(task->tid);
+	GDKfree(ptask);
 
 #ifdef _DEBUG_TABLET_
 	mnstr_printf(GDKout, "Found " BUNFMT " tuples\n", cnt);
@@ -1728,9 +2395,14 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out, char *csep, char
 			GDKfree(task->base);
 		GDKfree(task);
 	}
-	for (i = 0; i < 16; i++)
-		if (ptask[i].cols)
-			GDKfree(ptask[i].cols);
+	if (ptask) {
+		for (j = 0; j < threads; j++) {
+			if (ptask[j].cols)
+				GDKfree(ptask[j].cols);
+			SQLsplit_free(&ptask[j], 1);
+		}
+		GDKfree(ptask);
+	}
 #ifdef MLOCK_TST
 	munlockall();
 #endif
@@ -85,6 +85,7 @@ typedef struct Column_t {
 	int nillen;
 	bit ws;						/* if set we need to skip white space */
 	bit quote;					/* if set use this character for string quotes */
+	bit plain;					/* tostr is the plain atom format */
 	void *nildata;
 	str batfile;				/* what is the BAT to be replaced */
 	str rawfile;				/* where to find the raw file */
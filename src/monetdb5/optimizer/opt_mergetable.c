@@ -1302,6 +1302,7 @@ OPTmergetableImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr
 	mat_t *mat;
 	int oldtop, fm, fn, fo, fe, i, k, m, n, o, e, mtop=0, slimit;
 	int size=0, match, actions=0, distinct_topn = 0, topn_res = 0, groupdone = 0, *vars;
+	int holistic = 0, setops = 1;
 
 	old = mb->stmt;
 	oldtop= mb->stop;
@@ -1327,6 +1328,24 @@ OPTmergetableImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr
 				groupdone = 1;
 		}
 
+		/* aggregates that cannot be computed from per partition
+		 * results need the groups of the whole relation, so we
+		 * pack before grouping */
+		if (getModuleId(p) == aggrRef && p->argc > 3 &&
+		    getFunctionId(p) != subcountRef &&
+		    getFunctionId(p) != subminRef &&
+		    getFunctionId(p) != submaxRef &&
+		    getFunctionId(p) != subavgRef &&
+		    getFunctionId(p) != subsumRef &&
+		    getFunctionId(p) != subprodRef)
+			holistic = 1;
+
+		/* intersect/except count duplicates with a groupby over
+		 * the result of the set operation, which needs the
+		 * packed inputs */
+		if (getModuleId(p) == algebraRef && getFunctionId(p) == groupbyRef)
+			setops = 0;
+
 		if (isTopn(p))
 			topn_res = getArg(p, 0);
 		if (getModuleId(p) == algebraRef && getFunctionId(p) == markTRef && getArg(p, 1) == topn_res)
@@ -1431,14 +1450,14 @@ OPTmergetableImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr
 		}
 
 		/* Now we handle subgroup and aggregation statements. */
-		if (!groupdone && match == 1 && bats == 1 && p->argc == 4 && getModuleId(p) == groupRef && 
+		if (!groupdone && !holistic && match == 1 && bats == 1 && p->argc == 4 && getModuleId(p) == groupRef && 
 		   (getFunctionId(p) == subgroupRef || getFunctionId(p) == subgroupdoneRef) && 
 	 	   ((m=is_a_mat(getArg(p,p->retc), mat, mtop)) >= 0)) {
 			mtop = mat_group_new(mb, p, mat, mtop, m);
 			actions++;
 			continue;
 		}
-		if (!groupdone && match == 2 && bats == 2 && p->argc == 5 && getModuleId(p) == groupRef && 
+		if (!groupdone && !holistic && match == 2 && bats == 2 && p->argc == 5 && getModuleId(p) == groupRef && 
 		   (getFunctionId(p) == subgroupRef || getFunctionId(p) == subgroupdoneRef) && 
 		   ((m=is_a_mat(getArg(p,p->retc), mat, mtop)) >= 0) &&
 		   ((n=is_a_mat(getArg(p,p->retc+1), mat, mtop)) >= 0) && 
@@ -1493,7 +1512,7 @@ OPTmergetableImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr
 			continue;
 		}
 		/* Handle setops */
-		if (match > 0 && getModuleId(p) == algebraRef &&
+		if (setops && match > 0 && getModuleId(p) == algebraRef &&
 		    (getFunctionId(p) == tdiffRef || 
 		     getFunctionId(p) == tinterRef) && 
 		   (m=is_a_mat(getArg(p,1), mat, mtop)) >= 0) { 
@@ -39,6 +39,33 @@ eligible(MalBlkPtr mb)
 	return 1;
 }
 
+/*
+ * The footprint of a row of the target table: the sum of the widths of
+ * all its columns used in the plan.  Var-sized columns are charged an
+ * average value size on top of their offset.
+ */
+static int
+rowsize(MalBlkPtr mb, str schema, str table)
+{
+	int i, tpe, size = 0;
+	InstrPtr p;
+
+	for (i = 1; i < mb->stop; i++) {
+		p = getInstrPtr(mb, i);
+		if (getModuleId(p) != sqlRef || getFunctionId(p) != bindRef ||
+			p->retc != 1 || p->argc != 6 ||
+			getVarConstant(mb, getArg(p, 5)).val.ival == 1 ||
+			strcmp(schema, getVarConstant(mb, getArg(p, 2)).val.sval) ||
+			strcmp(table, getVarConstant(mb, getArg(p, 3)).val.sval))
+			continue;
+		tpe = getTailType(getArgType(mb, p, 0));
+		size += ATOMsize(tpe);
+		if (ATOMvarsized(tpe))
+			size += VARROWSIZE;
+	}
+	return size;
+}
+
 int
 OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 {
@@ -46,8 +73,7 @@ OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 	str schema = 0, table = 0;
 	wrd r = 0, rowcnt = 0;    /* table should be sizeable to consider parallel execution*/
 	InstrPtr q, *old, target = 0;
-	size_t argsize = 6 * sizeof(lng);
-	/*     per op:   6 = (2+1)*2   <=  2 args + 1 res, each with head & tail */
+	lng rowbytes, cache;
 	int threads = GDKnr_threads ? GDKnr_threads : 1;
 
 	(void) cntxt;
@@ -59,25 +85,14 @@ OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 	for (i = 1; i < mb->stop; i++) {
 		InstrPtr p = old[i];
 
-		/* mitosis/mergetable bailout conditions */
-		
-		/* Mergetable cannot handle order related batcalc ops */
-		if ((getModuleId(p) == batcalcRef || getModuleId(p) == sqlRef) && 
-		   (getFunctionId(p) == rankRef || getFunctionId(p) == rank_grpRef ||
-		    getFunctionId(p) == mark_grpRef || getFunctionId(p) == dense_rank_grpRef)) 
-			return 0;
-
-		if (p->argc > 2 && getModuleId(p) == aggrRef && 
-		        getFunctionId(p) != subcountRef &&
-		    	getFunctionId(p) != subminRef &&
-		    	getFunctionId(p) != submaxRef &&
-		    	getFunctionId(p) != subavgRef &&
-		    	getFunctionId(p) != subsumRef &&
-		    	getFunctionId(p) != subprodRef)
-			return 0;
-		/* Mergetable cannot handle intersect/except's for now */
-		if (getModuleId(p) == algebraRef && getFunctionId(p) == groupbyRef) 
-			return 0;
+		/*
+		 * Order dependent operators (rank, mark), holistic
+		 * aggregates and the groupby of intersect/except used to
+		 * disable mitosis altogether.  The mergetable optimizer
+		 * now packs the partitions before them, such that the
+		 * partitioned scans and joins below them still run in
+		 * parallel.
+		 */
 
 		/* locate the largest non-partitioned table */
 		if (getModuleId(p) != sqlRef || getFunctionId(p) != bindRef)
@@ -94,8 +109,6 @@ OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 		 */
 		r = getVarRows(mb, getArg(p, 0));
 		if (r >= rowcnt) {
-			/* the rowsize depends on the column types, assume void-headed */
-			row_size = ATOMsize(getTailType(getArgType(mb,p,0)));
 			rowcnt = r;
 			target = p;
 			estimate++;
@@ -104,24 +117,39 @@ OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 	}
 	if (target == 0)
 		return 0;
+	schema = getVarConstant(mb, getArg(target, 2)).val.sval;
+	table = getVarConstant(mb, getArg(target, 3)).val.sval;
+	row_size = rowsize(mb, schema, table);
+	if (row_size == 0)
+		row_size = ATOMsize(getTailType(getArgType(mb, target, 0)));
 	/*
 	 * The number of pieces should be based on the footprint of the
 	 * queryplan, such that preferrably it can be handled without
-	 * swapping intermediates.  For the time being we just go for pieces
-	 * that fit into memory in isolation.  A fictive rowcount is derived
-	 * based on argument types, such that all pieces would fit into
-	 * memory conveniently for processing. We attempt to use not more
-	 * threads than strictly needed.
-	 * Experience shows that the pieces should not be too small.
-	 * If we should limit to |threads| is still an open issue.
+	 * swapping intermediates.  A row costs the columns of the target
+	 * table used in the plan, plus an oid for each of the (about
+	 * three) candidate lists and projections derived from them.
+	 * Three constraints determine the number of pieces:
+	 * - the |threads| pieces processed at a time fit into the memory
+	 *   budget (GDK_mem_maxsize);
+	 * - every thread gets at least one piece, as long as pieces are
+	 *   not too small (MINPARTCNT);
+	 * - where possible, a piece's working set fits in the thread's
+	 *   share of the last level cache, such that the operators on a
+	 *   piece run from cache (pieces of at least MINCACHEPARTCNT rows,
+ *   at most MAXROUNDS pieces per thread).
+	 * The number is rounded up to a multiple of |threads|, such that
+	 * all threads get the same amount of work.
 	 */
+	rowbytes = row_size + 3 * (lng) sizeof(oid);
 	if ((i = OPTlegAdviceInternal(mb, stk, p)) > 0)
 		pieces = i;
 	else {
-		r = (wrd) (monet_memory / argsize);
+		lng mem = (lng) GDK_mem_maxsize;
+
+		r = (wrd) (mem / rowbytes);
 		/* if data exceeds memory size,
-		 * i.e., (rowcnt*argsize > monet_memory),
-		 * i.e., (rowcnt > monet_memory/argsize = r) */
+		 * i.e., (rowcnt*rowbytes > mem),
+		 * i.e., (rowcnt > mem/rowbytes = r) */
 		if (rowcnt > r && r / threads > 0) {
 			/* create |pieces| > |threads| partitions such that
 			 * |threads| partitions at a time fit in memory,
@@ -135,6 +163,17 @@ OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 		 * limit overhead */
 			pieces = (int) MIN((rowcnt / MINPARTCNT), (wrd) threads);
 		}
+		/* go for cache sized pieces, if they are not too small;
+		 * a thread's share of the cache holds far fewer than
+		 * MINPARTCNT rows, hence the lower bound MINCACHEPARTCNT;
+		 * more than a few rounds of pieces per thread only blows
+		 * up the plan */
+		cache = (lng) MT_cachesize() / threads;
+		if (pieces >= threads && cache / rowbytes >= MINCACHEPARTCNT &&
+			rowcnt / (cache / rowbytes) > pieces)
+			pieces = (int) MIN(rowcnt / (cache / rowbytes) + 1, (wrd) (MAXROUNDS * threads));
+		if (pieces > threads && pieces % threads)
+			pieces += threads - pieces % threads;
 		/* when testing, always aim for full parallelism, but avoid
 		 * empty pieces */
 		FORCEMITODEBUG
@@ -159,9 +198,9 @@ OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 							   " with " SSZFMT " rows of size %d into " SSZFMT 
 								" rows/piece %d threads %d pieces"
 								" fixed parts %d fixed size %d\n",
-				 getVarConstant(mb, getArg(target, 2)).val.sval,
-				 getVarConstant(mb, getArg(target, 3)).val.sval,
-				 rowcnt, row_size, r, threads, pieces, mito_parts, mito_size);
+				 schema, table,
+				 rowcnt, row_size, pieces > 0 ? rowcnt / pieces : rowcnt,
+				 threads, pieces, mito_parts, mito_size);
 	if (pieces <= 1)
 		return 0;
 
@@ -170,8 +209,6 @@ OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 		return 0;
 	estimate = 0;
 
-	schema = getVarConstant(mb, getArg(target, 2)).val.sval;
-	table = getVarConstant(mb, getArg(target, 3)).val.sval;
 	for (i = 0; i < limit; i++) {
 		int upd = 0, qtpe, rtpe = 0, qv, rv;
 		InstrPtr matq, matr = NULL;
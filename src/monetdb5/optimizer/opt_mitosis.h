@@ -23,6 +23,9 @@
 
 #define MAXSLICES 256		/* to be refined */
 #define MINPARTCNT 100000	/* minimal record count per partition */
+#define MINCACHEPARTCNT 10000	/* minimal record count per cache sized partition */
+#define MAXROUNDS 4		/* cache sized pieces per thread */
+#define VARROWSIZE 16		/* assumed average size of a var-sized value */
 
 opt_export int OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p);
 
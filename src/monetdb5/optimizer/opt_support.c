@@ -827,7 +827,8 @@ int isAllScalar(MalBlkPtr mb, InstrPtr p)
  */
 int isMapOp(InstrPtr p){
 	return	(getModuleId(p) == malRef && getFunctionId(p) == multiplexRef) ||
-		(getModuleId(p)== batcalcRef && getFunctionId(p) != mark_grpRef && getFunctionId(p) != rank_grpRef) ||
+		(getModuleId(p)== batcalcRef && getFunctionId(p) != mark_grpRef && getFunctionId(p) != rank_grpRef &&
+		 getFunctionId(p) != dense_rank_grpRef && getFunctionId(p) != rankRef) ||
 		(getModuleId(p)== batmtimeRef) ||
 		(getModuleId(p)== batstrRef) ||
 		(getModuleId(p)== mkeyRef);
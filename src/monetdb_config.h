@@ -166,6 +166,9 @@
 /* Define to 1 if you have the <libintl.h> header file. */
 #define HAVE_LIBINTL_H 1
 
+/* Define if you have the numa library */
+/* #undef HAVE_LIBNUMA */
+
 /* Define if you have the pcre library */
 #define HAVE_LIBPCRE 1
 
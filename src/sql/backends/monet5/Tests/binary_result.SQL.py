@@ -0,0 +1,197 @@
+import os, sys, socket, struct, hashlib
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+# The same result set is fetched over MAPI as text rows and as binary
+# column buffers (Xbinary 1), both the first block and the block that
+# follows with Xexport, and the decoded values are compared.
+
+SETUP = '''\
+create table binres (i int, b bigint, s smallint, t tinyint, d double, r real, v varchar(20), m decimal(10,2), dt date, bo boolean);
+insert into binres values (1, 10000000000, 3, 4, 0.5, 1.5, 'red', 12.34, '2013-05-01', true);
+insert into binres values (-2, -1, -3, -4, -2.25, -0.25, 'green', -0.05, '1999-12-31', false);
+insert into binres values (null, null, null, null, null, null, null, null, null, null);
+insert into binres values (4, 0, 0, 0, 1e10, 0, 'red', 0, '2000-02-29', true);
+insert into binres values (5, 5, 5, 5, 5, 5, 'red', 5, '2013-01-01', false);
+insert into binres values (6, 6, 6, 6, 6, 6, 'green', 6.5, '2013-01-02', true);
+insert into binres values (7, 7, 7, 7, 7, 7, 'a "quoted" one', 7.25, '2013-01-03', null);
+'''
+QUERY = 'select * from binres order by i desc'
+
+c = process.client('sql', stdin = process.PIPE, stdout = process.PIPE, stderr = process.PIPE)
+out, err = c.communicate(SETUP)
+sys.stdout.write(out)
+sys.stderr.write(err)
+
+class Mapi:
+    def __init__(self, host, port, db):
+        self.s = socket.create_connection((host, port))
+        chal = self.getblock().split(':')
+        salt, algos, pwhash = chal[0], chal[3].split(','), chal[5]
+        pw = hashlib.new(pwhash.lower(), 'monetdb').hexdigest()
+        for algo in ('SHA512', 'SHA256', 'SHA1', 'MD5'):
+            if algo in algos:
+                break
+        self.putblock('LIT:monetdb:{%s}%s:sql:%s:' %
+                      (algo, hashlib.new(algo.lower(), pw + salt).hexdigest(), db))
+        resp = self.getblock()
+        if resp:
+            raise Exception('login failed: ' + resp)
+
+    def recv(self, n):
+        data = ''
+        while len(data) < n:
+            d = self.s.recv(n - len(data))
+            if not d:
+                raise Exception('connection closed')
+            data += d
+        return data
+
+    def getblock(self):
+        data = ''
+        last = 0
+        while not last:
+            (flag,) = struct.unpack('<H', self.recv(2))
+            last = flag & 1
+            data += self.recv(flag >> 1)
+        return data
+
+    def putblock(self, data):
+        while True:
+            chunk, data = data[:8190], data[8190:]
+            self.s.sendall(struct.pack('<H', (len(chunk) << 1) | (not data)) + chunk)
+            if not data:
+                break
+
+    def cmd(self, line):
+        self.putblock(line)
+        resp = self.getblock()
+        if resp.startswith('!'):
+            raise Exception(resp)
+        return resp
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def line(self):
+        e = self.data.index('\n', self.pos)
+        l = self.data[self.pos:e]
+        self.pos = e + 1
+        return l
+
+    def read(self, n):
+        d = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return d
+
+def unquote(v):
+    v = v[1:-1]
+    out, i = '', 0
+    while i < len(v):
+        if v[i] == '\\':
+            i += 1
+            out += {'t': '\t', 'n': '\n'}.get(v[i], v[i])
+        else:
+            out += v[i]
+        i += 1
+    return out
+
+def text_value(v, tpe):
+    if v == 'NULL':
+        return None
+    if v.startswith('"'):
+        return unquote(v)
+    if tpe in ('int', 'bigint', 'smallint', 'tinyint'):
+        return int(v)
+    if tpe in ('double', 'real'):
+        return float(v)
+    return v
+
+# the rows of a text block
+def text_rows(r, types):
+    rows = []
+    while r.pos < len(r.data):
+        l = r.line()
+        if l.startswith('['):
+            rows.append([text_value(v, t) for v, t in
+                         zip(l[2:-2].split(',\t'), types)])
+    return rows
+
+# the rows of a binary block
+def binary_rows(r):
+    ncols, nrows, offset, le = r.line()[1:].split()
+    nrows = int(nrows)
+    order = le == '1' and '<' or '>'
+    cols = []
+    for i in range(int(ncols)):
+        kind, width, size = r.line()[1:].split()
+        width, size = int(width), int(size)
+        data = r.read(size)
+        if kind == 's':
+            offs = struct.unpack('%s%dI' % (order, nrows), data[:4 * nrows])
+            strs = data[4 * nrows:]
+            col = [strs[o:strs.index('\0', o)] if o != 0xffffffff else None
+                   for o in offs]
+        else:
+            fmt = {('i', 1): 'b', ('i', 2): 'h', ('i', 4): 'i', ('i', 8): 'q',
+                   ('f', 4): 'f', ('f', 8): 'd'}[(kind, width)]
+            vals = struct.unpack('%s%d%s' % (order, nrows, fmt), data)
+            if kind == 'i':
+                nil = -(1 << (8 * width - 1))
+            elif width == 4:
+                nil = -3.4028234663852886e+38   # -FLT_MAX
+            else:
+                nil = -sys.float_info.max
+            col = [v if v != nil else None for v in vals]
+        cols.append(col)
+    return [list(row) for row in zip(*cols)]
+
+def show(v):
+    if v is None:
+        return 'NULL'
+    return str(v)
+
+def fetch(m, binary):
+    m.cmd('Xbinary %d\n' % binary)
+    r = Reader(m.cmd('s%s;\n' % QUERY))
+    hdr = r.line().split()
+    rid, nrows = hdr[1], int(hdr[2])
+    types = []
+    while r.data[r.pos] == '%':
+        l = r.line()
+        if l.endswith('# type'):
+            types = [t.strip() for t in l[1:].split('#')[0].split(',\t')]
+    rows = []
+    while True:
+        if binary:
+            rows += binary_rows(r)
+        else:
+            rows += text_rows(r, types)
+        if len(rows) >= nrows:
+            break
+        r = Reader(m.cmd('Xexport %s %d 3\n' % (rid, len(rows))))
+        r.line()
+    m.cmd('Xclose %s\n' % rid)
+    return rows
+
+m = Mapi(os.getenv('HOST', 'localhost'), int(os.getenv('MAPIPORT')), os.getenv('TSTDB'))
+m.cmd('Xreply_size 3\n')
+text = fetch(m, 0)
+binary = fetch(m, 1)
+for row in binary:
+    print(' | '.join([show(v) for v in row]))
+if text == binary:
+    print('binary and text results agree')
+else:
+    print('binary and text results differ')
+    for row in text:
+        print(' | '.join([show(v) for v in row]))
+
+c = process.client('sql', stdin = process.PIPE, stdout = process.PIPE, stderr = process.PIPE)
+out, err = c.communicate('drop table binres;\n')
+sys.stdout.write(out)
+sys.stderr.write(err)
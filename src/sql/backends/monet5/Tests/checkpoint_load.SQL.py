@@ -0,0 +1,91 @@
+import os, sys, threading, time
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+# Clients keep writing and reading while the store_manager checkpoints.
+# The log has to be restarted under that load, and no committed row may
+# get lost on the way.  Each writer has a table of its own, such that
+# the transactions don't conflict.
+
+WRITERS = 4
+BATCH = 50
+TIMEOUT = 300		# seconds to wait for a log restart
+
+def sql(input, args = []):
+    c = process.client('sql', args = args, stdin = process.PIPE,
+                       stdout = process.PIPE, stderr = process.PIPE,
+                       interactive = False, echo = False)
+    return c.communicate(input)
+
+# log restarts, tables merged and rows merged so far
+def checkpoints():
+    out, err = sql('select restarts, tables, merged from sys.checkpoints();\n', ['-fcsv'])
+    sys.stderr.write(err)
+    return [int(v) for v in out.split()[0].split(',')]
+
+class Writer(threading.Thread):
+    def __init__(self, id):
+        threading.Thread.__init__(self)
+        self.id = id
+        self.rows = 0
+        self.err = ''
+
+    def run(self):
+        while True:
+            q = ['start transaction;\n']
+            for i in range(BATCH):
+                q.append('insert into ckpload%d values (%d);\n' % (self.id, self.rows + i))
+            q.append('commit;\n')
+            q.append('select count(*), sum(v) from ckpload%d;\n' % self.id)
+            out, err = sql(''.join(q))
+            if err:
+                self.err += err
+                break
+            self.rows += BATCH
+            if done.isSet():
+                break
+
+out, err = sql(''.join(['create table ckpload%d (v int);\n' % i for i in range(WRITERS)]))
+sys.stderr.write(err)
+
+# The store_manager looks at the log every 30 seconds, and only
+# checkpoints once 1000 changes were logged.  The writers get there
+# long before that, so wait until it has merged their tables and
+# restarted the log.
+start = checkpoints()
+done = threading.Event()
+writers = [Writer(i) for i in range(WRITERS)]
+for w in writers:
+    w.start()
+t = time.time()
+now = start
+while now[0] == start[0] and time.time() < t + TIMEOUT:
+    time.sleep(1)
+    now = checkpoints()
+done.set()
+for w in writers:
+    w.join()
+
+if now[0] > start[0]:
+    print('log restarted under load')
+else:
+    print('no log restart within %d seconds' % TIMEOUT)
+if now[1] > start[1] and now[2] > start[2]:
+    print('deltas merged under load')
+else:
+    print('no deltas merged')
+if sum([w.rows for w in writers]) >= 1000:
+    print('at least 1000 rows written')
+for w in writers:
+    sys.stderr.write(w.err)
+    out, err = sql('select count(*), sum(v) from ckpload%d;\n' % w.id, ['-fcsv'])
+    sys.stderr.write(err)
+    if out.split()[0] == '%d,%d' % (w.rows, w.rows * (w.rows - 1) / 2):
+        print('writer %d: all rows present' % w.id)
+    else:
+        print('writer %d: expected %d rows, found %s' % (w.id, w.rows, out.strip()))
+
+out, err = sql(''.join(['drop table ckpload%d;\n' % i for i in range(WRITERS)]))
+sys.stderr.write(err)
@@ -0,0 +1,24 @@
+-- compressible columns: delta coded, run-length and frame of reference
+create table compress_select (id int, g int, m int, colour varchar(10));
+insert into compress_select values (1, 0, 1, 'green');
+insert into compress_select values (2, 0, 2, 'blue');
+insert into compress_select values (3, 0, 3, 'red');
+insert into compress_select values (4, 0, 4, 'green');
+insert into compress_select values (5, 0, 5, 'blue');
+insert into compress_select values (6, 0, 6, 'red');
+insert into compress_select values (7, 0, null, 'green');
+insert into compress_select values (8, 0, 8, 'blue');
+insert into compress_select select id + 8, (id + 8) / 1000, case when (id + 8) % 7 = 0 then null else (id + 8) % 100 end, case when (id + 8) % 3 = 0 then 'red' when (id + 8) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 16, (id + 16) / 1000, case when (id + 16) % 7 = 0 then null else (id + 16) % 100 end, case when (id + 16) % 3 = 0 then 'red' when (id + 16) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 32, (id + 32) / 1000, case when (id + 32) % 7 = 0 then null else (id + 32) % 100 end, case when (id + 32) % 3 = 0 then 'red' when (id + 32) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 64, (id + 64) / 1000, case when (id + 64) % 7 = 0 then null else (id + 64) % 100 end, case when (id + 64) % 3 = 0 then 'red' when (id + 64) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 128, (id + 128) / 1000, case when (id + 128) % 7 = 0 then null else (id + 128) % 100 end, case when (id + 128) % 3 = 0 then 'red' when (id + 128) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 256, (id + 256) / 1000, case when (id + 256) % 7 = 0 then null else (id + 256) % 100 end, case when (id + 256) % 3 = 0 then 'red' when (id + 256) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 512, (id + 512) / 1000, case when (id + 512) % 7 = 0 then null else (id + 512) % 100 end, case when (id + 512) % 3 = 0 then 'red' when (id + 512) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 1024, (id + 1024) / 1000, case when (id + 1024) % 7 = 0 then null else (id + 1024) % 100 end, case when (id + 1024) % 3 = 0 then 'red' when (id + 1024) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 2048, (id + 2048) / 1000, case when (id + 2048) % 7 = 0 then null else (id + 2048) % 100 end, case when (id + 2048) % 3 = 0 then 'red' when (id + 2048) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 4096, (id + 4096) / 1000, case when (id + 4096) % 7 = 0 then null else (id + 4096) % 100 end, case when (id + 4096) % 3 = 0 then 'red' when (id + 4096) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 8192, (id + 8192) / 1000, case when (id + 8192) % 7 = 0 then null else (id + 8192) % 100 end, case when (id + 8192) % 3 = 0 then 'red' when (id + 8192) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 16384, (id + 16384) / 1000, case when (id + 16384) % 7 = 0 then null else (id + 16384) % 100 end, case when (id + 16384) % 3 = 0 then 'red' when (id + 16384) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 32768, (id + 32768) / 1000, case when (id + 32768) % 7 = 0 then null else (id + 32768) % 100 end, case when (id + 32768) % 3 = 0 then 'red' when (id + 32768) % 3 = 1 then 'green' else 'blue' end from compress_select;
+insert into compress_select select id + 65536, (id + 65536) / 1000, case when (id + 65536) % 7 = 0 then null else (id + 65536) % 100 end, case when (id + 65536) % 3 = 0 then 'red' when (id + 65536) % 3 = 1 then 'green' else 'blue' end from compress_select;
@@ -0,0 +1,33 @@
+-- after a restart the columns are stored: build their compressed
+-- images, after which each select and sum on a stored column must match
+-- the same on a computed column, which cannot use the compressed image
+call sys.compress_columns('sys', 'compress_select');
+select count(*) as n, sum(id) as s from compress_select where g = 42;
+select count(*) as n, sum(id) as s from compress_select where g + 0 = 42;
+select count(*) as n, sum(id) as s from compress_select where m between 10 and 19;
+select count(*) as n, sum(id) as s from compress_select where m + 0 between 10 and 19;
+select count(*) as n, sum(id) as s from compress_select where colour = 'red';
+select count(*) as n, sum(id) as s from compress_select where colour || '' = 'red';
+select count(*) as n, sum(id) as s from compress_select where id > 100000;
+select count(*) as n, sum(id) as s from compress_select where id + 0 > 100000;
+select sum(id) as s from compress_select;
+select sum(id + 0) as s from compress_select;
+select sum(g) as s from compress_select;
+select sum(g + 0) as s from compress_select;
+select sum(m) as s from compress_select;
+select sum(m + 0) as s from compress_select;
+update compress_select set g = -1, m = 1000 where id between 5000 and 5999;
+select count(*) as n, sum(id) as s from compress_select where g = 42;
+select count(*) as n, sum(id) as s from compress_select where g + 0 = 42;
+select count(*) as n, sum(id) as s from compress_select where m between 10 and 19;
+select count(*) as n, sum(id) as s from compress_select where m + 0 between 10 and 19;
+select count(*) as n, sum(id) as s from compress_select where colour = 'red';
+select count(*) as n, sum(id) as s from compress_select where colour || '' = 'red';
+select count(*) as n, sum(id) as s from compress_select where id > 100000;
+select count(*) as n, sum(id) as s from compress_select where id + 0 > 100000;
+select sum(id) as s from compress_select;
+select sum(id + 0) as s from compress_select;
+select sum(g) as s from compress_select;
+select sum(g + 0) as s from compress_select;
+select sum(m) as s from compress_select;
+select sum(m + 0) as s from compress_select;
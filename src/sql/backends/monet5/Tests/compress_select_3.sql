@@ -0,0 +1,16 @@
+-- after another restart the image saved before the update must be gone
+select count(*) as n, sum(id) as s from compress_select where g = 42;
+select count(*) as n, sum(id) as s from compress_select where g + 0 = 42;
+select count(*) as n, sum(id) as s from compress_select where m between 10 and 19;
+select count(*) as n, sum(id) as s from compress_select where m + 0 between 10 and 19;
+select count(*) as n, sum(id) as s from compress_select where colour = 'red';
+select count(*) as n, sum(id) as s from compress_select where colour || '' = 'red';
+select count(*) as n, sum(id) as s from compress_select where id > 100000;
+select count(*) as n, sum(id) as s from compress_select where id + 0 > 100000;
+select sum(id) as s from compress_select;
+select sum(id + 0) as s from compress_select;
+select sum(g) as s from compress_select;
+select sum(g + 0) as s from compress_select;
+select sum(m) as s from compress_select;
+select sum(m + 0) as s from compress_select;
+drop table compress_select;
@@ -0,0 +1,92 @@
+import os, sys, shutil
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+# Exports of 32K rows and more are formatted by several threads.  Export
+# the same table, in storage order as well as sorted, once by a server
+# with gdk_nr_threads=4 and once by one with gdk_nr_threads=1, and check
+# that the files are identical.  The rows mix NULLs, doubles that need
+# all their digits and strings that have to be escaped.
+
+DB = 'export_parallel'
+PORT = int(os.getenv('MAPIPORT'))
+TSTTRGDIR = os.environ['TSTTRGDIR']
+DOUBLINGS = 11			# 32 rows grow to 65536
+
+STRINGS = ["plain", "a \"quoted\" one", "back\\\\slash", "tab\\there",
+           "new\\nline", "pipe|inside", "", "\xc4\xb3sselmeer"]
+DOUBLES = ["0.1", "1e300", "-2.5e-10", "0.3333333333333333", "42", "-0"]
+
+def server(threads):
+    return process.server(args = ['--set', 'gdk_nr_threads=%d' % threads],
+                          mapiport = PORT, dbname = DB,
+                          stdin = process.PIPE, stdout = process.PIPE,
+                          stderr = process.PIPE)
+
+def sql(input):
+    c = process.client('sql', port = PORT, dbname = DB, args = ['-fcsv'],
+                       stdin = process.PIPE, stdout = process.PIPE,
+                       stderr = process.PIPE, interactive = False,
+                       echo = False)
+    out, err = c.communicate(input)
+    sys.stderr.write(err)
+    return out
+
+def value(i, vals):
+    if i % 7 == 3:
+        return 'null'
+    return vals[i % len(vals)]
+
+def export(threads):
+    files = []
+    s = server(threads)
+    for order in ('', ' order by s, id'):
+        f = os.path.join(TSTTRGDIR, 'export_parallel_%d_%d.csv' % (threads, len(files)))
+        sql('copy select * from exp%s into \'%s\';\n' % (order, f))
+        files.append(f)
+    s.communicate()
+    return files
+
+dbfarm = os.getenv('GDK_DBFARM')
+if dbfarm and os.path.exists(os.path.join(dbfarm, DB)):
+    shutil.rmtree(os.path.join(dbfarm, DB))
+
+s = server(4)
+q = ['create table exp (id int, b bigint, d double, r real, s varchar(32), m decimal(10,2), dt date, bo boolean);\n']
+for i in range(32):
+    v = value(i, STRINGS)
+    q.append('insert into exp values (%d, %s, %s, %s, %s, %s, %s, %s);\n' %
+             (i, value(i + 1, ['1', '-9000000000', '123456789']),
+              value(i + 2, DOUBLES), value(i + 3, ['1.5', '-0.25', '3.4e38']),
+              v == 'null' and v or "'%s'" % v,
+              value(i + 4, ['12.34', '-0.05', '99999999.99']),
+              value(i + 5, ["'2013-05-01'", "'1999-12-31'"]),
+              value(i + 6, ['true', 'false'])))
+for k in range(DOUBLINGS):
+    q.append('insert into exp select id + %d, b * 3, d * 3, r, s, m, dt, bo from exp;\n' % (32 << k))
+sql(''.join(q))
+print(sql('select count(*), count(s), count(d) from exp;\n').strip())
+s.communicate()
+
+parallel = export(4)
+sequential = export(1)
+for p, f in zip(parallel, sequential):
+    a = open(p).read()
+    b = open(f).read()
+    if a == b:
+        print('%d rows: parallel and sequential exports agree' % a.count('\n'))
+    else:
+        print('parallel and sequential exports differ')
+        for x, y in zip(a.split('\n'), b.split('\n')):
+            if x != y:
+                print(x)
+                print(y)
+                break
+    os.remove(p)
+    os.remove(f)
+
+s = server(1)
+sql('drop table exp;\n')
+s.communicate()
@@ -0,0 +1,54 @@
+import os, sys, shutil
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+# Commits are only in the log until the store_manager checkpoints, and
+# it doesn't for a handful of changes.  Kill the server, such that the
+# restart has to replay the pending log, with group commit configured
+# as in gdk_log_commit=group, and check that every commit acknowledged
+# before the kill is there, and that commits keep working afterwards.
+
+DB = 'log_replay'
+PORT = int(os.getenv('MAPIPORT'))
+ARGS = ['--set', 'gdk_log_commit=group']
+
+def server():
+    return process.server(args = ARGS, mapiport = PORT, dbname = DB,
+                          stdin = process.PIPE, stdout = process.PIPE,
+                          stderr = process.PIPE)
+
+def sql(input):
+    c = process.client('sql', port = PORT, dbname = DB, args = ['-fcsv'],
+                       stdin = process.PIPE, stdout = process.PIPE,
+                       stderr = process.PIPE, interactive = False,
+                       echo = False)
+    out, err = c.communicate(input)
+    sys.stderr.write(err)
+    return out
+
+dbfarm = os.getenv('GDK_DBFARM')
+if dbfarm and os.path.exists(os.path.join(dbfarm, DB)):
+    shutil.rmtree(os.path.join(dbfarm, DB))
+
+s = server()
+sql('create table replay (i int, s varchar(10));\n')
+for t in range(10):
+    sql('start transaction;\n' +
+        ''.join(['insert into replay values (%d, \'%d\');\n' % (t * 10 + i, t)
+                 for i in range(10)]) +
+        'commit;\n')
+print(sql('select count(*), sum(i) from replay;\n').strip())
+s.kill()
+s.communicate()
+
+s = server()
+print('after replay: ' + sql('select count(*), sum(i) from replay;\n').strip())
+sql('insert into replay values (100, \'10\');\n')
+s.communicate()
+
+s = server()
+print('after restart: ' + sql('select count(*), sum(i) from replay;\n').strip())
+sql('drop table replay;\n')
+s.communicate()
@@ -0,0 +1,25 @@
+-- a table large enough to get persistent search accelerators
+create table persist_index (id int, v int);
+insert into persist_index values (1, 10);
+insert into persist_index values (2, 20);
+insert into persist_index values (3, 30);
+insert into persist_index values (4, 40);
+insert into persist_index values (5, 50);
+insert into persist_index values (6, 60);
+insert into persist_index values (7, 70);
+insert into persist_index values (8, 80);
+insert into persist_index select id + 8, v + 80 from persist_index;
+insert into persist_index select id + 16, v + 160 from persist_index;
+insert into persist_index select id + 32, v + 320 from persist_index;
+insert into persist_index select id + 64, v + 640 from persist_index;
+insert into persist_index select id + 128, v + 1280 from persist_index;
+insert into persist_index select id + 256, v + 2560 from persist_index;
+insert into persist_index select id + 512, v + 5120 from persist_index;
+insert into persist_index select id + 1024, v + 10240 from persist_index;
+insert into persist_index select id + 2048, v + 20480 from persist_index;
+insert into persist_index select id + 4096, v + 40960 from persist_index;
+insert into persist_index select id + 8192, v + 81920 from persist_index;
+insert into persist_index select id + 16384, v + 163840 from persist_index;
+insert into persist_index select id + 32768, v + 327680 from persist_index;
+insert into persist_index select id + 65536, v + 655360 from persist_index;
+select count(*) from persist_index;
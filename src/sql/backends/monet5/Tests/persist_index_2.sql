@@ -0,0 +1,10 @@
+-- after a restart the bat is clean: build (and save) a hash table
+-- and imprints, then update values in place
+select count(*) from persist_index where v = 50;
+select count(*) from persist_index where v between 1000 and 1990;
+select sum(id) from persist_index where v between 1000 and 1990;
+update persist_index set v = -v where id = 5 or id between 100 and 149;
+select count(*) from persist_index where v = 50;
+select count(*) from persist_index where v between 1000 and 1990;
+select sum(id) from persist_index where v between 1000 and 1990;
+select count(*) from persist_index where v = -50;
@@ -0,0 +1,6 @@
+-- after another restart the saved images must not resurface
+select count(*) from persist_index where v = 50;
+select count(*) from persist_index where v between 1000 and 1990;
+select sum(id) from persist_index where v between 1000 and 1990;
+select count(*) from persist_index where v = -50;
+drop table persist_index;
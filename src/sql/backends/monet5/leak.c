@@ -30,51 +30,77 @@
 
 //#include "sql_list.h"
 #include "gdk.h"
+#include "sql.h"
+#include "sql_mvc.h"
+#include "mtime.h"
 
 #include <Rdefines.h>
 
 #define LEAK_DEBUG
 
-// TODO: malloc leaked_data in init function
-
-static int colc = 0;
+/*
+ * The leak instructions fill the result record of their own client
+ * (leak_state), so the clients of several R connections don't mix up
+ * their results. R itself is single threaded: every instruction that
+ * calls into R holds leaked_lock, concurrent clients take turns there.
+ */
+#define LEAK_SERIALIZED(fcn) \
+str \
+fcn(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci) \
+{ \
+	RResultPtr ld = leak_state(cntxt->idx); \
+	str msg; \
+	MT_lock_set(&leaked_lock, #fcn); \
+	msg = fcn##_(cntxt, mb, stk, pci, ld); \
+	MT_lock_unset(&leaked_lock, #fcn); \
+	return msg; \
+}
 
 /* str rs{unsafe}(int); */
-str
-leak_rs(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+static str
+leak_rs_(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, RResultPtr ld)
 {
 	int ncol = *(int *)(getArgReference(stk, pci, 1));
 
 	(void) cntxt;
 	(void) mb;
 
-	if (ncol && leaked_data) {
-		colc = 0;
-		leaked_data->type = LD_PROCESSING;
-		leaked_data->value = PROTECT(NEW_LIST(ncol));
-		leaked_data->name = PROTECT(NEW_STRING(ncol));
-		leaked_data->tname = PROTECT(NEW_STRING(ncol));
-		mnstr_flush(leaked_data->msg);
+	if (ncol && ld) {
+		if (ld->stream) {
+			GDKfree(ld->scale);
+			if ((ld->scale = GDKmalloc(ncol * sizeof(int))) == NULL)
+				throw(MAL, "leak.resultSet", MAL_MALLOC_FAIL);
+		}
+		ld->colc = 0;
+		ld->type = LD_PROCESSING;
+		if (ld->stream) {
+			ld->value = PROTECT(NEW_INTEGER(ncol));
+			memset(INTEGER(ld->value), 0, ncol * sizeof(int));
+		} else
+			ld->value = PROTECT(NEW_LIST(ncol));
+		ld->name = PROTECT(NEW_STRING(ncol));
+		ld->tname = PROTECT(NEW_STRING(ncol));
+		mnstr_flush(ld->msg);
 	} else {
 		throw(MAL, "leak.resultSet", ILLEGAL_ARGUMENT);
 	}
 	return MAL_SUCCEED;
 }
+LEAK_SERIALIZED(leak_rs)
 
 
 /* str leak_seal(void); */
 str
 leak_seal(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
-#ifndef LEAK_DEBUG
-	(void) cntxt;
-#endif
+	RResultPtr ld = leak_state(cntxt->idx);
+
 	(void) mb;
 	(void) stk;
 	(void) pci;
 
-	if(leaked_data->value && colc == LENGTH(leaked_data->value)) {
-		leaked_data->type = LD_RESULT;
+	if(ld && ld->value && ld->colc == LENGTH(ld->value)) {
+		ld->type = ld->stream ? LD_STREAM : LD_RESULT;
 	} else {
 		throw(MAL, "leak.seal", PROGRAM_GENERAL);
 	}
@@ -90,14 +116,238 @@ static void destroyBat(SEXP s) {
 	if(TYPEOF(s) != EXTPTRSXP) {
 		Rf_error("MDB finalizer: not an external pointer");
 	}
-	BBPreleaseref(*((int *)(EXTPTR_PTR(s))));
+	/* the fix leak_fixedColumn handed over to R */
+	BBPunfix(*((int *)(EXTPTR_PTR(s))));
 	GDKfree(EXTPTR_PTR(s));
 	return;
 }
 
+/*
+ * String columns can't be exported in place, R wants a vector of
+ * CHARSXP. Since the string heap already eliminates most doubles, all
+ * the rows sharing a heap offset share the same CHARSXP: we keep a
+ * small open addressing table from heap offset to CHARSXP, so mkChar
+ * is only called once per distinct value.
+ */
+typedef struct {
+	var_t off;
+	SEXP val;
+} strcache_e;
+
+#define STRCACHE_HASH(off, mask) ((size_t) (((off) / GDK_VARALIGN) * 0x9E3779B1U) & (mask))
+
+static strcache_e *
+strcache_grow(strcache_e *cache, size_t *mask)
+{
+	size_t i, j, nmask = (*mask << 1) | 1;
+	strcache_e *ncache = GDKzalloc((nmask + 1) * sizeof(strcache_e));
+
+	if (ncache == NULL) {
+		GDKfree(cache);
+		return NULL;
+	}
+	for (i = 0; i <= *mask; i++) {
+		if (cache[i].val == NULL)
+			continue;
+		for (j = STRCACHE_HASH(cache[i].off, nmask); ncache[j].val; j = (j + 1) & nmask)
+			;
+		ncache[j] = cache[i];
+	}
+	GDKfree(cache);
+	*mask = nmask;
+	return ncache;
+}
+
+static SEXP
+leak_strColumn(BAT *b, int nrow)
+{
+	BATiter bi = bat_iterator(b);
+	BUN p, q;
+	size_t mask = 1023, used = 0, j;
+	int i = 0;
+	strcache_e *cache;
+	SEXP col;
+
+	if ((cache = GDKzalloc((mask + 1) * sizeof(strcache_e))) == NULL)
+		return NULL;
+	PROTECT(col = NEW_STRING(nrow));
+	BATloop(b, p, q) {
+		var_t off = BUNtvaroff(bi, p);
+		SEXP ch;
+
+		for (j = STRCACHE_HASH(off, mask); cache[j].val; j = (j + 1) & mask)
+			if (cache[j].off == off)
+				break;
+		if ((ch = cache[j].val) == NULL) {
+			const char *s = Tbase(b) + off;
+
+			ch = GDK_STRNIL(s) ? NA_STRING : mkCharCE(s, CE_UTF8);
+			/* ch is protected as soon as it is in col */
+			cache[j].off = off;
+			cache[j].val = ch;
+			if (++used * 2 > mask && (cache = strcache_grow(cache, &mask)) == NULL) {
+				UNPROTECT(1);
+				return NULL;
+			}
+		}
+		SET_STRING_ELT(col, i++, ch);
+	}
+	GDKfree(cache);
+	UNPROTECT(1);
+	return col;
+}
+
+/*
+ * Fixed-width columns are handed to R in place: R puts its vector
+ * header in the headroom GDK keeps in front of malloced heaps (see
+ * GDK_heap_headroom, set by monetinR at startup) and the BAT stays
+ * fixed until R collects the vector. Views, memory mapped heaps and
+ * BATs with deleted BUNs have no room of their own in front of their
+ * first value, these are copied into a plain R vector. So are BATs R
+ * must not write into: heaps wrapped around memory of someone else
+ * (BATwrap, where the header would overwrite the owner's data),
+ * persistent BATs, and BATs shared by more than one logical reference.
+ */
+static int
+leak_inPlace(BAT *b)
+{
+	return !isVIEW(b) && BUNfirst(b) == 0 &&
+		b->T->heap.storage == STORE_MEM &&
+		!b->T->heap.external &&
+		b->batPersistence == TRANSIENT &&
+		BBP_lrefs(b->batCacheid) <= 1 &&
+		GDK_heap_headroom >= Rf_sizeofHeader();
+}
+
+static SEXP
+leak_fixedColumn(BAT *b, SEXPTYPE t, int nrow, int *biddup)
+{
+	SEXP col;
+
+	if (leak_inPlace(b)) {
+		col = Rf_allocVectorInPlace(t, nrow, Tloc(b, BUNfirst(b)), Tloc(b, BUNfirst(b)) - Rf_sizeofHeader(), &destroyBat, (void *)(biddup));
+		if (col != NULL) {
+			// I keep it, my precious !!!! Released by the R finalizer.
+			SET_TRUELENGTH(col, nrow);
+			leaked_bids = CINT_pushValue(b->batCacheid, leaked_bids);
+			return col;
+		}
+		/* no in-place vector after all, copy */
+	}
+	col = allocVector(t, nrow);
+	memcpy(t == INTSXP ? (void *) INTEGER(col) : (void *) REAL(col), Tloc(b, BUNfirst(b)), tailsize(b, nrow));
+	GDKfree(biddup);
+	BBPunfix(b->batCacheid);
+	return col;
+}
+
+/*
+ * SQL types R has no storage for are converted in a single pass into a
+ * fresh vector. The loops are kept branch free (nil checks are
+ * conditional moves) so the compiler can vectorize them.
+ *   boolean            -> logical
+ *   tinyint, smallint  -> integer
+ *   bigint, real       -> numeric
+ *   decimal(d,s)       -> numeric, scaled by 10^-s
+ *   date               -> numeric of class Date (days since 1970-01-01)
+ *   timestamp          -> numeric of class POSIXct, UTC (seconds since 1970)
+ * Returns NULL for anything else, the caller decides what to do then.
+ */
+#define LEAK_CONVERT(TPE, DST, NA, EXPR) \
+	do { \
+		const TPE *v = (const TPE *) src; \
+		for (i = 0; i < n; i++) \
+			DST[i] = v[i] == TPE##_nil ? NA : (EXPR); \
+	} while (0)
+
+static SEXP
+leak_convertColumn(const char *type, int tpe, const void *src, int n, int scale)
+{
+	SEXP col, cls;
+	int i, st = ATOMstorage(tpe);
+
+	if (strcmp(type, "boolean") == 0 && st == TYPE_bte) {
+		int *d = LOGICAL(col = allocVector(LGLSXP, n));
+		LEAK_CONVERT(bit, d, NA_LOGICAL, v[i] != 0);
+		return col;
+	}
+	if ((strcmp(type, "tinyint") == 0 && st == TYPE_bte) ||
+	    (strcmp(type, "smallint") == 0 && st == TYPE_sht)) {
+		int *d = INTEGER(col = allocVector(INTSXP, n));
+		if (st == TYPE_bte)
+			LEAK_CONVERT(bte, d, NA_INTEGER, (int) v[i]);
+		else
+			LEAK_CONVERT(sht, d, NA_INTEGER, (int) v[i]);
+		return col;
+	}
+	if ((strcmp(type, "bigint") == 0 && st == TYPE_lng) ||
+	    (strcmp(type, "real") == 0 && st == TYPE_flt)) {
+		double *d = REAL(col = allocVector(REALSXP, n));
+		if (st == TYPE_lng)
+			LEAK_CONVERT(lng, d, NA_REAL, (double) v[i]);
+		else
+			LEAK_CONVERT(flt, d, NA_REAL, (double) v[i]);
+		return col;
+	}
+	if (strcmp(type, "decimal") == 0) {
+		double p = 1, *d;
+
+		for (i = 0; i < scale; i++)
+			p *= 10;
+		switch (st) {
+		case TYPE_bte:
+			d = REAL(col = allocVector(REALSXP, n));
+			LEAK_CONVERT(bte, d, NA_REAL, v[i] / p);
+			return col;
+		case TYPE_sht:
+			d = REAL(col = allocVector(REALSXP, n));
+			LEAK_CONVERT(sht, d, NA_REAL, v[i] / p);
+			return col;
+		case TYPE_int:
+			d = REAL(col = allocVector(REALSXP, n));
+			LEAK_CONVERT(int, d, NA_REAL, v[i] / p);
+			return col;
+		case TYPE_lng:
+			d = REAL(col = allocVector(REALSXP, n));
+			LEAK_CONVERT(lng, d, NA_REAL, v[i] / p);
+			return col;
+		default:
+			return NULL;
+		}
+	}
+	if ((strcmp(type, "date") == 0 && st == TYPE_int) ||
+	    (strcmp(type, "timestamp") == 0 && st == TYPE_lng)) {
+		timestamp epoch;
+		double *d;
+
+		if (MTIMEunix_epoch(&epoch) != MAL_SUCCEED)
+			return NULL;
+		PROTECT(col = allocVector(REALSXP, n));
+		d = REAL(col);
+		if (st == TYPE_int) {
+			LEAK_CONVERT(int, d, NA_REAL, (double) (v[i] - epoch.days));
+			PROTECT(cls = mkString("Date"));
+		} else {
+			const timestamp *v = (const timestamp *) src;
+
+			for (i = 0; i < n; i++)
+				d[i] = ts_isnil(v[i]) ? NA_REAL :
+					(double) (v[i].days - epoch.days) * 86400.0 + v[i].msecs / 1000.0;
+			PROTECT(cls = allocVector(STRSXP, 2));
+			SET_STRING_ELT(cls, 0, mkChar("POSIXct"));
+			SET_STRING_ELT(cls, 1, mkChar("POSIXt"));
+			setAttrib(col, install("tzone"), mkString("UTC"));
+		}
+		setAttrib(col, R_ClassSymbol, cls);
+		UNPROTECT(2);
+		return col;
+	}
+	return NULL;
+}
+
 /* str addColumn{unsafe}(tname:str, name:str, typename:str, digits:int, scale:int, col:bat[:oid,:any_1] ); */
-str
-leak_addColumn(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+static str
+leak_addColumn_(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, RResultPtr ld)
 {
 	BAT *b;
 	SEXP col;
@@ -117,67 +367,174 @@ leak_addColumn(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	(void) mb;
 
 	//mnstr_printf(cntxt->fdout, "%d, %d\n", c->md_type_length, c->md_scale);
-	assert(scale == 0); // I don't know at what this parameter refers to.
-							  // When it's 0 it works so assert 0 to immediately see when it reacts otherwise.
+	// scale is the number of decimals of a decimal column, see leak_convertColumn
 
 	if ((b = BATdescriptor(*bid)) == NULL)
 		throw(MAL, "leak.addColumn", RUNTIME_OBJECT_MISSING);
 
-	// Can't add a header to a view, we need to copy the BAT...
-	// To be discussed: Or we might define that a view is a non-native type in R and treat it like that.
-	// ... But for now, non-native types are not yet implemented.
-	if (isVIEW(b)) {
-		b = BATcopy(b, TYPE_void, b->ttype, 1);
-		BBPincref(b->batCacheid, 0);
-		if ((b = BATdescriptor(b->batCacheid)) == NULL) // To be sure the copy is in memory
-			throw(MAL, "leak.addColumn", RUNTIME_OBJECT_MISSING);
+	if (ld == NULL) {
+		mnstr_printf(cntxt->fdout, "LEAK init failed somewhere\n");
+		throw(MAL, "leaker.addColumn", PROGRAM_GENERAL);
 	}
 
-	// I keep it, my precious !!!!
-	//BBPreleaseref(b->batCacheid); // Moved to R finalizer callback
+	// Streamed results: keep the fix, the R result handle fetches slices
+	// (leak_fetchColumn) and unfixes the BAT when it is cleared. Any
+	// type leak_convertColumn knows can be streamed, the slices are
+	// converted as they are fetched.
+	if (ld->stream) {
+		GDKfree(biddup);
+		if (strcmp(type, "int") != 0 && strcmp(type, "double") != 0 &&
+		    (b->ttype == TYPE_void || ATOMstorage(b->ttype) != TYPE_str) &&
+		    leak_convertColumn(type, b->ttype, NULL, 0, scale) == NULL) {
+			BBPunfix(b->batCacheid);
+			throw(MAL, "leaker.addColumn", PROGRAM_NYI);
+		}
+		INTEGER(ld->value)[ld->colc] = b->batCacheid;
+		ld->scale[ld->colc] = strcmp(type, "decimal") == 0 ? scale : -1;
+		leaked_bids = CINT_pushValue(b->batCacheid, leaked_bids);
+		SET_STRING_ELT(ld->name, ld->colc, mkChar(name));
+		SET_STRING_ELT(ld->tname, ld->colc, mkChar(tname));
+		ld->colc++;
+		return MAL_SUCCEED;
+	}
 
-	if (leaked_data == NULL) {
-		mnstr_printf(cntxt->fdout, "LEAK init failed somewhere\n");
-		throw(MAL, "leaker.addColumn", PROGRAM_GENERAL);
+	// Strings are built in a fresh STRSXP, neither copy nor header needed.
+	if (b->ttype != TYPE_void && ATOMstorage(b->ttype) == TYPE_str) {
+		GDKfree(biddup);
+		if ((col = leak_strColumn(b, (int) BATcount(b))) == NULL) {
+			BBPunfix(b->batCacheid);
+			throw(MAL, "leaker.addColumn", MAL_MALLOC_FAIL);
+		}
+		BBPunfix(b->batCacheid);
+		SET_VECTOR_ELT(ld->value, ld->colc, col);
+		SET_STRING_ELT(ld->name, ld->colc, mkChar(name));
+		SET_STRING_ELT(ld->tname, ld->colc, mkChar(tname));
+		ld->colc++;
+		return MAL_SUCCEED;
 	}
 
 	nrow = BATcount(b);
 
 	if (!biddup)
 		throw(MAL, "leaker.addColumn", PROGRAM_GENERAL);
-	*biddup = *bid;
+	*biddup = b->batCacheid;
 
 	if(strcmp(type, "int") == 0) {
-		PROTECT(col = Rf_allocVectorInPlace(INTSXP, nrow, Tloc(b, BUNfirst(b)), Tloc(b, BUNfirst(b)) - Rf_sizeofHeader(), &destroyBat, (void *)(biddup)));
+		PROTECT(col = leak_fixedColumn(b, INTSXP, nrow, biddup));
 		if (col != NULL) {
 			success = 1;
-			SET_TRUELENGTH(col, nrow);
-			SET_VECTOR_ELT(leaked_data->value, colc, col);
+			SET_VECTOR_ELT(ld->value, ld->colc, col);
 		}
 		UNPROTECT(1);
 	}
 	else if(strcmp(type, "double") == 0) {
-		PROTECT(col = Rf_allocVectorInPlace(REALSXP, nrow, Tloc(b, BUNfirst(b)), Tloc(b, BUNfirst(b)) - Rf_sizeofHeader(), &destroyBat, (void *)(biddup)));
+		PROTECT(col = leak_fixedColumn(b, REALSXP, nrow, biddup));
 		if (col != NULL) {
 			success = 1;
-			SET_TRUELENGTH(col, nrow);
-			SET_VECTOR_ELT(leaked_data->value, colc, col);
+			SET_VECTOR_ELT(ld->value, ld->colc, col);
 		}
 		UNPROTECT(1);
 	}
+	else if((col = leak_convertColumn(type, b->ttype, Tloc(b, BUNfirst(b)), nrow, scale)) != NULL) {
+		success = 1;
+		SET_VECTOR_ELT(ld->value, ld->colc, col);
+		GDKfree(biddup);
+		BBPunfix(b->batCacheid);
+	}
 
 	if(success) {
-		SET_STRING_ELT(leaked_data->name, colc, mkChar(name));
-		SET_STRING_ELT(leaked_data->tname, colc, mkChar(tname));
-		colc++;
-		leaked_bids = CINT_pushValue(*bid, leaked_bids);
+		SET_STRING_ELT(ld->name, ld->colc, mkChar(name));
+		SET_STRING_ELT(ld->tname, ld->colc, mkChar(tname));
+		ld->colc++;
 	} else {
 		(void) type_length;
+		GDKfree(biddup);
+		BBPunfix(b->batCacheid);
 		throw(MAL, "leaker.addColumn", PROGRAM_NYI);
 	}
 
 	return MAL_SUCCEED;
 }
+LEAK_SERIALIZED(leak_addColumn)
+
+/* the SQL type leak_convertColumn knows a streamed column by, decimals
+ * aside, which are told apart by their scale */
+static const char *
+leak_typeName(int tpe)
+{
+	switch (tpe) {
+	case TYPE_bit:
+		return "boolean";
+	case TYPE_bte:
+		return "tinyint";
+	case TYPE_sht:
+		return "smallint";
+	case TYPE_lng:
+		return "bigint";
+	case TYPE_flt:
+		return "real";
+	default:
+		return ATOMname(tpe);	/* date, timestamp */
+	}
+}
+
+/*
+ * Rows [off, off + cnt) of a streamed result column, see LD_STREAM.
+ * The window comes from BATslice; with GDK_heap_headroom set that is a
+ * compact BAT with room for the R header, which R then uses in place
+ * just like a complete result column. A window covering the whole
+ * column exports the column itself. Other types go through
+ * leak_convertColumn like complete columns do; scale is that of a
+ * decimal column, -1 for anything else.
+ */
+static SEXP
+leak_fetchColumn_(int bid, BUN off, BUN cnt, int scale)
+{
+	BAT *b, *s;
+	SEXP col;
+	int *biddup;
+
+	if ((b = BATdescriptor(bid)) == NULL)
+		return NULL;
+	if (off == 0 && cnt >= BATcount(b)) {
+		s = b;
+	} else {
+		s = BATslice(b, off, off + cnt);
+		BBPunfix(b->batCacheid);
+		if (s == NULL)
+			return NULL;
+	}
+	if (ATOMstorage(s->ttype) == TYPE_str) {
+		col = leak_strColumn(s, (int) BATcount(s));
+		BBPunfix(s->batCacheid);
+		return col;
+	}
+	if ((biddup = GDKmalloc(sizeof(int))) == NULL) {
+		BBPunfix(s->batCacheid);
+		return NULL;
+	}
+	*biddup = s->batCacheid;
+	if (scale < 0 && s->ttype == TYPE_int)
+		return leak_fixedColumn(s, INTSXP, (int) BATcount(s), biddup);
+	if (scale < 0 && s->ttype == TYPE_dbl)
+		return leak_fixedColumn(s, REALSXP, (int) BATcount(s), biddup);
+	GDKfree(biddup);
+	col = leak_convertColumn(scale >= 0 ? "decimal" : leak_typeName(s->ttype),
+				 s->ttype, Tloc(s, BUNfirst(s)), (int) BATcount(s), scale);
+	BBPunfix(s->batCacheid);
+	return col;
+}
+
+SEXP
+leak_fetchColumn(int bid, BUN off, BUN cnt, int scale)
+{
+	SEXP col;
+
+	MT_lock_set(&leaked_lock, "leak_fetchColumn");
+	col = leak_fetchColumn_(bid, off, cnt, scale);
+	MT_lock_unset(&leaked_lock, "leak_fetchColumn");
+	return col;
+}
 
 // Some macros
 
@@ -188,63 +545,72 @@ leak_addColumn(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 #define SCALE_IT(val, scale) ((scale == 0) ? SI(val) : ScalarReal((double)(val) * pow(10.0, -scale)))
 #define SCALE_IT2(val, scale) ((scale == 0) ? SR(val) : ScalarReal((double)(val) * pow(10.0, -scale)))
 #define CAST_AND_ASSIGN(otype, otypearg, cast_into) { \
-	otype tmp = otypearg ; leaked_data->value = PROTECT( (cast_into) ); \
+	otype tmp = otypearg ; ld->value = PROTECT( (cast_into) ); \
 }
 #define VV(name) (val.val.name)
 #define BATval(otype) ( *(otype *)(Tloc(b, BUNfirst(b))) )
 #define CAST_AND_ASSIGN_BAT(otype, cast_into) CAST_AND_ASSIGN(otype, BATval(otype), cast_into)
 
 #define HACK_PROTECT { \
-		leaked_data->value = PROTECT(ScalarInteger(NA_INTEGER)); \
-		leaked_data->name = PROTECT(ScalarString(mkChar("ERR"))); \
-		leaked_data->tname = PROTECT(ScalarString(mkChar("ERR"))); \
- 		leaked_data->type = LD_ERROR; \
+		ld->value = PROTECT(ScalarInteger(NA_INTEGER)); \
+		ld->name = PROTECT(ScalarString(mkChar("ERR"))); \
+		ld->tname = PROTECT(ScalarString(mkChar("ERR"))); \
+ 		ld->type = LD_ERROR; \
 }
 
 /* leakValue{unsafe}(tname:str, name:str, typename:str, digits:int, scale:int, val:any_1) :void */
-str
-leak_value(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+static str
+leak_value_(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, RResultPtr ld)
 {
 	str tname = GDKstrdup(*((str*) getArgReference(stk, pci, 1)));
 	str name = GDKstrdup(*((str*) getArgReference(stk, pci, 2)));
-	//str type = GDKstrdup(*((str*) getArgReference(stk, pci, 3)));
+	str type = *((str*) getArgReference(stk, pci, 3));
 	//int type_length = *((int*) getArgReference(stk, pci, 4));
 	int scale = *((int*) getArgReference(stk, pci, 5));
 	ValRecord val = stk->stk[pci->argv[6]];
+	SEXP col;
 
 	(void) cntxt;
 	(void) mb;
+	if (ld == NULL)
+		throw(MAL, "leaker.leakValue", PROGRAM_GENERAL);
 	// TODO
 
 	//assert(scale == 0); // scale is used for decimals, the value is internally stored as a not-floating point and is represented with value*10^(-scale)
 
-	switch(val.vtype) {
-	case TYPE_void: leaked_data->value = PROTECT(ScalarInteger(NA_INTEGER)); break;
-	case TYPE_bit: leaked_data->value = PROTECT(ScalarLogical(VV(ival))); break;
+	// dates, timestamps, decimals, ...: same conversion as for columns
+	if (val.vtype != TYPE_bat && (col = leak_convertColumn(type, val.vtype, VALptr(&val), 1, scale)) != NULL)
+		ld->value = PROTECT(col);
+	else switch(val.vtype) {
+	case TYPE_void: ld->value = PROTECT(ScalarInteger(NA_INTEGER)); break;
+	case TYPE_bit: ld->value = PROTECT(ScalarLogical(VV(ival))); break;
 	case TYPE_bte: CAST_AND_ASSIGN(bte, VV(btval), SCALE_IT(tmp, scale)) break;
 	case TYPE_wrd: CAST_AND_ASSIGN(wrd, VV(wval), SCALE_IT(tmp, scale)) break;
-	case TYPE_int: leaked_data->value = PROTECT(SCALE_IT(VV(ival), scale)); break;
+	case TYPE_int: ld->value = PROTECT(SCALE_IT(VV(ival), scale)); break;
 	case TYPE_oid: CAST_AND_ASSIGN(oid, VV(oval), SR(tmp)) break;
 	case TYPE_sht: CAST_AND_ASSIGN(sht, VV(shval), SCALE_IT(tmp, scale)) break;
 	case TYPE_lng: CAST_AND_ASSIGN(lng, VV(lval), SCALE_IT2(tmp, scale)) break;
 	case TYPE_flt: CAST_AND_ASSIGN(flt, VV(fval), SR(tmp)) break;
-	case TYPE_dbl: leaked_data->value = PROTECT(SR(VV(dval))); break;
-	case TYPE_str: leaked_data->value = PROTECT(SS(VV(sval))); break;
+	case TYPE_dbl: ld->value = PROTECT(SR(VV(dval))); break;
+	case TYPE_str: ld->value = PROTECT(SS(VV(sval))); break;
 	case TYPE_bat: { BAT *b; bat tmp = VV(bval);
 					 if((b = BATdescriptor(tmp)) == NULL) goto invalid_bid;
 					 assert(BATcount(b) == 1);
-					 switch(BATttype(b)) {
-					 	case TYPE_void: leaked_data->value = PROTECT(ScalarInteger(NA_INTEGER)); break;
-					 	case TYPE_bit: leaked_data->value = PROTECT(ScalarLogical(BATval(bit))); break;
+					 if ((col = leak_convertColumn(type, b->ttype, Tloc(b, BUNfirst(b)), 1, scale)) != NULL) {
+					 	ld->value = PROTECT(col);
+					 	BBPunfix(b->batCacheid);
+					 } else switch(BATttype(b)) {
+					 	case TYPE_void: ld->value = PROTECT(ScalarInteger(NA_INTEGER)); break;
+					 	case TYPE_bit: ld->value = PROTECT(ScalarLogical(BATval(bit))); break;
 					 	case TYPE_bte: CAST_AND_ASSIGN_BAT(bte, SI(tmp)) break;
 					 	case TYPE_wrd: CAST_AND_ASSIGN_BAT(wrd, SI(tmp)) break;
-					 	case TYPE_int: leaked_data->value = PROTECT(SI(BATval(int))); break;
+					 	case TYPE_int: ld->value = PROTECT(SI(BATval(int))); break;
 					 	case TYPE_oid: CAST_AND_ASSIGN_BAT(oid, SR(tmp)) break;
 					 	case TYPE_sht: CAST_AND_ASSIGN_BAT(sht, SI(tmp)) break;
 					 	case TYPE_lng: CAST_AND_ASSIGN_BAT(lng, SR(tmp)) break;
 					 	case TYPE_flt: CAST_AND_ASSIGN_BAT(flt, SR(tmp)) break;
-					 	case TYPE_dbl: leaked_data->value = PROTECT(SR(BATval(double))); break;
-					 	case TYPE_str: leaked_data->value = PROTECT(SS(Tbase(b))); break;
+					 	case TYPE_dbl: ld->value = PROTECT(SR(BATval(double))); break;
+					 	case TYPE_str: ld->value = PROTECT(SS(Tbase(b))); break;
 					 	default:
 					 		/* Hack against PROTECT imbalance */
 					 		HACK_PROTECT
@@ -258,9 +624,136 @@ leak_value(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 		throw(MAL, "leaker.leakValue", PROGRAM_NYI); break;
 	}
 
-	leaked_data->name = PROTECT(ScalarString(mkChar(name)));
-	leaked_data->tname = PROTECT(ScalarString(mkChar(tname)));
-	leaked_data->type = LD_RESULT;
+	ld->name = PROTECT(ScalarString(mkChar(name)));
+	ld->tname = PROTECT(ScalarString(mkChar(tname)));
+	ld->type = LD_RESULT;
 
 	return MAL_SUCCEED;
 }
+LEAK_SERIALIZED(leak_value)
+
+/*
+ * Bulk append for dbWriteTable. The columns arrive as BATs, wrapped
+ * around the R vectors by the R interface (see BATwrap), and each of
+ * them goes to the insert delta of its column in one append_col.
+ * The table must exist in the current schema with matching types.
+ * On failure the transaction is rolled back, such that no column is
+ * left with more rows than the others.
+ */
+str
+leak_appendTable(Client cntxt, str tname, BAT **cols, int ncol)
+{
+	mvc *m = NULL;
+	sql_table *t;
+	node *n;
+	int i;
+	str msg = getSQLContext(cntxt, NULL, &m, NULL);
+
+	if (msg)
+		return msg;
+	if (m->session->active && m->session->status < 0) {
+		mvc_rollback(m, 0, NULL);
+		throw(SQL, "leak.appendTable", "Current transaction is aborted");
+	}
+	if (!m->session->active)
+		mvc_trans(m);
+	if (m->session->schema == NULL)
+		msg = createException(SQL, "leak.appendTable", "Current schema missing");
+	else if ((t = mvc_bind_table(m, m->session->schema, tname)) == NULL)
+		msg = createException(SQL, "leak.appendTable", "Table missing");
+	else if (list_length(t->columns.set) != ncol)
+		msg = createException(SQL, "leak.appendTable", "Table %s has %d columns, not %d", tname, list_length(t->columns.set), ncol);
+	for (n = msg ? NULL : t->columns.set->h, i = 0; n; n = n->next, i++) {
+		sql_column *c = n->data;
+
+		if (c->type.type->localtype != cols[i]->ttype) {
+			msg = createException(SQL, "leak.appendTable", "Column %s: type mismatch", c->base.name);
+			break;
+		}
+	}
+	for (n = msg ? NULL : t->columns.set->h, i = 0; n; n = n->next, i++) {
+		sql_column *c = n->data;
+
+		if (store_funcs.append_col(m->session->tr, c, cols[i], TYPE_bat) != LOG_OK) {
+			msg = createException(SQL, "leak.appendTable", "Column %s: append failed", c->base.name);
+			break;
+		}
+	}
+	if (msg) {
+		mvc_rollback(m, 0, NULL);
+		return msg;
+	}
+	if (m->session->auto_commit && mvc_commit(m, 0, NULL) < 0)
+		throw(SQL, "leak.appendTable", "Commit failed");
+	return MAL_SUCCEED;
+}
+
+/*
+ * Register R columns as a local temporary table, without copying them:
+ * the wrapped BATs become the insert deltas of the new columns (see
+ * store_funcs.attach_col). The table lives until leak_unregisterTable
+ * or the end of the session. On failure the transaction is rolled
+ * back, which drops the half created table again.
+ */
+str
+leak_registerTable(Client cntxt, str tname, str *cnames, BAT **cols, int ncol)
+{
+	mvc *m = NULL;
+	sql_schema *s;
+	sql_table *t = NULL;
+	int i;
+	str msg = getSQLContext(cntxt, NULL, &m, NULL);
+
+	if (msg)
+		return msg;
+	if (m->session->active && m->session->status < 0) {
+		mvc_rollback(m, 0, NULL);
+		throw(SQL, "leak.registerTable", "Current transaction is aborted");
+	}
+	if (!m->session->active)
+		mvc_trans(m);
+	if ((s = mvc_bind_schema(m, "tmp")) == NULL)
+		msg = createException(SQL, "leak.registerTable", "Schema tmp missing");
+	else if (mvc_bind_table(m, s, tname))
+		msg = createException(SQL, "leak.registerTable", "Name '%s' already in use", tname);
+	else if ((t = mvc_create_table(m, s, tname, tt_table, 0, SQL_LOCAL_TEMP, CA_PRESERVE, -1)) == NULL)
+		msg = createException(SQL, "leak.registerTable", "Cannot create table %s", tname);
+	for (i = 0; msg == MAL_SUCCEED && i < ncol; i++) {
+		sql_subtype *tpe = sql_bind_localtype(ATOMname(cols[i]->ttype));
+		sql_column *c;
+
+		if (tpe == NULL)
+			msg = createException(SQL, "leak.registerTable", "Column %s: unsupported type", cnames[i]);
+		else if ((c = mvc_create_column(m, t, cnames[i], tpe)) == NULL)
+			msg = createException(SQL, "leak.registerTable", "Column %s: cannot create column", cnames[i]);
+		else if (store_funcs.attach_col(m->session->tr, c, cols[i]) != LOG_OK)
+			msg = createException(SQL, "leak.registerTable", "Column %s: cannot attach data", cnames[i]);
+	}
+	if (msg) {
+		mvc_rollback(m, 0, NULL);
+		return msg;
+	}
+	if (m->session->auto_commit && mvc_commit(m, 0, NULL) < 0)
+		throw(SQL, "leak.registerTable", "Commit failed");
+	return MAL_SUCCEED;
+}
+
+str
+leak_unregisterTable(Client cntxt, str tname)
+{
+	mvc *m = NULL;
+	sql_schema *s;
+	sql_table *t;
+	str msg = getSQLContext(cntxt, NULL, &m, NULL);
+
+	if (msg)
+		return msg;
+	if (!m->session->active)
+		mvc_trans(m);
+	if ((s = mvc_bind_schema(m, "tmp")) == NULL || (t = mvc_bind_table(m, s, tname)) == NULL)
+		throw(SQL, "leak.unregisterTable", "Table missing");
+	mvc_drop_table(m, s, t, 0);
+	if (m->session->auto_commit && mvc_commit(m, 0, NULL) < 0)
+		throw(SQL, "leak.unregisterTable", "Commit failed");
+	return MAL_SUCCEED;
+}
@@ -21,10 +21,17 @@
 #include "monetdb_config.h"
 #include "mal_client.h"
 #include "mal_interpreter.h"
+#include "leaked_data.h"
 
 extern str leak_seal(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p);
 extern str leak_addColumn(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p);
 extern str leak_value(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p);
 extern str leak_rs(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p);
 
+/* Called from the R interface directly */
+extern str leak_appendTable(Client cntxt, str tname, BAT **cols, int ncol);
+extern str leak_registerTable(Client cntxt, str tname, str *cnames, BAT **cols, int ncol);
+extern str leak_unregisterTable(Client cntxt, str tname);
+extern SEXP leak_fetchColumn(int bid, BUN off, BUN cnt, int scale);
+
 #endif
@@ -1150,6 +1150,7 @@ mvc_export_table(mvc *m, stream *s, res_table *t, BAT *order, BUN offset, BUN nr
 			fmt[i].extra = (void *) (ptrdiff_t) 3;
 		} else {
 			fmt[i].extra = fmt+i;
+			fmt[i].plain = 1;
 		}
 	}
 	if (i == t->nr_cols + 1) {
@@ -1528,6 +1529,175 @@ mvc_export_file(mvc *m, stream *s, res_table *t)
 	return res;
 }
 
+/*
+ * Binary result transfer.  A client that asked for it (Xbinary 1)
+ * gets the rows of a result set or block as one buffer per column
+ * instead of as text lines.  After the headers follows
+ *	$<nr_cols> <nr_rows> <offset> <little endian>\n
+ * and for each column
+ *	$<kind> <width> <size>\n
+ * followed by size bytes.  Columns of kind i (integer) and f
+ * (floating point) are arrays of native values of the given width,
+ * nil being the nil of the type.  All other columns are of kind s: an
+ * array of 4-byte offsets into the block of nul-terminated strings
+ * that follows it, where ~0 stands for nil.  A string value is
+ * stored once per block, so low cardinality string columns ship a
+ * dictionary.  Values that are neither strings nor numbers are sent
+ * in their text format.
+ */
+#define BINNIL	(~(unsigned int) 0)
+
+static int
+export_binary_tostr(mvc *m, res_col *c, int mtype, ptr p, char **buf, int *len)
+{
+	sql_subtype *t = &c->type;
+	struct time_res ts_res;
+
+	switch (t->type->eclass) {
+	case EC_DEC:
+		return dec_tostr((void *) (ptrdiff_t) t->scale, buf, len, mtype, p);
+	case EC_TIME:
+	case EC_TIMESTAMP:
+		ts_res.has_tz = type_has_tz(t);
+		ts_res.fraction = t->digits ? t->digits - 1 : 0;
+		ts_res.timezone = m->timezone;
+		if (t->type->eclass == EC_TIME)
+			return sql_time_tostr(&ts_res, buf, len, mtype, p);
+		return sql_timestamp_tostr(&ts_res, buf, len, mtype, p);
+	case EC_INTERVAL:
+		if (strcmp(t->type->sqlname, "sec_interval") == 0)
+			return dec_tostr((void *) (ptrdiff_t) 3, buf, len, mtype, p);
+		/* fall through */
+	default:
+		return (*BATatoms[mtype].atomToStr) (buf, len, p);
+	}
+}
+
+static int
+export_binary_column(mvc *m, stream *s, res_col *c, BAT *order, BUN offset, BUN nr)
+{
+	BAT *b = BATdescriptor(c->b);
+	BATiter bi, oi = bat_iterator(order);
+	int tpe, kind, width, aligned, ok = 0, len = 0, l;
+	char *data = NULL, *buf = NULL;
+	size_t size, fill, ssize = 0;
+	const char **keys = NULL;
+	unsigned int *vals = NULL, mask = 0;
+	BUN r;
+
+	if (b == NULL)
+		return -1;
+	bi = bat_iterator(b);
+	tpe = ATOMstorage(b->ttype);
+	aligned = BAThdense(b);
+	if (c->type.type->eclass == EC_NUM &&
+	    (tpe == TYPE_bte || tpe == TYPE_sht || tpe == TYPE_int || tpe == TYPE_lng))
+		kind = 'i';
+	else if (c->type.type->eclass == EC_FLT &&
+		 (tpe == TYPE_flt || tpe == TYPE_dbl))
+		kind = 'f';
+	else
+		kind = 's';
+	width = kind == 's' ? (int) sizeof(unsigned int) : ATOMsize(tpe);
+	size = nr * width;
+	if (kind == 's') {
+		/* room for the strings grows as needed */
+		ssize = nr * 8 + 64;
+		size += ssize;
+	}
+	if ((data = GDKmalloc(size + 1)) == NULL)
+		goto bailout;
+	if (b->ttype == TYPE_str) {
+		/* hash table on the string pointer to store each
+		 * string only once */
+		for (mask = 1; mask < 2 * nr; mask <<= 1)
+			;
+		keys = GDKzalloc(mask * sizeof(const char *));
+		vals = GDKmalloc(mask * sizeof(unsigned int));
+		mask--;
+		if (keys == NULL || vals == NULL)
+			goto bailout;
+	}
+	fill = nr * width;
+	for (r = 0; r < nr; r++) {
+		oid o = *(oid *) BUNhead(oi, BUNfirst(order) + offset + r);
+		BUN p;
+		ptr v;
+
+		if (!aligned)
+			p = BUNfnd(b, &o);
+		else if (o >= b->hseqbase && o < b->hseqbase + BATcount(b))
+			p = BUNfirst(b) + (o - b->hseqbase);
+		else
+			p = BUN_NONE;
+		v = p == BUN_NONE ? ATOMnilptr(b->ttype) : BUNtail(bi, p);
+
+		if (kind != 's') {
+			memcpy(data + r * width, v, width);
+			continue;
+		}
+		if (ATOMcmp(b->ttype, ATOMnilptr(b->ttype), v) == 0) {
+			((unsigned int *) data)[r] = BINNIL;
+			continue;
+		}
+		if (keys) {
+			size_t h = ((size_t) v >> 3) & mask;
+
+			while (keys[h] && keys[h] != v)
+				h = (h + 1) & mask;
+			if (keys[h]) {
+				((unsigned int *) data)[r] = vals[h];
+				continue;
+			}
+			keys[h] = v;
+			vals[h] = (unsigned int) (fill - nr * width);
+			l = (int) strlen(v);
+		} else {
+			if ((l = export_binary_tostr(m, c, b->ttype, v, &buf, &len)) < 0)
+				goto bailout;
+			v = buf;
+		}
+		if (fill + l + 1 > size) {
+			char *ndata = GDKrealloc(data, size = MAX(2 * size, fill + l + 1));
+
+			if (ndata == NULL)
+				goto bailout;
+			data = ndata;
+		}
+		((unsigned int *) data)[r] = (unsigned int) (fill - nr * width);
+		memcpy(data + fill, v, l + 1);
+		fill += l + 1;
+	}
+	ok = mnstr_printf(s, "$%c %d " SZFMT "\n", kind, width, fill) >= 0 &&
+		(fill == 0 || mnstr_write(s, data, fill, 1) == 1);
+  bailout:
+	BBPunfix(b->batCacheid);
+	GDKfree(data);
+	GDKfree(keys);
+	GDKfree(vals);
+	if (buf)
+		GDKfree(buf);
+	return ok ? 0 : -1;
+}
+
+static int
+mvc_export_binary(mvc *m, stream *s, res_table *t, BAT *order, BUN offset, BUN nr)
+{
+	int i;
+
+#ifdef WORDS_BIGENDIAN
+	if (mnstr_printf(s, "$%d " BUNFMT " " BUNFMT " 0\n", t->nr_cols, nr, offset) < 0)
+		return -1;
+#else
+	if (mnstr_printf(s, "$%d " BUNFMT " " BUNFMT " 1\n", t->nr_cols, nr, offset) < 0)
+		return -1;
+#endif
+	for (i = 0; i < t->nr_cols; i++)
+		if (export_binary_column(m, s, t->cols + i, order, offset, nr) < 0)
+			return -1;
+	return 0;
+}
+
 int
 mvc_export_result(mvc *m, stream *s, int res_id)
 {
@@ -1557,7 +1727,10 @@ mvc_export_result(mvc *m, stream *s, int res_id)
 		count = BATcount(order);
 		clean = 1;
 	}
-	res = mvc_export_table(m, s, t, order, 0, count, "[ ", ",\t", "\t]\n", "\"", "NULL");
+	if (m->binary)
+		res = mvc_export_binary(m, s, t, order, 0, count);
+	else
+		res = mvc_export_table(m, s, t, order, 0, count, "[ ", ",\t", "\t]\n", "\"", "NULL");
 	BBPunfix(order->batCacheid);
 	if (clean)
 		m->results = res_tables_remove(m->results, t);
@@ -1616,7 +1789,10 @@ mvc_export_chunk(mvc *m, stream *s, int res_id, BUN offset, BUN nr)
 	if (mnstr_write(s, "\n", 1, 1) != 1)
 		return export_error(order);
 
-	res = mvc_export_table(m, s, t, order, offset, cnt, "[ ", ",\t", "\t]\n", "\"", "NULL");
+	if (m->binary)
+		res = mvc_export_binary(m, s, t, order, offset, cnt);
+	else
+		res = mvc_export_table(m, s, t, order, offset, cnt, "[ ", ",\t", "\t]\n", "\"", "NULL");
 	BBPunfix(order->batCacheid);
 	return res;
 }
@@ -618,6 +618,57 @@ sql_update_feb2013_sp1(Client c)
 	return err;		/* usually MAL_SUCCEED */
 }
 
+static str
+sql_update_jul2013(Client c)
+{
+	char *buf = GDKmalloc(4096), *err = NULL;
+	size_t bufsize = 4096, pos = 0;
+
+	/* sys.quantile and sys.quantile_approx functions */
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile(val TINYINT, q DOUBLE) returns TINYINT external name \"aggr\".\"quantile\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile(val SMALLINT, q DOUBLE) returns SMALLINT external name \"aggr\".\"quantile\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile(val INTEGER, q DOUBLE) returns INTEGER external name \"aggr\".\"quantile\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile(val BIGINT, q DOUBLE) returns BIGINT external name \"aggr\".\"quantile\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile(val REAL, q DOUBLE) returns REAL external name \"aggr\".\"quantile\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile(val DOUBLE, q DOUBLE) returns DOUBLE external name \"aggr\".\"quantile\";\n");
+
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile(val DATE, q DOUBLE) returns DATE external name \"aggr\".\"quantile\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile(val TIME, q DOUBLE) returns TIME external name \"aggr\".\"quantile\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile(val TIMESTAMP, q DOUBLE) returns TIMESTAMP external name \"aggr\".\"quantile\";\n");
+
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile_approx(val TINYINT, q DOUBLE) returns TINYINT external name \"aggr\".\"quantile_approx\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile_approx(val SMALLINT, q DOUBLE) returns SMALLINT external name \"aggr\".\"quantile_approx\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile_approx(val INTEGER, q DOUBLE) returns INTEGER external name \"aggr\".\"quantile_approx\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile_approx(val BIGINT, q DOUBLE) returns BIGINT external name \"aggr\".\"quantile_approx\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile_approx(val REAL, q DOUBLE) returns REAL external name \"aggr\".\"quantile_approx\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile_approx(val DOUBLE, q DOUBLE) returns DOUBLE external name \"aggr\".\"quantile_approx\";\n");
+
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile_approx(val DATE, q DOUBLE) returns DATE external name \"aggr\".\"quantile_approx\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile_approx(val TIME, q DOUBLE) returns TIME external name \"aggr\".\"quantile_approx\";\n");
+	pos += snprintf(buf+pos, bufsize-pos, "create aggregate sys.quantile_approx(val TIMESTAMP, q DOUBLE) returns TIMESTAMP external name \"aggr\".\"quantile_approx\";\n");
+
+	pos += snprintf(buf + pos, bufsize-pos, "insert into sys.systemfunctions (select f.id from sys.functions f, sys.schemas s where f.name in ('quantile', 'quantile_approx') and f.type = %d and f.schema_id = s.id and s.name = 'sys');\n", F_AGGR);
+
+	/* sys.workers table function */
+	pos += snprintf(buf+pos, bufsize-pos, "create function sys.workers() returns table(worker int, executed bigint, steals bigint, idle bigint, depth int) external name sql.sysmon_workers;\n");
+	pos += snprintf(buf + pos, bufsize-pos, "insert into sys.systemfunctions (select f.id from sys.functions f, sys.schemas s where f.name = 'workers' and f.type = %d and f.schema_id = s.id and s.name = 'sys');\n", F_FUNC);
+
+	/* sys.checkpoints table function */
+	pos += snprintf(buf+pos, bufsize-pos, "create function sys.checkpoints() returns table(rounds bigint, restarts bigint, tables bigint, merged bigint, skipped bigint, throttled bigint, pending bigint, duration bigint, lastrestart timestamp) external name sql.sysmon_checkpoints;\n");
+	pos += snprintf(buf + pos, bufsize-pos, "insert into sys.systemfunctions (select f.id from sys.functions f, sys.schemas s where f.name = 'checkpoints' and f.type = %d and f.schema_id = s.id and s.name = 'sys');\n", F_FUNC);
+
+	/* sys.compress_columns procedure */
+	pos += snprintf(buf+pos, bufsize-pos, "create procedure sys.compress_columns(s string, t string) external name sql.compress_columns;\n");
+	pos += snprintf(buf + pos, bufsize-pos, "insert into sys.systemfunctions (select f.id from sys.functions f, sys.schemas s where f.name = 'compress_columns' and f.type = %d and f.schema_id = s.id and s.name = 'sys');\n", F_PROC);
+
+	assert(pos < 4096);
+
+	printf("Running database upgrade commands:\n%s\n", buf);
+	err = SQLstatementIntern(c, &buf, "update", 1, 0);
+	GDKfree(buf);
+	return err;		/* usually MAL_SUCCEED */
+}
+
 str
 SQLinitClient(Client c)
 {
@@ -814,6 +865,20 @@ SQLinitClient(Client c)
 				GDKfree(err);
 			}
 		}
+		/* if aggregate function sys.quantile(int, double)
+		 * does not exist, we need to update */
+		{
+			sql_subtype tp2;
+
+			sql_find_subtype(&tp, "int", 0, 0);
+			sql_find_subtype(&tp2, "double", 0, 0);
+			if (!sql_bind_func(m->sa, mvc_bind_schema(m,"sys"), "quantile", &tp, &tp2, F_AGGR )) {
+				if ((err = sql_update_jul2013(c)) != NULL) {
+					fprintf(stderr, "!%s\n", err);
+					GDKfree(err);
+				}
+			}
+		}
 	}
 	fflush(stdout);
 	fflush(stderr);
@@ -1591,6 +1656,12 @@ SQLparser(Client c)
 			in->pos = in->len;  /* HACK: should use parsed length */
 			return MAL_SUCCEED;
 		}
+		if (strncmp(in->buf + in->pos, "binary ", 7) == 0) {
+			v = (int) strtol(in->buf + in->pos + 7, NULL, 10);
+			m->binary = v != 0;
+			in->pos = in->len;  /* HACK: should use parsed length */
+			return MAL_SUCCEED;
+		}
 		if (strncmp(in->buf + in->pos, "quit", 4) == 0) {
 			c->mode = FINISHING;
 			return MAL_SUCCEED;
@@ -28,3 +28,7 @@ create procedure gztruncate (s string, t string)
 create procedure gzexpand (s string, t string)
     external name sql.gzexpand;
 
+-- Build the block compressed images of the columns of a table, which
+-- speed up selections and sums; the columns themselves stay as they are
+create procedure compress_columns (s string, t string)
+    external name sql.compress_columns;
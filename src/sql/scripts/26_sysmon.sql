@@ -36,6 +36,32 @@ update sys._tables
     where name = 'queue'
         and schema_id = (select id from sys.schemas where name = 'sys');
 
+-- show the load of the dataflow workers
+create function sys.workers()
+returns table(
+	worker int,
+	executed bigint,
+	steals bigint,
+	idle bigint,
+	depth int
+)
+external name sql.sysmon_workers;
+
+-- show the progress of the incremental checkpoints
+create function sys.checkpoints()
+returns table(
+	rounds bigint,
+	restarts bigint,
+	tables bigint,
+	merged bigint,
+	skipped bigint,
+	throttled bigint,
+	pending bigint,
+	duration bigint,
+	lastrestart timestamp
+)
+external name sql.sysmon_checkpoints;
+
 -- operations to manipulate the state of havoc queries
 create procedure sys.pause(tag int)
 external name sql.sysmon_pause;
@@ -292,6 +292,12 @@ build up the hash (not copyied in the trans dup)) */
 	if (chain) 
 		sql_trans_begin(m->session);
 	store_unlock();
+	/* with group commit, the log is synced once we let go */
+	if (store_sync() != SQL_OK) {
+		char *msg = sql_message("40000!COMMIT: transation commit failed (perhaps your disk is full?) exiting (kernel error: %s)", GDKerrbuf);
+		GDKfatal("%s", msg);
+		_DELETE(msg);
+	}
 	m->type = Q_TRANS;
 	if (mvc_debug)
 		fprintf(stderr, "#mvc_commit %s done\n", (name) ? name : "");
@@ -429,6 +435,7 @@ mvc_create(int clientid, backend_stack stk, int debug, bstream *rs, stream *ws)
 	m->emode = m_normal;
 	m->emod = mod_none;
 	m->reply_size = 100;
+	m->binary = 0;
 	m->debug = debug;
 	m->cache = DEFAULT_CACHESIZE;
 	m->caching = m->cache;
@@ -491,6 +498,7 @@ mvc_reset(mvc *m, bstream *rs, stream *ws, int debug, int globalvars)
 	if (m->reply_size != 100)
 		stack_set_number(m, "reply_size", 100);
 	m->reply_size = 100;
+	m->binary = 0;
 	if (m->timezone != 0)
 		stack_set_number(m, "current_timezone", 0);
 	m->timezone = 0;
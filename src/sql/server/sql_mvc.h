@@ -108,6 +108,7 @@ typedef struct mvc {
 	int history;		/* queries statistics are kept  */
 	int reply_size;		/* reply size */
 	int sizeheader;		/* print size header in result set */
+	int binary;		/* send result sets as column buffers */
 	int debug;
 
 	char emode;		/* execution mode */
@@ -313,6 +313,12 @@ bl_tend(void)
 	return log_tend(bat_logger);
 }
 
+static int 
+bl_tsync(void)
+{
+	return log_tsync(bat_logger);
+}
+
 static int 
 bl_sequence(int seq, lng id)
 {
@@ -331,6 +337,7 @@ bat_logger_init( logger_functions *lf )
 	lf->log_isnew = bl_log_isnew;
 	lf->log_tstart = bl_tstart;
 	lf->log_tend = bl_tend;
+	lf->log_tsync = bl_tsync;
 	lf->log_sequence = bl_sequence;
 	return LOG_OK;
 }
@@ -25,6 +25,10 @@
 
 #define SNAPSHOT_MINSIZE ((BUN) 1024)
 
+/* protects the claims of transactions on the deltas of gtrans against
+ * the swaps of gtr_merge */
+static MT_Lock delta_lock MT_LOCK_INITIALIZER("delta_lock");
+
 static sql_delta *
 timestamp_delta( sql_delta *d, int ts)
 {
@@ -33,6 +37,20 @@ timestamp_delta( sql_delta *d, int ts)
 	return d;
 }
 
+/* Look up the version of the deltas in chain d that transaction tr
+ * sees and claim it, ie. set *data to it, or to own when the
+ * transaction makes its own copy. Both happen under the delta_lock, such
+ * that gtr_merge either sees the claim or is done before the lookup. */
+static sql_delta *
+use_delta( sql_trans *tr, void **data, sql_delta *d, sql_delta *own)
+{
+	MT_lock_set(&delta_lock, "use_delta");
+	d = timestamp_delta(d, tr->stime);
+	*data = own?own:d;
+	MT_lock_unset(&delta_lock, "use_delta");
+	return d;
+}
+
 static sql_dbat *
 timestamp_dbat( sql_dbat *d, int ts)
 {
@@ -93,7 +111,7 @@ bind_ucol(sql_trans *tr, sql_column *c, int access)
 
 	if (!c->data) {
 		sql_column *oc = tr_find_column(tr->parent, c);
-		c->data = timestamp_delta(oc->data, tr->stime);
+		(void)use_delta(tr, &c->data, oc->data, NULL);
 	}
 	if (!c->t->data) {
 		sql_table *ot = tr_find_table(tr->parent, c->t);
@@ -117,7 +135,7 @@ bind_uidx(sql_trans *tr, sql_idx * i, int access)
 
 	if (!i->data) {
 		sql_idx *oi = tr_find_idx(tr->parent, i);
-		i->data = timestamp_delta(oi->data, tr->stime);
+		(void)use_delta(tr, &i->data, oi->data, NULL);
 	}
 	if (!i->t->data) {
 		sql_table *ot = tr_find_table(tr->parent, i->t);
@@ -171,7 +189,7 @@ bind_col(sql_trans *tr, sql_column *c, int access)
 {
 	if (!c->data) {
 		sql_column *oc = tr_find_column(tr->parent, c);
-		c->data = timestamp_delta(oc->data, tr->stime);
+		(void)use_delta(tr, &c->data, oc->data, NULL);
 	}
 	if (access == RD_UPD)
 		return bind_ucol(tr, c, access);
@@ -185,7 +203,7 @@ bind_idx(sql_trans *tr, sql_idx * i, int access)
 {
 	if (!i->data) {
 		sql_idx *oi = tr_find_idx(tr->parent, i);
-		i->data = timestamp_delta(oi->data, tr->stime);
+		(void)use_delta(tr, &i->data, oi->data, NULL);
 	}
 	if (access == RD_UPD)
 		return bind_uidx(tr, i, access);
@@ -374,7 +392,7 @@ update_col(sql_trans *tr, sql_column *c, void *tids, void *upd, int tpe)
 	if (!c->data || !c->base.allocated) {
 		int type = c->type.type->localtype;
 		sql_column *oc = tr_find_column(tr->parent, c);
-		sql_delta *bat = c->data = ZNEW(sql_delta), *obat = timestamp_delta(oc->data, tr->stime);
+		sql_delta *bat = ZNEW(sql_delta), *obat = use_delta(tr, &c->data, oc->data, bat);
 		(void)dup_bat(tr, c->t, obat, bat, type, isNew(oc), c->base.flag == TR_NEW); 
 		c->base.allocated = 1;
 	}
@@ -399,7 +417,7 @@ update_idx(sql_trans *tr, sql_idx * i, void *tids, void *upd, int tpe)
 	if (!i->data || !i->base.allocated) {
 		int type = (i->type==join_idx)?TYPE_oid:TYPE_wrd;
 		sql_idx *oi = tr_find_idx(tr->parent, i);
-		sql_delta *bat = i->data = ZNEW(sql_delta), *obat = timestamp_delta(oi->data, tr->stime);
+		sql_delta *bat = ZNEW(sql_delta), *obat = use_delta(tr, &i->data, oi->data, bat);
 		(void)dup_bat(tr, i->t, obat, bat, type, isNew(i), i->base.flag == TR_NEW); 
 		i->base.allocated = 1;
 	}
@@ -412,7 +430,7 @@ update_idx(sql_trans *tr, sql_idx * i, void *tids, void *upd, int tpe)
 		assert(0);
 }
 
-static void
+static int
 delta_append_bat( sql_delta *bat, BAT *i ) 
 {
 #ifndef NDEBUG
@@ -421,8 +439,9 @@ delta_append_bat( sql_delta *bat, BAT *i )
 	BAT *b;
 
 	if (!BATcount(i))
-		return ;
-	b = temp_descriptor(bat->ibid);
+		return LOG_OK;
+	if ((b = temp_descriptor(bat->ibid)) == NULL)
+		return LOG_ERR;
 
 	if (bat->cached) {
 		bat_destroy(bat->cached);
@@ -439,15 +458,20 @@ delta_append_bat( sql_delta *bat, BAT *i )
 		temp_destroy(bat->ibid);
 		bat->ibid = ebat2real(b->batCacheid, bat->ibase);
 		bat_destroy(b);
-		b = temp_descriptor(bat->ibid);
+		if ((b = temp_descriptor(bat->ibid)) == NULL)
+			return LOG_ERR;
+	}
+	if (BATappend(b, i, TRUE) == NULL) {
+		bat_destroy(b);
+		return LOG_ERR;
 	}
-	BATappend(b, i, TRUE);
 	bat->cnt += BATcount(i);
 	assert(BUNlast(b) > b->batInserted);
 	bat_destroy(b);
+	return LOG_OK;
 }
 
-static void
+static int
 delta_append_val( sql_delta *bat, void *i ) 
 {
 	BAT *b = temp_descriptor(bat->ibid);
@@ -455,6 +479,9 @@ delta_append_val( sql_delta *bat, void *i )
 	BAT *c = BBPquickdesc(bat->bid, 0);
 #endif
 
+	if (b == NULL)
+		return LOG_ERR;
+
 	if (bat->cached) {
 		bat_destroy(bat->cached);
 		bat->cached = NULL;
@@ -464,12 +491,17 @@ delta_append_val( sql_delta *bat, void *i )
 		bat_destroy(b);
 		temp_destroy(bat->ibid);
 		bat->ibid = ebat2real(bat->ibid, bat->ibase);
-		b = temp_descriptor(bat->ibid);
+		if ((b = temp_descriptor(bat->ibid)) == NULL)
+			return LOG_ERR;
+	}
+	if (BUNappend(b, i, TRUE) == NULL) {
+		bat_destroy(b);
+		return LOG_ERR;
 	}
-	BUNappend(b, i, TRUE);
 	assert(BUNlast(b) > b->batInserted);
 	bat->cnt ++;
 	bat_destroy(b);
+	return LOG_OK;
 }
 
 static int 
@@ -528,19 +560,19 @@ dup_del(sql_trans *tr, sql_table *ot, sql_table *t)
 	return ok;
 }
 
-static void 
+static int
 append_col(sql_trans *tr, sql_column *c, void *i, int tpe)
 {
 	BAT *b = i;
 	sql_delta *bat;
 
 	if (tpe == TYPE_bat && !BATcount(b)) 
-		return;
+		return LOG_OK;
 
 	if (!c->data || !c->base.allocated) {
 		int type = c->type.type->localtype;
 		sql_column *oc = tr_find_column(tr->parent, c);
-		sql_delta *bat = c->data = ZNEW(sql_delta), *obat = timestamp_delta(oc->data, tr->stime);
+		sql_delta *bat = ZNEW(sql_delta), *obat = use_delta(tr, &c->data, oc->data, bat);
 		(void)dup_bat(tr, c->t, obat, bat, type, isNew(oc), c->base.flag == TR_NEW); 
 		c->base.allocated = 1;
 	}
@@ -548,9 +580,8 @@ append_col(sql_trans *tr, sql_column *c, void *i, int tpe)
 	/* appends only write */
 	bat->wtime = c->base.wtime = c->t->base.wtime = c->t->s->base.wtime = tr->wtime = tr->wstime;
 	if (tpe == TYPE_bat)
-		delta_append_bat(bat, i);
-	else
-		delta_append_val(bat, i);
+		return delta_append_bat(bat, i);
+	return delta_append_val(bat, i);
 }
 
 static void
@@ -565,7 +596,7 @@ append_idx(sql_trans *tr, sql_idx * i, void *ib, int tpe)
 	if (!i->data || !i->base.allocated) {
 		int type = (i->type==join_idx)?TYPE_oid:TYPE_wrd;
 		sql_idx *oi = tr_find_idx(tr->parent, i);
-		sql_delta *bat = i->data = ZNEW(sql_delta), *obat = timestamp_delta(oi->data, tr->stime);
+		sql_delta *bat = ZNEW(sql_delta), *obat = use_delta(tr, &i->data, oi->data, bat);
 		(void)dup_bat(tr, i->t, obat, bat, type, isNew(i), i->base.flag == TR_NEW); 
 		i->base.allocated = 1;
 	}
@@ -638,7 +669,7 @@ delete_tab(sql_trans *tr, sql_table * t, void *ib, int tpe)
 
 		if (!c->data) {
 			sql_column *oc = tr_find_column(tr->parent, c);
-			c->data = timestamp_delta(oc->data, tr->stime);
+			(void)use_delta(tr, &c->data, oc->data, NULL);
 		}
        		bat = c->data;
 		if (bat->cached) {
@@ -653,7 +684,7 @@ delete_tab(sql_trans *tr, sql_table * t, void *ib, int tpe)
 
 			if (!i->data) {
 				sql_idx *oi = tr_find_idx(tr->parent, i);
-				i->data = timestamp_delta(oi->data, tr->stime);
+				(void)use_delta(tr, &i->data, oi->data, NULL);
 			}
        			bat = i->data;
 			if (bat && bat->cached) {
@@ -678,7 +709,7 @@ count_col(sql_trans *tr, sql_column *c, int all)
 
 	if (!c->data) {
 		sql_column *oc = tr_find_column(tr->parent, c);
-		c->data = timestamp_delta(oc->data, tr->stime);
+		(void)use_delta(tr, &c->data, oc->data, NULL);
 	}
         b = c->data;
 	if (!b)
@@ -696,7 +727,7 @@ count_idx(sql_trans *tr, sql_idx *i, int all)
 
 	if (!i->data) {
 		sql_idx *oi = tr_find_idx(tr->parent, i);
-		i->data = timestamp_delta(oi->data, tr->stime);
+		(void)use_delta(tr, &i->data, oi->data, NULL);
 	}
 	b = i->data;
 	if (!b)
@@ -741,12 +772,16 @@ sorted_col(sql_trans *tr, sql_column *col)
 {
 	int sorted = 0;
 
-	/* fallback to central bat */
+	/* fallback to central bat, claimed like bind_col does, as
+	 * gtr_merge may swap the bats of unclaimed deltas */
 	if (tr && tr->parent && !col->data) {
-		col = find_col(tr->parent, 
+		sql_column *oc = find_col(tr->parent, 
 			col->t->s->base.name, 
 			col->t->base.name,
 			col->base.name);
+
+		if (oc && oc->data)
+			(void)use_delta(tr, &col->data, oc->data, NULL);
 	}
 
 	if (col && col->data) {
@@ -883,6 +918,24 @@ create_delta( sql_delta *d, BAT *b, BAT *i, bat u)
 	}
 }
 
+/* Temporary columns only: the inserts bat of the (empty) column is
+ * replaced by the given bat, which is shared with its owner instead of
+ * appended. The bat must stay read-only, see BATwrap. */
+static int
+attach_col(sql_trans *tr, sql_column *c, void *i)
+{
+	BAT *b = i;
+	sql_delta *bat = c->data;
+
+	if (!bat || !isTempTable(c->t) || bat->bid || bat->cnt || b->htype != TYPE_void || b->ttype != c->type.type->localtype)
+		return LOG_ERR;
+	if (bat->ibid)
+		temp_destroy(bat->ibid);
+	create_delta(bat, NULL, b, 0);
+	bat->wtime = c->base.wtime = c->t->base.wtime = c->t->s->base.wtime = tr->wtime = tr->wstime;
+	return LOG_OK;
+}
+
 static bat
 copyBat (bat i, int type, oid seq)
 {
@@ -1004,7 +1057,7 @@ create_idx(sql_trans *tr, sql_idx *ni)
 	       
 		if (!c->data) {
 			sql_column *oc = tr_find_column(tr->parent, c);
-			c->data = timestamp_delta(oc->data, tr->stime);
+			(void)use_delta(tr, &c->data, oc->data, NULL);
 		}
 		d = c->data;
 		/* Here we also handle indices created through alter stmts */
@@ -1321,7 +1374,7 @@ clear_col(sql_trans *tr, sql_column *c)
 	if (!c->data || !c->base.allocated) {
 		int type = c->type.type->localtype;
 		sql_column *oc = tr_find_column(tr->parent, c);
-		sql_delta *bat = c->data = ZNEW(sql_delta), *obat = timestamp_delta(oc->data, tr->stime);
+		sql_delta *bat = ZNEW(sql_delta), *obat = use_delta(tr, &c->data, oc->data, bat);
 		(void)dup_bat(tr, c->t, obat, bat, type, isNew(oc), c->base.flag == TR_NEW); 
 		c->base.allocated = 1;
 	}
@@ -1336,7 +1389,7 @@ clear_idx(sql_trans *tr, sql_idx *i)
 	if (!i->data || !i->base.allocated) {
 		int type = (i->type==join_idx)?TYPE_oid:TYPE_wrd;
 		sql_idx *oi = tr_find_idx(tr->parent, i);
-		sql_delta *bat = i->data = ZNEW(sql_delta), *obat = timestamp_delta(oi->data, tr->stime);
+		sql_delta *bat = ZNEW(sql_delta), *obat = use_delta(tr, &i->data, oi->data, bat);
 		(void)dup_bat(tr, i->t, obat, bat, type, isNew(i), i->base.flag == TR_NEW); 
 		i->base.allocated = 1;
 	}
@@ -1392,8 +1445,6 @@ gtr_update_delta( sql_trans *tr, sql_delta *cbat, int *changes)
 	BAT *ups, *ins, *cur;
 
 	(void)tr;
-	assert(store_nr_active==0);
-
 	cur = temp_descriptor(cbat->bid);
 	ins = temp_descriptor(cbat->ibid);
 	/* any inserts */
@@ -1504,9 +1555,245 @@ _gtr_update( sql_trans *tr, gtr_update_table_fptr gtr_update_table_f)
 static int
 gtr_update( sql_trans *tr )
 {
+	assert(store_nr_active==0);
 	return _gtr_update(tr, &gtr_update_table);
 }
 
+static size_t
+gtr_dirty_delta( sql_delta *cbat )
+{
+	size_t cnt = cbat->ucnt;
+	BAT *ins;
+
+	if (cbat->ibid && (ins = temp_descriptor(cbat->ibid)) != NULL) {
+		cnt += BATcount(ins);
+		bat_destroy(ins);
+	}
+	return cnt;
+}
+
+/* number of inserted and updated rows of table t that are not in its
+ * base columns yet */
+static size_t
+gtr_dirty( sql_trans *tr, sql_table *t )
+{
+	size_t cnt = 0, c_cnt;
+	node *n;
+
+	(void)tr;
+	if (!isTable(t) || !isGlobal(t))
+		return 0;
+	for (n = t->columns.set->h; n; n = n->next) {
+		sql_column *c = n->data;
+
+		if (c->base.wtime && c->data &&
+		    (c_cnt = gtr_dirty_delta(c->data)) > cnt)
+			cnt = c_cnt;
+	}
+	if (t->idxs.set) {
+		for (n = t->idxs.set->h; n; n = n->next) {
+			sql_idx *ci = n->data;
+
+			if (ci->base.wtime && ci->data &&
+			    (c_cnt = gtr_dirty_delta(ci->data)) > cnt)
+				cnt = c_cnt;
+		}
+	}
+	return cnt;
+}
+
+/* Build the merged version of delta d aside, in m: a copy of its base
+ * column with the inserts appended and the updates applied. d and its
+ * bats are left alone, as running transactions may still read them.
+ * m->bid stays 0 when there is nothing to merge. */
+static int
+gtr_merge_delta( sql_delta *d, sql_delta *m )
+{
+	BAT *cur, *ins, *ups;
+
+	ins = temp_descriptor(d->ibid);
+	if (!ins)
+		return LOG_ERR;
+	if (BUNlast(ins) == BUNfirst(ins) && !d->ucnt) {
+		bat_destroy(ins);
+		return LOG_OK;
+	}
+	if (d->bid) {
+		BAT *o = temp_descriptor(d->bid);
+
+		cur = o?BATcopy(o, o->htype, o->ttype, TRUE):NULL;
+		bat_destroy(o);
+	} else {
+		/* cleared table */
+		cur = bat_new(TYPE_void, ins->ttype, BATcount(ins));
+	}
+	if (!cur) {
+		bat_destroy(ins);
+		return LOG_ERR;
+	}
+	if (BATcount(cur)+BATcount(ins) > (BUN) REMAP_PAGE_MAXSIZE) /* try to use mmap() */
+		BATmmap(cur, STORE_MMAP, STORE_MMAP, STORE_MMAP, STORE_MMAP, 1);
+	BATappend(cur,ins,TRUE);
+	bat_destroy(ins);
+	if (d->ucnt) {
+		ups = temp_descriptor(d->ubid);
+		if (BUNlast(ups) > BUNfirst(ups))
+			void_replace_bat(cur, ups, TRUE);
+		bat_destroy(ups);
+	}
+	BATcleanProps(cur);
+	bat_set_access(cur, BAT_READ);
+	m->bid = temp_create(cur);
+	m->cnt = m->ibase = BATcount(cur);
+	m->ibid = e_bat(cur->ttype);
+	m->ubid = e_ubat(cur->ttype);
+	bat_destroy(cur);
+	return LOG_OK;
+}
+
+/* Let delta d use the bats merged aside in m, called with the
+ * delta_lock set. The logger persists the new base column from the
+ * next log restart on. The old bats are only released here, whoever
+ * still holds one of them keeps it until done. */
+static int
+gtr_merge_publish( sql_trans *tr, sql_delta *d, sql_delta *m )
+{
+	int ok = LOG_OK;
+
+	if (!m->bid)
+		return ok;
+	if (d->name) {
+		BAT *b = temp_descriptor(m->bid);
+
+		logger_add_bat(bat_logger, b, d->name);
+		bat_destroy(b);
+	}
+	if (d->bid)
+		temp_destroy(d->bid);
+	temp_destroy(d->ibid);
+	if (d->ubid)
+		temp_destroy(d->ubid);
+	d->bid = m->bid;
+	d->ibid = m->ibid;
+	d->ubid = m->ubid;
+	d->cnt = m->cnt;
+	d->ibase = m->ibase;
+	d->ucnt = 0;
+	m->bid = m->ibid = m->ubid = 0;
+	if (d->next) { 
+		ok = destroy_bat(tr, d->next);
+		d->next = NULL;
+	}
+	return ok;
+}
+
+/* Merge the deltas of a single table into its base columns while
+ * other transactions are running, called with the store lock set,
+ * which keeps commits off the deltas. The merge is copy-on-write: the
+ * merged columns are built aside, without holding the delta_lock,
+ * and only then swapped into the deltas of gtrans. The swap happens
+ * under the delta_lock, provided still no running transaction uses
+ * the table. As transactions look up and claim the deltas they use
+ * under that lock too, see use_delta, nobody reads a delta while its
+ * bats are swapped. The newest delta version must be the one every
+ * running transaction sees, ie. be older than the oldest of them.
+ * The logical content does not change, hence the write times stay as
+ * they are and nobody has to abort because of the merge. When the
+ * table got used meanwhile, *merged is 0 and the merge is left for a
+ * later round. */
+static int
+gtr_merge( sql_trans *tr, sql_table *t, int oldest, size_t *merged )
+{
+	int ok = LOG_OK, built = LOG_OK;
+	sql_delta *merges = NULL, **last = &merges, *m;
+	node *n;
+
+	*merged = 0;
+	if (!isTable(t) || !isGlobal(t))
+		return LOG_OK;
+	for (n = t->columns.set->h; n; n = n->next) {
+		sql_column *c = n->data;
+
+		if (c->base.wtime && c->data &&
+		    ((sql_delta*)c->data)->wtime > oldest)
+			return LOG_OK;
+	}
+	if (t->idxs.set) {
+		for (n = t->idxs.set->h; n; n = n->next) {
+			sql_idx *ci = n->data;
+
+			if (ci->base.wtime && ci->data &&
+			    ((sql_delta*)ci->data)->wtime > oldest)
+				return LOG_OK;
+		}
+	}
+
+	/* build the merged columns aside, in column order */
+	for (n = t->columns.set->h; built == LOG_OK && n; n = n->next) {
+		sql_column *c = n->data;
+
+		if (c->base.wtime && c->data) {
+			if ((m = ZNEW(sql_delta)) == NULL) {
+				built = LOG_ERR;
+				break;
+			}
+			*last = m;
+			last = &m->next;
+			built = gtr_merge_delta(c->data, m);
+		}
+	}
+	if (built == LOG_OK && t->idxs.set) {
+		for (n = t->idxs.set->h; built == LOG_OK && n; n = n->next) {
+			sql_idx *ci = n->data;
+
+			if (ci->base.wtime && ci->data) {
+				if ((m = ZNEW(sql_delta)) == NULL) {
+					built = LOG_ERR;
+					break;
+				}
+				*last = m;
+				last = &m->next;
+				built = gtr_merge_delta(ci->data, m);
+			}
+		}
+	}
+
+	/* a merge that could not be built, eg. for lack of memory, is
+	 * retried later, like one of a table in use */
+	MT_lock_set(&delta_lock, "gtr_merge");
+	if (built == LOG_OK && !store_table_in_use(t)) {
+		*merged = gtr_dirty(tr, t);
+		m = merges;
+		for (n = t->columns.set->h; ok == LOG_OK && n; n = n->next) {
+			sql_column *c = n->data;
+
+			if (c->base.wtime && c->data) {
+				ok = gtr_merge_publish(tr, c->data, m);
+				m = m->next;
+			}
+		}
+		if (t->idxs.set) {
+			for (n = t->idxs.set->h; ok == LOG_OK && n; n = n->next) {
+				sql_idx *ci = n->data;
+
+				if (ci->base.wtime && ci->data) {
+					ok = gtr_merge_publish(tr, ci->data, m);
+					m = m->next;
+				}
+			}
+		}
+	}
+	MT_lock_unset(&delta_lock, "gtr_merge");
+
+	/* whatever was not swapped in is dropped again */
+	while ((m = merges) != NULL) {
+		merges = m->next;
+		destroy_delta(m);
+		_DELETE(m);
+	}
+	return ok;
+}
+
 static int 
 gtr_minmax_col( sql_trans *tr, sql_column *c)
 {
@@ -1937,6 +2224,9 @@ snapshot_table(sql_trans *tr, sql_table *ft)
 int
 bat_storage_init( store_functions *sf)
 {
+#ifdef NEED_MT_LOCK_INIT
+	MT_lock_init(&delta_lock, "delta_lock");
+#endif
 	sf->bind_col = (bind_col_fptr)&bind_col;
 	sf->bind_idx = (bind_idx_fptr)&bind_idx;
 	sf->bind_del = (bind_del_fptr)&bind_del;
@@ -1946,6 +2236,7 @@ bat_storage_init( store_functions *sf)
 	sf->update_col = (update_col_fptr)&update_col;
 	sf->update_idx = (update_idx_fptr)&update_idx;
 	sf->delete_tab = (delete_tab_fptr)&delete_tab;
+	sf->attach_col = (attach_col_fptr)&attach_col;
 
 	sf->count_del = (count_del_fptr)&count_del;
 	sf->count_col = (count_col_fptr)&count_col;
@@ -1985,6 +2276,8 @@ bat_storage_init( store_functions *sf)
 	sf->snapshot_table = (update_table_fptr)&snapshot_table;
 	sf->gtrans_update = (gtrans_update_fptr)&gtr_update;
 	sf->gtrans_minmax = (gtrans_update_fptr)&gtr_minmax;
+	sf->gtrans_dirty = (gtrans_dirty_fptr)&gtr_dirty;
+	sf->gtrans_merge = (gtrans_merge_fptr)&gtr_merge;
 	return LOG_OK;
 }
 
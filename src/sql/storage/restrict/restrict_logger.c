@@ -116,6 +116,12 @@ bl_tend(void)
 	return log_tend(restrict_logger);
 }
 
+static int 
+bl_tsync(void)
+{
+	return log_tsync(restrict_logger);
+}
+
 static int 
 bl_sequence(int seq, lng id)
 {
@@ -136,6 +142,13 @@ ro_tend(void)
 	return 0;
 }
 
+static int 
+ro_tsync(void)
+{
+	/* nothing is ever written */
+	return LOG_OK;
+}
+
 static int 
 ro_sequence(int seq, lng id)
 {
@@ -157,6 +170,7 @@ su_logger_init( logger_functions *lf )
 	lf->log_isnew = bl_log_isnew;
 	lf->log_tstart = bl_tstart;
 	lf->log_tend = bl_tend;
+	lf->log_tsync = bl_tsync;
 	lf->log_sequence = bl_sequence;
 	return LOG_OK;
 }
@@ -173,6 +187,7 @@ ro_logger_init( logger_functions *lf )
 	lf->log_isnew = bl_log_isnew;
 	lf->log_tstart = ro_tstart;
 	lf->log_tend = ro_tend;
+	lf->log_tsync = ro_tsync;
 	lf->log_sequence = ro_sequence;
 	return LOG_OK;
 }
@@ -202,7 +202,7 @@ append_val( sql_bat *bat, void *i )
 	bat_destroy(b);
 }
 
-static void 
+static int
 append_col(sql_trans *tr, sql_column *c, void *i, int tpe)
 {
 	sql_bat *bat = c->data;
@@ -213,6 +213,7 @@ append_col(sql_trans *tr, sql_column *c, void *i, int tpe)
 		append_bat(bat, i);
 	else
 		append_val(bat, i);
+	return LOG_OK;
 }
 
 static void
@@ -940,6 +941,7 @@ su_storage_init( store_functions *sf)
 	sf->update_col = (update_col_fptr)&update_col;
 	sf->update_idx = (update_idx_fptr)&update_idx;
 	sf->delete_tab = (delete_tab_fptr)&delete_tab;
+	sf->attach_col = (attach_col_fptr)NULL;
 
 	sf->count_del = (count_del_fptr)&count_del;
 	sf->count_col = (count_col_fptr)&count_col;
@@ -992,6 +994,7 @@ ro_storage_init( store_functions *sf)
 	sf->update_col = (update_col_fptr)NULL;
 	sf->update_idx = (update_idx_fptr)NULL;
 	sf->delete_tab = (delete_tab_fptr)NULL;
+	sf->attach_col = (attach_col_fptr)NULL;
 
 	sf->count_del = (count_del_fptr)&count_del;
 	sf->count_col = (count_col_fptr)&count_col;
@@ -1030,6 +1033,8 @@ ro_storage_init( store_functions *sf)
 	sf->log_table = (update_table_fptr)NULL;
 	sf->snapshot_table = (update_table_fptr)NULL;
 	sf->gtrans_update = (gtrans_update_fptr)NULL;
+	sf->gtrans_dirty = (gtrans_dirty_fptr)NULL;
+	sf->gtrans_merge = (gtrans_merge_fptr)NULL;
 	return LOG_OK;
 }
 
@@ -102,11 +102,13 @@ typedef void *(*bind_del_fptr) (sql_trans *tr, sql_table *t, int access);
 /*
 -- append/update to columns and indices 
 */
-typedef void (*append_col_fptr) (sql_trans *tr, sql_column *c, void *d, int t);
+typedef int (*append_col_fptr) (sql_trans *tr, sql_column *c, void *d, int t);
 typedef void (*append_idx_fptr) (sql_trans *tr, sql_idx *i, void *d, int t);
 typedef void (*update_col_fptr) (sql_trans *tr, sql_column *c, void *tids, void *d, int t);
 typedef void (*update_idx_fptr) (sql_trans *tr, sql_idx *i, void *tids, void *d, int t);
 typedef void (*delete_tab_fptr) (sql_trans *tr, sql_table *t, void *d, int tpe);
+/* share (not copy) a bat as the inserts of a new temporary column */
+typedef int (*attach_col_fptr) (sql_trans *tr, sql_column *c, void *d);
 
 /*
 -- count number of rows in column (excluding the deletes)
@@ -161,6 +163,20 @@ typedef int (*update_table_fptr) (sql_trans *tr, sql_table *ft, sql_table *tt);
 */
 typedef int (*gtrans_update_fptr) (sql_trans *tr); 
 
+/*
+-- gtrans_dirty number of rows in the ibats and ubats of table t
+*/
+typedef size_t (*gtrans_dirty_fptr) (sql_trans *tr, sql_table *t); 
+
+/*
+-- gtrans_merge push the ibats and ubats of table t, while transactions
+-- started after timestamp oldest may be running; the merged bats are
+-- built aside and only swapped in while store_table_in_use(t) is false,
+-- *merged is 0 when the merge has to be retried later
+-- returns LOG_OK, LOG_ERR
+*/
+typedef int (*gtrans_merge_fptr) (sql_trans *tr, sql_table *t, int oldest, size_t *merged); 
+
 /*
 -- handle inserts and updates of columns and indices
 -- returns LOG_OK, LOG_ERR
@@ -187,6 +203,7 @@ typedef struct store_functions {
 	update_col_fptr update_col;
 	update_idx_fptr update_idx;
 	delete_tab_fptr delete_tab;
+	attach_col_fptr attach_col;
 
 	count_del_fptr count_del;
 	count_col_fptr count_col;
@@ -233,6 +250,8 @@ typedef struct store_functions {
 	update_table_fptr update_table;
 	gtrans_update_fptr gtrans_update;
 	gtrans_update_fptr gtrans_minmax;
+	gtrans_dirty_fptr gtrans_dirty;
+	gtrans_merge_fptr gtrans_merge;
 
 	col_ins_fptr col_ins;
 	col_upd_fptr col_upd;
@@ -257,6 +276,7 @@ typedef int (*logger_get_sequence_fptr) (int seq, lng *id);
 typedef int (*log_isnew_fptr)(void);
 typedef int (*log_tstart_fptr) (void);
 typedef int (*log_tend_fptr) (void);
+typedef int (*log_tsync_fptr) (void);
 typedef int (*log_sequence_fptr) (int seq, lng id);
 
 typedef struct logger_functions {
@@ -271,6 +291,7 @@ typedef struct logger_functions {
 	log_isnew_fptr log_isnew;
 	log_tstart_fptr log_tstart;
 	log_tend_fptr log_tend;
+	log_tsync_fptr log_tsync;
 	log_sequence_fptr log_sequence;
 } logger_functions;
 
@@ -291,12 +312,28 @@ extern int
  store_init(int debug, store_type store, int readonly, int singleuser, char *logdir, backend_stack stk);
 extern void store_exit(void);
 
+/* progress of the checkpoints of the store_manager */
+typedef struct store_checkpoint_stats {
+	lng rounds;	/* checkpoint rounds run */
+	lng restarts;	/* checkpoints finished with a log restart */
+	lng tables;	/* tables merged */
+	lng rows;	/* rows merged */
+	lng skipped;	/* merges postponed as the table was in use */
+	lng throttled;	/* msec slept to stay within the budget */
+	lng pending;	/* tables left to merge */
+	lng duration;	/* msec taken by the last checkpoint */
+	lng last;	/* time of the last log restart (sec since epoch) */
+} store_checkpoint_stats;
+
 extern void store_apply_deltas(void);
 extern void store_manager(void);
+extern void store_checkpoint_info(store_checkpoint_stats *s);
+extern int store_table_in_use(sql_table *t);
 extern void minmax_manager(void);
 
 extern void store_lock(void);
 extern void store_unlock(void);
+extern int store_sync(void);
 extern int store_next_oid(void);
 
 extern sql_trans *sql_trans_create(backend_stack stk, sql_trans *parent, char *name);
@@ -1449,7 +1449,7 @@ store_init(int debug, store_type store, int readonly, int singleuser, char *logd
 		insert_aggrs(tr, funcs, args);
 		insert_schemas(tr);
 
-		if (sql_trans_commit(tr) != SQL_OK)
+		if (sql_trans_commit(tr) != SQL_OK || store_sync() != SQL_OK)
 			fprintf(stderr, "cannot commit initial transaction\n");
 		sql_trans_destroy(tr);
 	}
@@ -1523,36 +1523,252 @@ store_apply_deltas(void)
 	logging = 0;
 }
 
+static store_checkpoint_stats ckp;	/* protected by the bs_lock */
+static int ckp_start = 0;
+
+/* A running transaction uses table t of gtrans when its copy of t has
+ * been read or written, or still refers to deltas of t. Called locked,
+ * also by the gtrans_merge of the storage before it swaps in the
+ * merged deltas. */
+int
+store_table_in_use(sql_table *t)
+{
+	node *n, *m;
+
+	for (n = active_transactions->h; n; n = n->next) {
+		sql_trans *tr = n->data;
+		sql_schema *s = find_sql_schema(tr, t->s->base.name);
+		sql_table *tt = s?find_sql_table(s, t->base.name):NULL;
+
+		if (!tt)
+			continue;
+		if (tt->base.rtime || tt->base.wtime || tt->data)
+			return 1;
+		for (m = tt->columns.set->h; m; m = m->next) {
+			sql_column *c = m->data;
+
+			if (c->base.rtime || c->base.wtime || c->data)
+				return 1;
+		}
+		if (tt->idxs.set) {
+			for (m = tt->idxs.set->h; m; m = m->next) {
+				sql_idx *i = m->data;
+
+				if (i->base.rtime || i->base.wtime || i->data)
+					return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/* the ids (schema, table) of the tables with deltas to merge, called
+ * locked */
+static int *
+store_dirty_tables(int *nr)
+{
+	int *ids = NULL, sz = 0;
+	node *sn, *n;
+
+	*nr = 0;
+	for (sn = gtrans->schemas.set->h; sn; sn = sn->next) {
+		sql_schema *s = sn->data;
+
+		if (isTempSchema(s) || !s->tables.set)
+			continue;
+		for (n = s->tables.set->h; n; n = n->next) {
+			sql_table *t = n->data;
+
+			if (!store_funcs.gtrans_dirty(gtrans, t))
+				continue;
+			if (*nr == sz) {
+				int *nids = RENEW_ARRAY(int, ids, 4 * (sz + 32));
+
+				/* the others wait for the next round */
+				if (!nids)
+					return ids;
+				ids = nids;
+				sz = 2 * (sz + 32);
+			}
+			ids[2 * *nr] = s->base.id;
+			ids[2 * *nr + 1] = t->base.id;
+			(*nr)++;
+		}
+	}
+	return ids;
+}
+
+/* Merge the deltas of table (sid, tid) of gtrans, called locked.
+ * Returns 0 when the table has to wait for a later round, as a running
+ * transaction uses it or does not see its latest deltas yet. */
+static int
+store_merge_table(int sid, int tid, lng *bytes, int *res)
+{
+	sql_schema *s = find_sql_schema_id(gtrans, sid);
+	sql_table *t = s?find_sql_table_id(s, tid):NULL;
+	int oldest = INT_MAX;
+	size_t rows = 0;
+	node *n;
+
+	if (!t || !store_funcs.gtrans_dirty(gtrans, t))
+		return 1;
+	if (store_table_in_use(t)) {
+		ckp.skipped++;
+		return 0;
+	}
+	if (active_transactions->h)
+		oldest = ((sql_trans *) active_transactions->h->data)->stime;
+	*res = store_funcs.gtrans_merge(gtrans, t, oldest, &rows);
+	if (!rows)
+		return 0;
+	/* without running transactions, make sure we reset all
+	 * transactions on re-activation */
+	if (!store_nr_active)
+		gtrans->wstime = timestamp();
+	ckp.tables++;
+	ckp.rows += rows;
+	for (n = t->columns.set->h; n; n = n->next) {
+		sql_column *c = n->data;
+
+		*bytes += (lng) rows * ATOMsize(c->type.type->localtype);
+	}
+	return 1;
+}
+
+/* restart the log, called locked with logging set, returns unlocked */
+static int
+store_restart(void)
+{
+	int res = logger_funcs.restart();
+
+	MT_lock_unset(&bs_lock, "store_checkpoint");
+	if (logging && res == LOG_OK)
+		res = logger_funcs.cleanup();
+	MT_lock_set(&bs_lock, "store_checkpoint");
+	logging = 0;
+	if (res == LOG_OK) {
+		ckp.restarts++;
+		ckp.duration = GDKms() - ckp_start;
+		ckp.last = (lng) time(NULL);
+	}
+	ckp.pending = 0;
+	MT_lock_unset(&bs_lock, "store_checkpoint");
+	return res;
+}
+
+/* One round of a checkpoint. The deltas are merged into the base
+ * columns table by table. Only the merge of a single table holds the
+ * store lock, hence transactions keep running in between. Tables that
+ * are in use are left for a later round, which the store_manager
+ * starts shortly after. The log is restarted once all tables are
+ * merged. The merges are throttled to sql_checkpoint_budget MB/s,
+ * default unlimited. */
+static int
+store_checkpoint(int *pending)
+{
+	lng budget = GDKgetenv_int("sql_checkpoint_budget", 0);
+	int res = LOG_OK, nr = 0, i, left = 0;
+	int *ids = NULL;
+
+	MT_lock_set(&bs_lock, "store_checkpoint");
+	ckp.rounds++;
+	if (!store_funcs.gtrans_merge) {
+		/* no incremental merges, wait until nobody runs */
+		if (store_nr_active) {
+			ckp.pending = *pending = 1;
+			MT_lock_unset(&bs_lock, "store_checkpoint");
+			return LOG_OK;
+		}
+		logging = 1;
+		/* make sure we reset all transactions on re-activation */
+		gtrans->wstime = timestamp();
+		if (store_funcs.gtrans_update)
+			store_funcs.gtrans_update(gtrans);
+		*pending = 0;
+		return store_restart();
+	}
+	logging = 1;
+	ids = store_dirty_tables(&nr);
+	MT_lock_unset(&bs_lock, "store_checkpoint");
+
+	for (i = 0; i < nr && res == LOG_OK && !GDKexiting(); i++) {
+		lng bytes = 0;
+
+		MT_lock_set(&bs_lock, "store_checkpoint");
+		if (!store_merge_table(ids[2 * i], ids[2 * i + 1], &bytes, &res))
+			left++;
+		ckp.pending = nr - i - 1 + left;
+		MT_lock_unset(&bs_lock, "store_checkpoint");
+		if (budget > 0 && bytes > 0) {
+			int ms = (int) (bytes * 1000 / (budget * 1024 * 1024));
+
+			if (ms > 0) {
+				MT_sleep_ms(ms);
+				MT_lock_set(&bs_lock, "store_checkpoint");
+				ckp.throttled += ms;
+				MT_lock_unset(&bs_lock, "store_checkpoint");
+			}
+		}
+	}
+	_DELETE(ids);
+
+	MT_lock_set(&bs_lock, "store_checkpoint");
+	if (res == LOG_OK && !left && !GDKexiting()) {
+		/* merge what was committed meanwhile and restart the
+		 * log, unless some table is still in use */
+		ids = store_dirty_tables(&nr);
+		for (i = 0; i < nr && res == LOG_OK; i++) {
+			lng bytes = 0;
+
+			if (!store_merge_table(ids[2 * i], ids[2 * i + 1], &bytes, &res))
+				left++;
+		}
+		_DELETE(ids);
+		if (res == LOG_OK && !left) {
+			*pending = 0;
+			return store_restart();
+		}
+	}
+	ckp.pending = left;
+	*pending = (res == LOG_OK && !GDKexiting());
+	logging = 0;
+	MT_lock_unset(&bs_lock, "store_checkpoint");
+	return res;
+}
+
+void
+store_checkpoint_info(store_checkpoint_stats *s)
+{
+	MT_lock_set(&bs_lock, "store_checkpoint_info");
+	*s = ckp;
+	MT_lock_unset(&bs_lock, "store_checkpoint_info");
+}
+
 void
 store_manager(void)
 {
+	int pending = 0;
+
 	while (!GDKexiting()) {
 		int res = LOG_OK;
 		int t;
 
-		for (t = 30000; t > 0; t -= 50) {
+		/* unfinished checkpoints continue after a short pause */
+		for (t = pending ? 1000 : 30000; t > 0; t -= 50) {
 			MT_sleep_ms(50);
 			if (GDKexiting())
 				return;
 		}
-		MT_lock_set(&bs_lock, "store_manager");
-		if (store_nr_active || GDKexiting() ||
-			logger_funcs.changes() < 1000) {
+		if (!pending) {
+			MT_lock_set(&bs_lock, "store_manager");
+			if (GDKexiting() || logger_funcs.changes() < 1000) {
+				MT_lock_unset(&bs_lock, "store_manager");
+				continue;
+			}
+			ckp_start = GDKms();
 			MT_lock_unset(&bs_lock, "store_manager");
-			continue;
 		}
-		logging = 1;
-		/* make sure we reset all transactions on re-activation */
-		gtrans->wstime = timestamp();
-		if (store_funcs.gtrans_update)
-			store_funcs.gtrans_update(gtrans);
-		res = logger_funcs.restart();
-		MT_lock_unset(&bs_lock, "store_manager");
-		if (logging && res == LOG_OK)
-			res = logger_funcs.cleanup();
-		MT_lock_set(&bs_lock, "store_manager");
-		logging = 0;
-		MT_lock_unset(&bs_lock, "store_manager");
+		res = store_checkpoint(&pending);
 		if (res != LOG_OK)
 			GDKfatal("write-ahead logging failure, disk full?");
 	}
@@ -1599,6 +1815,15 @@ store_unlock(void)
 	MT_lock_unset(&bs_lock, "trans_unlock");
 }
 
+/* wait until the commits logged so far are durable; with group
+ * commit this is called after store_unlock, so that concurrent
+ * committers share the sync of the log */
+int
+store_sync(void)
+{
+	return (logger_funcs.log_tsync() == LOG_OK)?SQL_OK:SQL_ERR;
+}
+
 static sql_kc *
 kc_dup_(sql_trans *tr, int flag, sql_kc *kc, sql_table *t, int copy)
 {
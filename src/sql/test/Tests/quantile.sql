@@ -0,0 +1,28 @@
+-- quantile and quantile_approx, grouped and ungrouped, on empty and
+-- NULL-only input, and with the quantile taken from a column
+create table quantiles (g int, v int, d double, q double);
+insert into quantiles values (1, 5, 2.5, 0.25);
+insert into quantiles values (1, 3, 1.5, 0.25);
+insert into quantiles values (1, 9, 4.5, 0.25);
+insert into quantiles values (1, 1, 0.5, 0.25);
+insert into quantiles values (1, 7, 3.5, 0.25);
+insert into quantiles values (1, 2, 1, 0.25);
+insert into quantiles values (1, 8, 4, 0.25);
+insert into quantiles values (1, 4, 2, 0.25);
+insert into quantiles values (1, 6, 3, 0.25);
+insert into quantiles values (2, 10, 1.0, 0.25);
+insert into quantiles values (2, 20, null, 0.25);
+insert into quantiles values (2, null, 3.0, 0.25);
+insert into quantiles values (2, 40, 4.0, 0.25);
+insert into quantiles values (3, null, null, 0.25);
+insert into quantiles values (3, null, null, 0.25);
+select quantile(v, 0.5) as q50, quantile(v, 0.0) as q0, quantile(v, 1.0) as q100, quantile(v, 0.25) as q25 from quantiles;
+select quantile_approx(v, 0.5) as q50, quantile_approx(v, 0.0) as q0, quantile_approx(v, 1.0) as q100, quantile_approx(v, 0.25) as q25 from quantiles;
+select g, quantile(v, 0.5) as q50, quantile(v, 0.25) as q25, quantile(d, 0.5) as d50 from quantiles group by g order by g;
+select g, quantile_approx(v, 0.5) as q50, quantile_approx(v, 0.25) as q25, quantile_approx(d, 0.5) as d50 from quantiles group by g order by g;
+select quantile(v, 0.5) as q50, quantile_approx(v, 0.5) as a50 from quantiles where v > 100;
+select g, quantile(v, 0.5) as q50, quantile_approx(v, 0.5) as a50 from quantiles where v > 100 group by g;
+select quantile(v, 0.5) as q50, quantile_approx(d, 0.5) as a50 from quantiles where g = 3;
+select quantile(v, q) as qq, quantile_approx(v, q) as aq from quantiles;
+select g, quantile(v, q) as qq, quantile_approx(d, q) as dq from quantiles group by g order by g;
+drop table quantiles;